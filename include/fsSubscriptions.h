@@ -11,12 +11,20 @@
 
 #include "events/declarations.h"
 #include "events/streams.h"
+#include "events/updateQueue.h"
 
 #include <folly/FBString.h>
 
 #include <tbb/concurrent_hash_map.h>
 
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
 namespace one {
+class Scheduler;
 namespace client {
 namespace cache {
 class ForceProxyIOCache;
@@ -53,11 +61,26 @@ public:
      * @param metadataCache @c cache::LRUMetadataCache instance.
      * @param forceProxyIOCache @c cache::ForceProxyIOCache instance.
      * @param runInFiber A function that runs callback inside a main fiber.
+     * @param scheduler @c Scheduler instance used to apply batched changes.
+     * @param batchDelay Time for which subscription changes are collected
+     * before being applied together; subscribing and cancelling the same
+     * subscription within this time cancel out. Until a subscription is
+     * applied, remote changes of the file are not received. Zero applies
+     * each change immediately.
      */
     FsSubscriptions(events::Manager &eventManager,
         cache::LRUMetadataCache &metadataCache,
         cache::ForceProxyIOCache &forceProxyIOCache,
-        std::function<void(folly::Function<void()>)> runInFiber);
+        std::function<void(folly::Function<void()>)> runInFiber,
+        Scheduler &scheduler,
+        std::chrono::milliseconds batchDelay = std::chrono::milliseconds{0});
+
+    /**
+     * Destructor.
+     * Cancels scheduled application of pending subscription changes and waits
+     * for an application already in progress.
+     */
+    ~FsSubscriptions();
 
     /**
      * Adds subscription for file attributes updates.
@@ -121,15 +144,41 @@ public:
      */
     bool unsubscribeFileRenamed(const folly::fbstring &fileUuid);
 
+    /**
+     * Sets a callback to be called after a remote change of file attributes
+     * or location has been applied to the metadata cache.
+     * @param cb The callback function that takes file's uuid as parameter.
+     */
+    void onRemoteUpdate(std::function<void(const folly::fbstring &)> cb)
+    {
+        m_onRemoteUpdate = std::move(cb);
+    }
+
+    /**
+     * Sets a callback to be called on a remote change of file attributes
+     * or permissions, whether or not it has been applied to the metadata
+     * cache, as such change may revoke the access to the file.
+     * @param cb The callback function that takes file's uuid as parameter.
+     */
+    void onAccessChange(std::function<void(const folly::fbstring &)> cb)
+    {
+        m_onAccessChange = std::move(cb);
+    }
+
 private:
-    void subscribe(const folly::fbstring &fileUuid,
-        const events::Subscription &subscription);
+    template <typename Subscription>
+    void subscribe(
+        const folly::fbstring &fileUuid, Subscription subscription);
     bool unsubscribe(
         events::StreamKey streamKey, const folly::fbstring &fileUuid);
+    void scheduleApplyPending();
+    void applyPending();
 
     void handleFileAttrChanged(events::Events<events::FileAttrChanged> events);
+    void applyFileAttrChanged(const events::FileAttrChanged &event);
     void handleFileLocationChanged(
         events::Events<events::FileLocationChanged> events);
+    void applyFileLocationChanged(const events::FileLocationChanged &event);
     void handlePermissionChanged(
         events::Events<events::FilePermChanged> events);
     void handleFileRemoved(events::Events<events::FileRemoved> events);
@@ -139,10 +188,35 @@ private:
     cache::LRUMetadataCache &m_metadataCache;
     cache::ForceProxyIOCache &m_forceProxyIOCache;
     std::function<void(folly::Function<void()>)> m_runInFiber;
+    std::function<void(const folly::fbstring &)> m_onRemoteUpdate = [](auto) {};
+    std::function<void(const folly::fbstring &)> m_onAccessChange = [](auto) {};
     tbb::concurrent_hash_map<Key, std::int64_t, StdHashCompare<Key>>
         m_subscriptions;
 
     using SubscriptionAcc = typename decltype(m_subscriptions)::accessor;
+
+    Scheduler &m_scheduler;
+    const std::chrono::milliseconds m_batchDelay;
+
+    // Subscription changes waiting to be applied, a key is never both
+    // in pending subscriptions and pending cancellations
+    std::mutex m_pendingMutex;
+    std::map<Key, std::function<std::int64_t()>> m_pendingSubscriptions;
+    std::set<Key> m_pendingCancellations;
+    std::function<void()> m_cancelApplyPending;
+    bool m_applyPendingScheduled = false;
+
+    // Shared with the scheduled application of pending changes, which may
+    // already be queued for the fiber when this object is destroyed
+    struct Lifetime {
+        std::mutex mutex;
+        bool alive = true;
+    };
+    std::shared_ptr<Lifetime> m_lifetime = std::make_shared<Lifetime>();
+
+    // Remote events waiting to be applied to the cache
+    events::UpdateQueue<events::FileAttrChanged> m_pendingAttrUpdates;
+    events::UpdateQueue<events::FileLocationChanged> m_pendingLocationUpdates;
 };
 
 } // namespace client
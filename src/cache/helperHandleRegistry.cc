@@ -0,0 +1,132 @@
+/**
+ * @file helperHandleRegistry.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "helperHandleRegistry.h"
+
+#include "logging.h"
+#include "monitoring/monitoring.h"
+
+namespace one {
+namespace client {
+namespace cache {
+
+folly::Future<helpers::FileHandlePtr> HelperHandleRegistry::acquire(
+    const Key &key, std::function<folly::Future<helpers::FileHandlePtr>()> open)
+{
+    LOG_FCALL() << LOG_FARG(std::get<0>(key)) << LOG_FARG(std::get<1>(key))
+                << LOG_FARG(std::get<2>(key));
+
+    std::shared_ptr<folly::SharedPromise<helpers::FileHandlePtr>> pending;
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+
+        auto &entry = m_entries[key];
+        ++entry.references;
+
+        if (entry.handle) {
+            LOG_DBG(2) << "Sharing open helper handle of file "
+                       << std::get<1>(key) << " on storage "
+                       << std::get<0>(key);
+
+            ONE_METRIC_COUNTER_INC(
+                "comp.oneclient.mod.helperhandles.shared_opens");
+            return folly::makeFuture(entry.handle);
+        }
+
+        if (entry.pending)
+            return entry.pending->getFuture();
+
+        entry.pending =
+            std::make_shared<folly::SharedPromise<helpers::FileHandlePtr>>();
+        pending = entry.pending;
+    }
+
+    return folly::makeFutureWith(std::move(open))
+        .then([this, key, pending](helpers::FileHandlePtr handle) {
+            {
+                std::lock_guard<std::mutex> guard{m_mutex};
+                auto &entry = m_entries[key];
+                entry.handle = handle;
+                entry.pending.reset();
+
+                ONE_METRIC_COUNTER_SET("comp.oneclient.mod.helperhandles.size",
+                    m_entries.size());
+            }
+
+            pending->setValue(handle);
+            return handle;
+        })
+        .onError([this, key, pending](folly::exception_wrapper ew) {
+            {
+                std::lock_guard<std::mutex> guard{m_mutex};
+                m_entries.erase(key);
+            }
+
+            pending->setException(ew);
+            return folly::makeFuture<helpers::FileHandlePtr>(std::move(ew));
+        });
+}
+
+bool HelperHandleRegistry::release(
+    const Key &key, const helpers::FileHandlePtr &handle)
+{
+    LOG_FCALL() << LOG_FARG(std::get<0>(key)) << LOG_FARG(std::get<1>(key))
+                << LOG_FARG(std::get<2>(key));
+
+    std::lock_guard<std::mutex> guard{m_mutex};
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it->second.handle == handle) {
+        if (--it->second.references > 0)
+            return false;
+
+        m_entries.erase(it);
+        ONE_METRIC_COUNTER_SET(
+            "comp.oneclient.mod.helperhandles.size", m_entries.size());
+        return true;
+    }
+
+    auto invalidatedIt = m_invalidated.find(handle);
+    if (invalidatedIt != m_invalidated.end()) {
+        if (--invalidatedIt->second > 0)
+            return false;
+
+        m_invalidated.erase(invalidatedIt);
+    }
+
+    return true;
+}
+
+void HelperHandleRegistry::invalidate(
+    const Key &key, const helpers::FileHandlePtr &handle)
+{
+    LOG_FCALL() << LOG_FARG(std::get<0>(key)) << LOG_FARG(std::get<1>(key))
+                << LOG_FARG(std::get<2>(key));
+
+    std::lock_guard<std::mutex> guard{m_mutex};
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end() || it->second.handle != handle)
+        return;
+
+    m_invalidated.emplace(handle, it->second.references);
+    m_entries.erase(it);
+
+    ONE_METRIC_COUNTER_SET(
+        "comp.oneclient.mod.helperhandles.size", m_entries.size());
+}
+
+std::size_t HelperHandleRegistry::size() const
+{
+    std::lock_guard<std::mutex> guard{m_mutex};
+    return m_entries.size();
+}
+
+} // namespace cache
+} // namespace client
+} // namespace one
@@ -0,0 +1,98 @@
+/**
+ * @file helperHandleRegistry.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_HELPER_HANDLE_REGISTRY_H
+#define ONECLIENT_HELPER_HANDLE_REGISTRY_H
+
+#include "helpers/storageHelper.h"
+
+#include <folly/FBString.h>
+#include <folly/Hash.h>
+#include <folly/futures/Future.h>
+#include <folly/futures/SharedPromise.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace one {
+namespace client {
+namespace cache {
+
+/**
+ * @c HelperHandleRegistry holds helper handles open on storage, so that
+ * compatible opens of the same file from different file handles share a
+ * single helper handle, together with its connection and buffers. Each
+ * shared handle is reference counted and released on storage only after its
+ * last user is done with it.
+ */
+class HelperHandleRegistry {
+public:
+    /**
+     * Storage id, file id on the storage, open flags of a helper handle and
+     * whether it uses proxy IO.
+     */
+    using Key = std::tuple<folly::fbstring, folly::fbstring, int, bool>;
+
+    /**
+     * Retrieves a shared helper handle, opening it if there is none yet, and
+     * takes a reference to it. Concurrent requests for the same key wait for
+     * a single open. If the open fails, no reference is taken. The reference
+     * is taken even if the caller stops waiting for the handle, in which case
+     * it has to be dropped with @c release once the handle is available.
+     * @param key Key of the handle.
+     * @param open Function opening the handle on storage.
+     * @returns Future of the shared handle.
+     */
+    folly::Future<helpers::FileHandlePtr> acquire(const Key &key,
+        std::function<folly::Future<helpers::FileHandlePtr>()> open);
+
+    /**
+     * Drops a reference to a handle retrieved by @c acquire .
+     * @param key Key with which the handle was acquired.
+     * @param handle The handle.
+     * @returns true if that was the last reference, in which case the caller
+     * is responsible for releasing the handle on storage.
+     */
+    bool release(const Key &key, const helpers::FileHandlePtr &handle);
+
+    /**
+     * Stops sharing a handle with subsequent opens, e.g. when its buffered
+     * contents have been found out of date. The handle remains valid for
+     * users which already hold references to it.
+     * @param key Key with which the handle was acquired.
+     * @param handle The handle.
+     */
+    void invalidate(const Key &key, const helpers::FileHandlePtr &handle);
+
+    /**
+     * @returns Number of helper handles shared by the registry.
+     */
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        helpers::FileHandlePtr handle;
+        std::size_t references = 0;
+        std::shared_ptr<folly::SharedPromise<helpers::FileHandlePtr>> pending;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<Key, Entry> m_entries;
+    // Invalidated handles which are still referenced, with their reference
+    // counts
+    std::unordered_map<helpers::FileHandlePtr, std::size_t> m_invalidated;
+};
+
+} // namespace cache
+} // namespace client
+} // namespace one
+
+#endif // ONECLIENT_HELPER_HANDLE_REGISTRY_H
@@ -8,15 +8,13 @@
 
 #include "helpersCache.h"
 
-#include "buffering/bufferAgent.h"
 #include "messages.pb.h"
 #include "messages/fuse/createStorageTestFile.h"
 #include "messages/fuse/getHelperParams.h"
 #include "messages/fuse/helperParams.h"
 #include "messages/fuse/storageTestFile.h"
 #include "messages/fuse/verifyStorageTestFile.h"
-
-#include <folly/ThreadName.h>
+#include "monitoring/monitoring.h"
 
 #include <algorithm>
 #include <chrono>
@@ -28,65 +26,145 @@ namespace cache {
 
 constexpr unsigned int VERIFY_TEST_FILE_ATTEMPTS = 5;
 constexpr std::chrono::seconds VERIFY_TEST_FILE_DELAY{15};
+// Storage detection and mount point probes run on this many dedicated
+// threads, which bounds the number of threads hung mount points can block
+constexpr std::size_t STORAGE_PROBE_THREAD_COUNT = 4;
 
 HelpersCache::HelpersCache(communication::Communicator &communicator,
     Scheduler &scheduler, const options::Options &options)
     : m_communicator{communicator}
     , m_scheduler{scheduler}
     , m_options{options}
-    , m_helpersIoService{static_cast<int>(
-          options.getStorageHelperThreadCount())}
-    , m_helperFactory
+    , m_defaultExecutor{"default", options.getStorageHelperThreadCount(),
+          options.getStorageExecutorThreadCount() == 0
+              ? options.getStorageExecutorQueueDepth()
+              : 0,
+          communicator, options}
+    , m_probeExecutor{"probe", STORAGE_PROBE_THREAD_COUNT, 0, communicator,
+          options}
+    , m_storageAccessManager{m_defaultExecutor.helperFactory(),
+          m_probeExecutor.helperFactory(), m_options}
+    , m_providerTimeout{options.getProviderTimeout()}
 {
-#if WITH_CEPH
-    m_helpersIoService,
-#endif
-        m_helpersIoService,
-#if WITH_S3
-        m_helpersIoService,
-#endif
-#if WITH_SWIFT
-        m_helpersIoService,
-#endif
-#if WITH_GLUSTERFS
-        m_helpersIoService,
-#endif
-        m_helpersIoService, m_communicator,
-        options.getBufferSchedulerThreadCount(),
-        helpers::buffering::BufferLimits
-    {
-        options.getReadBufferMinSize(), options.getReadBufferMaxSize(),
-            options.getReadBufferPrefetchDuration(),
-            options.getWriteBufferMinSize(), options.getWriteBufferMaxSize(),
-            options.getWriteBufferFlushDelay()
+    // Storages found directly accessible during previous mounts are used in
+    // direct mode right away, without waiting for storage detection
+    if (!m_options.isProxyIOForced()) {
+        for (auto &detected : m_storageAccessManager.loadDetectedStorages()) {
+            m_accessType[detected.first] = AccessType::DIRECT;
+            m_cache[std::make_tuple(detected.first, false)] =
+                isolate(detected.first, detected.second);
+        }
     }
 }
-, m_storageAccessManager{m_helperFactory, m_options},
-    m_providerTimeout{options.getProviderTimeout()}
+
+StorageExecutor &HelpersCache::executor(const folly::fbstring &storageId)
 {
-    std::generate_n(std::back_inserter(m_helpersWorkers),
-        options.getStorageHelperThreadCount(), [this] {
-            return std::thread{[this] {
-                folly::setThreadName("HelpersWorker");
-                m_helpersIoService.run();
-            }};
-        });
+    const auto threadCount = m_options.getStorageExecutorThreadCount();
+    if (threadCount == 0)
+        return m_defaultExecutor;
+
+    std::lock_guard<std::mutex> guard{m_executorsMutex};
+
+    auto &executor = m_executors[storageId];
+    if (!executor) {
+        executor = std::make_unique<StorageExecutor>(storageId, threadCount,
+            m_options.getStorageExecutorQueueDepth(), m_communicator,
+            m_options);
+    }
+
+    return *executor;
+}
+
+HelpersCache::HelperPtr HelpersCache::isolate(
+    const folly::fbstring &storageId, const DetectedStorageAccess &access)
+{
+    // Storage detection creates helpers on the default executor
+    if (m_options.getStorageExecutorThreadCount() == 0)
+        return access.helper;
+
+    return executor(storageId).helperFactory().getStorageHelper(
+        access.helperName, access.helperArgs, m_options.isIOBuffered());
 }
 
-HelpersCache::~HelpersCache()
+StorageExecutor::QueueSlot HelpersCache::acquireQueueSlot(
+    const folly::fbstring &storageId)
 {
-    m_helpersIoService.stop();
-    for (auto &worker : m_helpersWorkers)
-        worker.join();
+    return executor(storageId).acquireQueueSlot();
 }
 
 HelpersCache::AccessType HelpersCache::getAccessType(
     const folly::fbstring &storageId)
 {
-    if (m_accessType.find(storageId) == m_accessType.end())
+    std::lock_guard<std::mutex> guard{m_cacheMutex};
+
+    auto it = m_accessType.find(storageId);
+    if (it == m_accessType.end())
+        return AccessType::UNKNOWN;
+
+    return it->second;
+}
+
+HelpersCache::AccessType HelpersCache::getSelectedAccessType(
+    const folly::fbstring &storageId)
+{
+    std::lock_guard<std::mutex> guard{m_cacheMutex};
+
+    auto it = m_accessType.find(storageId);
+    if (it == m_accessType.end())
         return AccessType::UNKNOWN;
 
-    return m_accessType[storageId];
+    if (it->second == AccessType::DIRECT) {
+        auto selectorIt = m_ioPathSelectors.find(storageId);
+        if (selectorIt != m_ioPathSelectors.end() &&
+            selectorIt->second.proxySelected())
+            return AccessType::PROXY;
+    }
+
+    return it->second;
+}
+
+bool HelpersCache::isDirectHelper(
+    const folly::fbstring &storageId, const HelperPtr &helper)
+{
+    std::lock_guard<std::mutex> guard{m_cacheMutex};
+
+    auto it = m_cache.find(std::make_tuple(storageId, false));
+    return it != m_cache.end() && it->second == helper;
+}
+
+bool HelpersCache::selectProxyIO(const folly::fbstring &storageId)
+{
+    if (!m_options.isAdaptiveIOPathEnabled())
+        return false;
+
+    std::lock_guard<std::mutex> guard{m_cacheMutex};
+
+    auto it = m_accessType.find(storageId);
+    if (it == m_accessType.end() || it->second != AccessType::DIRECT)
+        return false;
+
+    return m_ioPathSelectors[storageId].selectProxyIO();
+}
+
+void HelpersCache::recordIO(const folly::fbstring &storageId, bool proxyIO,
+    std::size_t bytes, std::chrono::nanoseconds duration)
+{
+    if (!m_options.isAdaptiveIOPathEnabled())
+        return;
+
+    std::lock_guard<std::mutex> guard{m_cacheMutex};
+
+    auto &selector = m_ioPathSelectors[storageId];
+    if (!selector.recordIO(proxyIO, bytes, duration))
+        return;
+
+    LOG(INFO) << "Switching new handles on storage " << storageId << " to "
+              << (selector.proxySelected() ? "proxy" : "direct")
+              << " IO (direct: " << selector.throughput(false, bytes)
+              << " B/s, proxy: " << selector.throughput(true, bytes)
+              << " B/s for " << bytes << " B operations)";
+
+    ONE_METRIC_COUNTER_INC("comp.oneclient.mod.helperscache.io_path_switches");
 }
 
 HelpersCache::HelperPtr HelpersCache::get(const folly::fbstring &fileUuid,
@@ -100,173 +178,260 @@ HelpersCache::HelperPtr HelpersCache::get(const folly::fbstring &fileUuid,
                << storageId;
 
     if (m_options.isDirectIOForced()) {
-        bool accessUnset;
-        std::tie(std::ignore, accessUnset) =
-            m_accessType.emplace(std::make_pair(storageId, AccessType::DIRECT));
-
-        auto helperKey = std::make_pair(storageId, false);
-        auto helperIt = m_cache.find(helperKey);
-        if (helperIt != m_cache.end()) {
-            LOG_DBG(1) << "Found storage helper in cache for storage "
-                       << storageId;
-            return helperIt->second;
+        {
+            std::lock_guard<std::mutex> guard{m_cacheMutex};
+            m_accessType.emplace(
+                std::make_pair(storageId, AccessType::DIRECT));
         }
 
-        if (!accessUnset && m_cache.find(helperKey) == m_cache.end()) {
-            LOG_DBG(1) << "Storage helper discovery already requested but not "
-                          "yet available - waiting...";
-
-            int retryCountRemaining = 10;
-            constexpr int retryDelayMs = 200;
-
-            while (retryCountRemaining--) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(
-                    retryCountRemaining * retryDelayMs));
-                if (m_cache.find(helperKey) != m_cache.end()) {
-                    LOG(INFO) << "Storage helper to storage " << storageId
-                              << " is now available";
-                    return m_cache[helperKey];
-                }
-            }
+        return getOrResolve(std::make_tuple(storageId, false), [&] {
+            return resolveDirectHelper(fileUuid, spaceId, storageId);
+        });
+    }
 
-            LOG(ERROR) << "Direct IO access forced to storage " << storageId
-                       << " but storage is not accessible from here";
-            throw std::errc::operation_not_supported;
-        }
+    forceProxyIO |= m_options.isProxyIOForced();
 
-        LOG_DBG(1) << "Requesting helper parameters for storage " << storageId
-                   << " in forced directIO mode";
+    auto helperKey = std::make_tuple(storageId, forceProxyIO);
 
-        try {
-            auto params = communication::wait(
-                m_communicator.communicate<messages::fuse::HelperParams>(
-                    messages::fuse::GetHelperParams{storageId.toStdString(),
-                        spaceId.toStdString(),
-                        messages::fuse::GetHelperParams::HelperMode::
-                            directMode}),
-                m_providerTimeout);
-            LOG_DBG(1) << "Received storage helper params: " << params.name();
+    if (!forceProxyIO) {
+        bool accessUnset;
+        AccessType accessType;
 
-            if (params.name() == helpers::PROXY_HELPER_NAME) {
-                LOG(ERROR)
-                    << "File " << fileUuid
-                    << " is not accessible in directIO mode on this provider";
-                throw std::errc::operation_not_supported;
-            }
-            else if (params.name() == helpers::POSIX_HELPER_NAME) {
-                LOG_DBG(1)
-                    << "Direct IO requested to Posix storage - attempting "
-                       "storage mountpoint detection in local filesystem";
+        {
+            std::lock_guard<std::mutex> guard{m_cacheMutex};
 
-                requestStorageTestFileCreation(fileUuid, storageId);
-                return get(fileUuid, spaceId, storageId, false);
-            }
-            else {
-                LOG_DBG(1) << "Got storage helper params for file " << fileUuid
-                           << " on " << params.name() << " storage "
+            auto helperIt = m_cache.find(helperKey);
+            if (helperIt != m_cache.end()) {
+                LOG_DBG(1) << "Found storage helper in cache for storage "
                            << storageId;
-
-                auto helper = m_helperFactory.getStorageHelper(
-                    params.name(), params.args(), m_options.isIOBuffered());
-
-                m_cache[std::make_pair(storageId, false)] = helper;
-                return helper;
+                return helperIt->second;
             }
+
+            // Check if the access type (PROXY or DIRECT) is already
+            // determined for storage 'storageId'
+            decltype(m_accessType)::iterator accessTypeIt;
+            std::tie(accessTypeIt, accessUnset) = m_accessType.emplace(
+                std::make_pair(storageId, AccessType::PROXY));
+            accessType = accessTypeIt->second;
         }
-        catch (std::exception &e) {
-            LOG_DBG(1) << "Unexpected error when waiting for storage helper: "
-                       << e.what();
-            throw std::errc::resource_unavailable_try_again;
+
+        if (accessUnset) {
+            // Request identification of storage in background and return
+            // for now a helper in proxy mode
+            requestStorageTestFileCreation(fileUuid, storageId);
+            return get(fileUuid, spaceId, storageId, true);
         }
+
+        if (accessType == AccessType::PROXY)
+            return get(fileUuid, spaceId, storageId, true);
     }
-    else {
-        forceProxyIO |= m_options.isProxyIOForced();
 
-        auto helperKey = std::make_pair(storageId, forceProxyIO);
+    return getOrResolve(helperKey, [&] {
+        return communication::wait(
+            requestHelper(spaceId, storageId,
+                messages::fuse::GetHelperParams::HelperMode::autoMode),
+            m_providerTimeout);
+    });
+}
+
+HelpersCache::HelperPtr HelpersCache::getOrResolve(
+    const std::tuple<folly::fbstring, bool> &helperKey,
+    std::function<HelperPtr()> resolve)
+{
+    std::shared_ptr<folly::SharedPromise<HelperPtr>> pending;
+    bool resolving = false;
+
+    {
+        std::lock_guard<std::mutex> guard{m_cacheMutex};
+
         auto helperIt = m_cache.find(helperKey);
         if (helperIt != m_cache.end()) {
             LOG_DBG(1) << "Found storage helper in cache for storage "
-                       << storageId;
+                       << std::get<0>(helperKey);
             return helperIt->second;
         }
 
-        if (!forceProxyIO) {
-            decltype(m_accessType)::iterator accessTypeIt;
-            bool accessUnset;
+        auto pendingIt = m_pendingHelpers.find(helperKey);
+        if (pendingIt == m_pendingHelpers.end()) {
+            pending = std::make_shared<folly::SharedPromise<HelperPtr>>();
+            m_pendingHelpers.emplace(helperKey, pending);
+        }
+        else {
+            pending = pendingIt->second;
+            resolving = true;
+        }
+    }
 
-            // Check if the access type (PROXY or DIRECT) is already determined
-            // for storage 'storageId'
-            std::tie(accessTypeIt, accessUnset) = m_accessType.emplace(
-                std::make_pair(storageId, AccessType::PROXY));
+    // Another request is already resolving the helper - suspend until it
+    // completes instead of resolving it again
+    if (resolving) {
+        LOG_DBG(1) << "Storage helper for storage " << std::get<0>(helperKey)
+                   << " is already being resolved - waiting for it";
 
-            if (accessUnset) {
-                // Request identification of storage asynchronously and return
-                // for now a helper in proxy mode
-                accessTypeIt->second = AccessType::PROXY;
-                requestStorageTestFileCreation(fileUuid, storageId);
-                return get(fileUuid, spaceId, storageId, true);
-            }
+        return communication::wait(pending->getFuture(), m_providerTimeout);
+    }
 
-            if (accessTypeIt->second == AccessType::PROXY)
-                return get(fileUuid, spaceId, storageId, true);
-        }
+    try {
+        auto helper = resolve();
 
-        if (m_options.isDirectIOForced() && forceProxyIO) {
-            LOG(ERROR) << "Direct IO access forced to storage " << storageId
-                       << " but storage is not accessible from here.";
-            throw std::errc::operation_not_supported;
+        std::lock_guard<std::mutex> guard{m_cacheMutex};
+
+        // The helper could have been stored in the meantime by storage
+        // detection
+        auto result = m_cache.emplace(helperKey, std::move(helper));
+
+        m_pendingHelpers.erase(helperKey);
+        pending->setValue(result.first->second);
+        return result.first->second;
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> guard{m_cacheMutex};
+            m_pendingHelpers.erase(helperKey);
         }
+        pending->setException(
+            folly::exception_wrapper{std::current_exception()});
+        throw;
+    }
+}
+
+folly::Future<messages::fuse::HelperParams>
+HelpersCache::requestHelperParams(const folly::fbstring &spaceId,
+    const folly::fbstring &storageId,
+    const messages::fuse::GetHelperParams::HelperMode mode)
+{
+    LOG_DBG(1) << "Requesting helper parameters for storage " << storageId;
+
+    return m_communicator.communicate<messages::fuse::HelperParams>(
+        messages::fuse::GetHelperParams{
+            storageId.toStdString(), spaceId.toStdString(), mode});
+}
+
+folly::Future<HelpersCache::HelperPtr> HelpersCache::requestHelper(
+    const folly::fbstring &spaceId, const folly::fbstring &storageId,
+    const messages::fuse::GetHelperParams::HelperMode mode)
+{
+    return requestHelperParams(spaceId, storageId, mode)
+        .then([this, storageId](const messages::fuse::HelperParams &params) {
+            LOG_DBG(1) << "Creating " << params.name()
+                       << " storage helper for storage " << storageId;
+
+            return executor(storageId).helperFactory().getStorageHelper(
+                params.name(), params.args(), m_options.isIOBuffered());
+        });
+}
+
+HelpersCache::HelperPtr HelpersCache::resolveDirectHelper(
+    const folly::fbstring &fileUuid, const folly::fbstring &spaceId,
+    const folly::fbstring &storageId)
+{
+    LOG_DBG(1) << "Resolving storage helper for storage " << storageId
+               << " in forced directIO mode";
 
+    try {
         auto params = communication::wait(
-            m_communicator.communicate<messages::fuse::HelperParams>(
-                messages::fuse::GetHelperParams{storageId.toStdString(),
-                    spaceId.toStdString(),
-                    messages::fuse::GetHelperParams::HelperMode::autoMode}),
+            requestHelperParams(spaceId, storageId,
+                messages::fuse::GetHelperParams::HelperMode::directMode),
             m_providerTimeout);
 
-        auto helper = m_helperFactory.getStorageHelper(
-            params.name(), params.args(), m_options.isIOBuffered());
+        LOG_DBG(1) << "Received storage helper params: " << params.name();
+
+        if (params.name() == helpers::PROXY_HELPER_NAME) {
+            LOG(ERROR)
+                << "File " << fileUuid
+                << " is not accessible in directIO mode on this provider";
+            throw std::errc::operation_not_supported;
+        }
+
+        if (params.name() == helpers::POSIX_HELPER_NAME) {
+            LOG_DBG(1) << "Direct IO requested to Posix storage - attempting "
+                          "storage mountpoint detection in local filesystem";
+
+            communication::wait(
+                requestStorageTestFileCreation(fileUuid, storageId),
+                m_providerTimeout);
 
-        m_cache[helperKey] = helper;
-        return helper;
+            std::lock_guard<std::mutex> guard{m_cacheMutex};
+
+            auto helperIt = m_cache.find(std::make_tuple(storageId, false));
+            if (helperIt == m_cache.end()) {
+                LOG(ERROR) << "Direct IO access forced to storage "
+                           << storageId
+                           << " but storage is not accessible from here";
+                throw std::errc::operation_not_supported;
+            }
+
+            return helperIt->second;
+        }
+
+        LOG_DBG(1) << "Got storage helper params for file " << fileUuid
+                   << " on " << params.name() << " storage " << storageId;
+
+        return executor(storageId).helperFactory().getStorageHelper(
+            params.name(), params.args(), m_options.isIOBuffered());
+    }
+    catch (std::exception &e) {
+        LOG_DBG(1) << "Unexpected error when waiting for storage helper: "
+                   << e.what();
+        throw std::errc::resource_unavailable_try_again;
     }
 }
 
-void HelpersCache::requestStorageTestFileCreation(
+folly::Future<folly::Unit> HelpersCache::requestStorageTestFileCreation(
     const folly::fbstring &fileUuid, const folly::fbstring &storageId)
 {
     LOG_DBG(1) << "Requesting storage test file creation for file: '"
                << fileUuid << "' and storage: '" << storageId << "'";
 
-    try {
-        auto testFile = communication::wait(
-            m_communicator.communicate<messages::fuse::StorageTestFile>(
-                messages::fuse::CreateStorageTestFile{
-                    fileUuid.toStdString(), storageId.toStdString()}),
-            m_providerTimeout);
-
-        auto sharedTestFileMsg =
-            std::make_shared<messages::fuse::StorageTestFile>(
-                std::move(testFile));
+    auto detected = std::make_shared<folly::Promise<folly::Unit>>();
+    auto detectedFuture = detected->getFuture();
+
+    m_communicator
+        .communicate<messages::fuse::StorageTestFile>(
+            messages::fuse::CreateStorageTestFile{
+                fileUuid.toStdString(), storageId.toStdString()})
+        .within(m_providerTimeout)
+        .then([this, storageId, detected](
+                  messages::fuse::StorageTestFile testFile) {
+            auto sharedTestFileMsg =
+                std::make_shared<messages::fuse::StorageTestFile>(
+                    std::move(testFile));
+
+            // Probing mount points may block on slow storages, so it's done
+            // on the probe executor rather than on the communicator's thread
+            m_probeExecutor.post([=] {
+                handleStorageTestFile(sharedTestFileMsg, storageId,
+                    VERIFY_TEST_FILE_ATTEMPTS, detected);
+            });
+        })
+        .onError([this, storageId, detected](folly::exception_wrapper ew) {
+            LOG(WARNING) << "Storage test file creation error for storage '"
+                         << storageId << "': " << ew.what();
+
+            bool retry = ew.is_compatible_with<folly::FutureTimeout>();
+            ew.with_exception([&](const std::system_error &e) {
+                retry = e.code().value() == EAGAIN;
+            });
+
+            if (retry) {
+                std::lock_guard<std::mutex> guard{m_cacheMutex};
+                m_accessType.erase(storageId);
+            }
+            else {
+                LOG(INFO) << "Storage '" << storageId
+                          << "' is not directly accessible to the client.";
+            }
 
-        handleStorageTestFile(
-            sharedTestFileMsg, storageId, VERIFY_TEST_FILE_ATTEMPTS);
-    }
-    catch (const std::system_error &e) {
-        LOG(WARNING) << "Storage test file creation error, code: '" << e.code()
-                     << "', message: '" << e.what() << "'";
+            detected->setValue();
+        });
 
-        if (e.code().value() == EAGAIN)
-            m_accessType.erase(storageId);
-        else
-            LOG(INFO) << "Storage '" << storageId
-                      << "' is not directly accessible to the client.";
-    }
+    return detectedFuture;
 }
 
 void HelpersCache::handleStorageTestFile(
     std::shared_ptr<messages::fuse::StorageTestFile> testFile,
-    const folly::fbstring &storageId, const std::size_t attempts)
+    const folly::fbstring &storageId, const std::size_t attempts,
+    std::shared_ptr<folly::Promise<folly::Unit>> detected)
 {
     LOG_DBG(1) << "Handling storage test file for storage: '" << storageId
                << "' with remaining attempts: " << attempts << ".";
@@ -276,30 +441,70 @@ void HelpersCache::handleStorageTestFile(
                   << "' is not directly accessible to the client. Test "
                      "file verification attempts limit exceeded.";
 
-        m_accessType[storageId] = AccessType::PROXY;
+        {
+            std::lock_guard<std::mutex> guard{m_cacheMutex};
+            m_accessType[storageId] = AccessType::PROXY;
+        }
+
+        m_storageAccessManager.forgetDetectedStorage(storageId);
+        detected->setValue();
         return;
     }
 
+    // The probes' results are handled on the probe executor as well, and
+    // no thread waits for the probes to complete
+    folly::makeFutureWith([&] {
+        return m_storageAccessManager.verifyStorageTestFile(*testFile);
+    })
+        .then([=](folly::Try<folly::Optional<DetectedStorageAccess>> access) {
+            m_probeExecutor.post([ =, access = std::move(access) ]() mutable {
+                handleDetectedStorageAccess(testFile, storageId, attempts,
+                    detected, std::move(access));
+            });
+        });
+}
+
+void HelpersCache::handleDetectedStorageAccess(
+    std::shared_ptr<messages::fuse::StorageTestFile> testFile,
+    const folly::fbstring &storageId, const std::size_t attempts,
+    std::shared_ptr<folly::Promise<folly::Unit>> detected,
+    folly::Try<folly::Optional<DetectedStorageAccess>> result)
+{
     try {
-        auto helper = m_storageAccessManager.verifyStorageTestFile(*testFile);
-        if (!helper) {
-            m_scheduler.schedule(
-                VERIFY_TEST_FILE_DELAY, [ =, testFile = std::move(testFile) ] {
-                    handleStorageTestFile(testFile, storageId, attempts - 1);
+        auto access = std::move(result).value();
+        if (!access) {
+            m_scheduler.schedule(VERIFY_TEST_FILE_DELAY,
+                [ =, testFile = std::move(testFile) ] {
+                    m_probeExecutor.post([=] {
+                        handleStorageTestFile(
+                            testFile, storageId, attempts - 1, detected);
+                    });
                 });
             return;
         }
 
-        auto fileContent =
-            m_storageAccessManager.modifyStorageTestFile(helper, *testFile);
+        auto fileContent = m_storageAccessManager.modifyStorageTestFile(
+            access->helper, *testFile);
+
+        auto helper = isolate(storageId, *access);
+
+        {
+            std::lock_guard<std::mutex> guard{m_cacheMutex};
+            m_cache[std::make_tuple(storageId, false)] = std::move(helper);
+        }
+
         requestStorageTestFileVerification(*testFile, storageId, fileContent);
 
-        m_cache[std::make_pair(storageId, false)] = helper;
+        if (getAccessType(storageId) == AccessType::DIRECT)
+            m_storageAccessManager.persistDetectedStorage(storageId, *access);
+        else
+            m_storageAccessManager.forgetDetectedStorage(storageId);
     }
     catch (const std::system_error &e) {
         LOG(ERROR) << "Storage test file handling error, code: '" << e.code()
                    << "', message: '" << e.what() << "'";
 
+        std::lock_guard<std::mutex> guard{m_cacheMutex};
         if (e.code().value() == EAGAIN) {
             m_accessType.erase(storageId);
         }
@@ -310,6 +515,16 @@ void HelpersCache::handleStorageTestFile(
             m_accessType[storageId] = AccessType::PROXY;
         }
     }
+    catch (const std::exception &e) {
+        LOG(ERROR) << "Storage test file handling error: " << e.what();
+        LOG(INFO) << "Storage '" << storageId
+                  << "' is not directly accessible to the client.";
+
+        std::lock_guard<std::mutex> guard{m_cacheMutex};
+        m_accessType[storageId] = AccessType::PROXY;
+    }
+
+    detected->setValue();
 }
 
 void HelpersCache::requestStorageTestFileVerification(
@@ -346,6 +561,8 @@ void HelpersCache::handleStorageTestFileVerification(
     LOG_DBG(1) << "Handling verification of storage direct access: "
                << storageId;
 
+    std::lock_guard<std::mutex> guard{m_cacheMutex};
+
     if (!ec) {
         LOG(INFO) << "Storage " << storageId
                   << " is directly accessible to the client.";
@@ -12,23 +12,30 @@
 #include "communication/communicator.h"
 #include "helpers/storageHelper.h"
 #include "helpers/storageHelperCreator.h"
+#include "ioPathSelector.h"
+#include "messages/fuse/getHelperParams.h"
 #include "options/options.h"
 #include "scheduler.h"
 #include "storageAccessManager.h"
+#include "storageExecutor.h"
 
-#include <asio/io_service.hpp>
-#include <asio/ts/executor.hpp>
 #include <folly/FBString.h>
 #include <folly/FBVector.h>
 #include <folly/Hash.h>
+#include <folly/futures/Future.h>
+#include <folly/futures/SharedPromise.h>
 
-#include <thread>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <tuple>
 #include <utility>
 
 namespace one {
 namespace messages {
 namespace fuse {
+class HelperParams;
 class StorageTestFile;
 }
 }
@@ -50,25 +57,22 @@ public:
 
     /**
      * Constructor.
-     * Starts an @c asio::io_service instance with one worker thread for
-     * @c helpers::StorageHelperCreator.
+     * Starts a default @c StorageExecutor shared by all storages, unless
+     * each storage is configured to get its own.
      * @param communicator Communicator instance used to fetch helper
      * parameters.
-     * @param scheduler Scheduler instance used to execute storage detection
-     * operations.
+     * @param scheduler Scheduler instance used to delay storage detection
+     * retries.
      * @param options Options instance used to configure buffer limits.
      */
     HelpersCache(communication::Communicator &communicator,
         Scheduler &scheduler, const options::Options &options);
 
-    /**
-     * Destructor.
-     * Stops the @c asio::io_service instance and a worker thread.
-     */
-    virtual ~HelpersCache();
+    virtual ~HelpersCache() = default;
 
     /**
-     * Retrieves a helper instance.
+     * Retrieves a helper instance. If the helper is already being resolved
+     * by another request, the caller is suspended until it is available.
      * @param fileUuid UUID of a file for which helper will be used.
      * @param spaceId SpaceId in the context of which the helper should be
      *                determined.
@@ -87,13 +91,87 @@ public:
     virtual HelpersCache::AccessType getAccessType(
         const folly::fbstring &storageId);
 
+    /**
+     * Returns the access type currently selected for new helper handles on
+     * a specific storage. This differs from @c getAccessType only when
+     * adaptive IO path selection moved a directly accessible storage to
+     * proxy IO.
+     */
+    virtual HelpersCache::AccessType getSelectedAccessType(
+        const folly::fbstring &storageId);
+
+    /**
+     * Checks whether a helper returned by @c get accesses the storage
+     * directly. Helpers returned before the storage has been detected use
+     * proxy IO even if it was not requested.
+     * @param storageId Storage id for which the helper was retrieved.
+     * @param helper The helper.
+     * @return true if the helper is the direct helper of the storage.
+     */
+    virtual bool isDirectHelper(
+        const folly::fbstring &storageId, const HelperPtr &helper);
+
+    /**
+     * Decides whether a new helper handle on a directly accessible storage
+     * should use proxy IO, based on throughput measured on both paths.
+     * @param storageId Storage id for which the handle will be opened.
+     * @return true if proxy IO should be used for the new handle.
+     */
+    virtual bool selectProxyIO(const folly::fbstring &storageId);
+
+    /**
+     * Records a completed helper read or write used for adaptive IO path
+     * selection.
+     * @param storageId Storage id on which the operation was performed.
+     * @param proxyIO Whether the operation used a proxy IO helper.
+     * @param bytes Number of bytes transferred.
+     * @param duration Duration of the operation.
+     */
+    virtual void recordIO(const folly::fbstring &storageId, bool proxyIO,
+        std::size_t bytes, std::chrono::nanoseconds duration);
+
+    /**
+     * Admits an IO operation to the queue of the executor running helpers of
+     * a storage, suspending the caller while the queue is full.
+     * @param storageId Storage id on which the operation will be performed.
+     * @return Slot of the operation, freed when destroyed.
+     */
+    virtual StorageExecutor::QueueSlot acquireQueueSlot(
+        const folly::fbstring &storageId);
+
 private:
-    void requestStorageTestFileCreation(
+    StorageExecutor &executor(const folly::fbstring &storageId);
+
+    HelperPtr isolate(
+        const folly::fbstring &storageId, const DetectedStorageAccess &access);
+
+    HelperPtr getOrResolve(const std::tuple<folly::fbstring, bool> &helperKey,
+        std::function<HelperPtr()> resolve);
+
+    folly::Future<messages::fuse::HelperParams> requestHelperParams(
+        const folly::fbstring &spaceId, const folly::fbstring &storageId,
+        const messages::fuse::GetHelperParams::HelperMode mode);
+
+    folly::Future<HelperPtr> requestHelper(const folly::fbstring &spaceId,
+        const folly::fbstring &storageId,
+        const messages::fuse::GetHelperParams::HelperMode mode);
+
+    HelperPtr resolveDirectHelper(const folly::fbstring &fileUuid,
+        const folly::fbstring &spaceId, const folly::fbstring &storageId);
+
+    folly::Future<folly::Unit> requestStorageTestFileCreation(
         const folly::fbstring &fileUuid, const folly::fbstring &storageId);
 
     void handleStorageTestFile(
         std::shared_ptr<messages::fuse::StorageTestFile> testFile,
-        const folly::fbstring &storageId, const std::size_t attempts);
+        const folly::fbstring &storageId, const std::size_t attempts,
+        std::shared_ptr<folly::Promise<folly::Unit>> detected);
+
+    void handleDetectedStorageAccess(
+        std::shared_ptr<messages::fuse::StorageTestFile> testFile,
+        const folly::fbstring &storageId, const std::size_t attempts,
+        std::shared_ptr<folly::Promise<folly::Unit>> detected,
+        folly::Try<folly::Optional<DetectedStorageAccess>> result);
 
     void requestStorageTestFileVerification(
         const messages::fuse::StorageTestFile &testFile,
@@ -106,16 +184,29 @@ private:
     Scheduler &m_scheduler;
     const options::Options &m_options;
 
-    asio::io_service m_helpersIoService;
-    asio::executor_work_guard<asio::io_service::executor_type> m_idleWork{
-        asio::make_work_guard(m_helpersIoService)};
-    folly::fbvector<std::thread> m_helpersWorkers;
-
-    helpers::StorageHelperCreator m_helperFactory;
+    StorageExecutor m_defaultExecutor;
+    // Runs storage detection and mount point probes, so that neither
+    // the scheduler nor helpers of detected storages are blocked by them
+    StorageExecutor m_probeExecutor;
     StorageAccessManager m_storageAccessManager;
 
+    // Executors of storages which run their helpers in isolation, created on
+    // first use
+    std::mutex m_executorsMutex;
+    std::unordered_map<folly::fbstring, std::unique_ptr<StorageExecutor>>
+        m_executors;
+
+    // Guards access types and helpers, which storage detection updates
+    // from probe threads
+    std::mutex m_cacheMutex;
     std::unordered_map<folly::fbstring, AccessType> m_accessType;
     std::unordered_map<std::tuple<folly::fbstring, bool>, HelperPtr> m_cache;
+    // Helpers being resolved, keyed like m_cache, which concurrent requests
+    // for the same helper wait for
+    std::unordered_map<std::tuple<folly::fbstring, bool>,
+        std::shared_ptr<folly::SharedPromise<HelperPtr>>>
+        m_pendingHelpers;
+    std::unordered_map<folly::fbstring, IOPathSelector> m_ioPathSelectors;
     std::chrono::milliseconds m_providerTimeout;
 };
 
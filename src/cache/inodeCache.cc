@@ -85,6 +85,19 @@ folly::fbstring InodeCache::at(const fuse_ino_t inode) const
     return entryIt->uuid;
 }
 
+folly::Optional<fuse_ino_t> InodeCache::find(
+    const folly::fbstring &uuid) const
+{
+    LOG_FCALL() << LOG_FARG(uuid);
+
+    auto &index = boost::multi_index::get<ByUuid>(m_cache);
+    auto entryIt = index.find(uuid);
+    if (entryIt == index.end() || entryIt->lruIt)
+        return {};
+
+    return entryIt->inode;
+}
+
 void InodeCache::forget(const fuse_ino_t inode, const std::size_t count)
 {
     LOG_FCALL() << LOG_FARG(inode) << LOG_FARG(count);
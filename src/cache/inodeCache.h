@@ -52,6 +52,15 @@ public:
      */
     folly::fbstring at(const fuse_ino_t ino) const;
 
+    /**
+     * Returns an inode associated with the uuid, without changing its lookup
+     * count.
+     * @param uuid Uuid to look up by.
+     * @returns Inode associated with the uuid, or empty @c folly::Optional if
+     * the uuid has no active mapping.
+     */
+    folly::Optional<fuse_ino_t> find(const folly::fbstring &uuid) const;
+
     /**
      * Decrements lookup cound of a cached inode.
      * @param inode The cached inode.
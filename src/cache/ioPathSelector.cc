@@ -0,0 +1,88 @@
+/**
+ * @file ioPathSelector.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "ioPathSelector.h"
+
+#include <algorithm>
+
+namespace one {
+namespace client {
+namespace cache {
+
+constexpr double IOPathSelector::EWMA_WEIGHT;
+constexpr double IOPathSelector::SWITCH_RATIO;
+constexpr std::size_t IOPathSelector::MIN_SAMPLES;
+constexpr std::chrono::seconds IOPathSelector::MIN_DWELL;
+constexpr std::size_t IOPathSelector::EXPLORE_INTERVAL;
+constexpr std::size_t IOPathSelector::SIZE_CLASS_COUNT;
+constexpr std::size_t IOPathSelector::MIN_SIZE_CLASS_BYTES;
+
+bool IOPathSelector::selectProxyIO()
+{
+    if (++m_handles % EXPLORE_INTERVAL == 0)
+        return !m_proxySelected;
+
+    return m_proxySelected;
+}
+
+bool IOPathSelector::recordIO(const bool proxyIO, const std::size_t bytes,
+    const std::chrono::nanoseconds duration,
+    const std::chrono::steady_clock::time_point now)
+{
+    if (bytes == 0)
+        return false;
+
+    const auto cls = sizeClass(bytes);
+    auto &stats = proxyIO ? m_proxy[cls] : m_direct[cls];
+
+    const auto seconds =
+        std::max(std::chrono::duration<double>{duration}.count(), 1e-6);
+    const auto throughput = bytes / seconds;
+
+    if (stats.samples++ == 0)
+        stats.throughput = throughput;
+    else
+        stats.throughput = EWMA_WEIGHT * throughput +
+            (1 - EWMA_WEIGHT) * stats.throughput;
+
+    const auto &current = m_proxySelected ? m_proxy[cls] : m_direct[cls];
+    const auto &other = m_proxySelected ? m_direct[cls] : m_proxy[cls];
+
+    if (current.samples < MIN_SAMPLES || other.samples < MIN_SAMPLES ||
+        other.throughput < SWITCH_RATIO * current.throughput)
+        return false;
+
+    if (m_lastSwitch != std::chrono::steady_clock::time_point{} &&
+        now - m_lastSwitch < MIN_DWELL)
+        return false;
+
+    m_proxySelected = !m_proxySelected;
+    m_lastSwitch = now;
+    return true;
+}
+
+double IOPathSelector::throughput(
+    const bool proxyIO, const std::size_t bytes) const
+{
+    const auto cls = sizeClass(bytes);
+    return proxyIO ? m_proxy[cls].throughput : m_direct[cls].throughput;
+}
+
+std::size_t IOPathSelector::sizeClass(std::size_t bytes)
+{
+    std::size_t cls = 0;
+    for (bytes /= MIN_SIZE_CLASS_BYTES; bytes > 0 && cls + 1 < SIZE_CLASS_COUNT;
+         bytes /= 4)
+        ++cls;
+
+    return cls;
+}
+
+} // namespace cache
+} // namespace client
+} // namespace one
@@ -0,0 +1,105 @@
+/**
+ * @file ioPathSelector.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_IO_PATH_SELECTOR_H
+#define ONECLIENT_IO_PATH_SELECTOR_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace one {
+namespace client {
+namespace cache {
+
+/**
+ * @c IOPathSelector chooses between direct and proxy IO for new helper
+ * handles on a single directly accessible storage, based on throughput of
+ * completed reads and writes measured on both paths.
+ *
+ * Throughput of an operation depends on its size, as small operations are
+ * dominated by latency, so operations are grouped into size classes and
+ * the paths are compared only within the size class of each recorded
+ * operation. The selected path is switched when the other path has been
+ * measured to be at least @c SWITCH_RATIO times faster, with at least
+ * @c MIN_SAMPLES operations of the size class on each path, and not more
+ * often than once per @c MIN_DWELL. Every @c EXPLORE_INTERVAL-th handle
+ * uses the path which is not selected, so that its measurements stay up to
+ * date. The selector is not thread safe.
+ */
+class IOPathSelector {
+public:
+    static constexpr double EWMA_WEIGHT = 0.2;
+    static constexpr double SWITCH_RATIO = 1.5;
+    static constexpr std::size_t MIN_SAMPLES = 8;
+    static constexpr std::chrono::seconds MIN_DWELL{30};
+    static constexpr std::size_t EXPLORE_INTERVAL = 16;
+
+    /**
+     * Operations smaller than 4 KiB fall into the first size class, and
+     * each next class holds 4 times larger operations.
+     */
+    static constexpr std::size_t SIZE_CLASS_COUNT = 8;
+    static constexpr std::size_t MIN_SIZE_CLASS_BYTES = 4096;
+
+    /**
+     * Decides whether a new helper handle should use proxy IO.
+     * @return true if proxy IO should be used for the new handle.
+     */
+    bool selectProxyIO();
+
+    /**
+     * @return true if proxy IO is currently selected for new handles.
+     */
+    bool proxySelected() const { return m_proxySelected; }
+
+    /**
+     * Records a completed helper read or write.
+     * @param proxyIO Whether the operation used a proxy IO helper.
+     * @param bytes Number of bytes transferred.
+     * @param duration Duration of the operation.
+     * @param now Time at which the operation completed.
+     * @return true if the selected path has been switched.
+     */
+    bool recordIO(const bool proxyIO, const std::size_t bytes,
+        const std::chrono::nanoseconds duration,
+        const std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now());
+
+    /**
+     * @param proxyIO Whether to return the throughput of proxy IO.
+     * @param bytes Size of an operation determining the size class.
+     * @return Average throughput in bytes per second measured on a path for
+     * operations of the size class, or 0 if none has been recorded.
+     */
+    double throughput(const bool proxyIO, const std::size_t bytes) const;
+
+private:
+    struct Stats {
+        // Exponentially weighted moving average of throughput in bytes per
+        // second
+        double throughput = 0;
+        std::size_t samples = 0;
+    };
+
+    using PathStats = std::array<Stats, SIZE_CLASS_COUNT>;
+
+    static std::size_t sizeClass(std::size_t bytes);
+
+    PathStats m_direct;
+    PathStats m_proxy;
+    bool m_proxySelected = false;
+    std::chrono::steady_clock::time_point m_lastSwitch;
+    std::size_t m_handles = 0;
+};
+
+} // namespace cache
+} // namespace client
+} // namespace one
+
+#endif // ONECLIENT_IO_PATH_SELECTOR_H
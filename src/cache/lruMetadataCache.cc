@@ -78,8 +78,8 @@ std::shared_ptr<LRUMetadataCache::OpenFileToken> LRUMetadataCache::open(
     pinEntry(uuid);
 
     try {
-        auto attr = MetadataCache::getAttr(uuid);
         MetadataCache::ensureAttrAndLocationCached(uuid);
+        auto attr = MetadataCache::getAttr(uuid);
         prune();
         return std::make_shared<OpenFileToken>(std::move(attr), *this);
     }
@@ -44,6 +44,12 @@ void MetadataCache::setReaddirCache(std::shared_ptr<ReaddirCache> readdirCache)
     m_readdirCache = readdirCache;
 }
 
+void MetadataCache::setResilientCommunicator(
+    std::shared_ptr<ResilientCommunicator> communicator)
+{
+    m_resilientCommunicator = std::move(communicator);
+}
+
 FileAttrPtr MetadataCache::getAttr(const folly::fbstring &uuid)
 {
     return getAttrIt(uuid)->attr;
@@ -137,6 +143,17 @@ void MetadataCache::addBlock(const folly::fbstring &uuid,
     });
 }
 
+template <typename SrvMsg, typename ReqMsg>
+folly::Future<SrvMsg> MetadataCache::fetch(ReqMsg msg)
+{
+    if (!m_resilientCommunicator)
+        return m_communicator.communicate<SrvMsg>(std::move(msg));
+
+    // Fetching metadata is idempotent, so the request can be hedged
+    return m_resilientCommunicator->communicateHedged<SrvMsg, ReqMsg>(
+        [msg = std::move(msg)] { return msg; }, m_providerTimeout);
+}
+
 template <typename ReqMsg>
 MetadataCache::Map::iterator MetadataCache::fetchAttr(ReqMsg &&msg)
 {
@@ -145,9 +162,13 @@ MetadataCache::Map::iterator MetadataCache::fetchAttr(ReqMsg &&msg)
     LOG_DBG(1) << "Fetching attribute for metadata cache";
 
     auto attr = communication::wait(
-        m_communicator.communicate<FileAttr>(std::forward<ReqMsg>(msg)),
-        m_providerTimeout);
+        fetch<FileAttr>(std::forward<ReqMsg>(msg)), m_providerTimeout);
+
+    return putFetchedAttr(std::move(attr));
+}
 
+MetadataCache::Map::iterator MetadataCache::putFetchedAttr(FileAttr attr)
+{
     if (!attr.size()) {
         LOG(ERROR)
             << "Received invalid message from server when fetching attribute.";
@@ -197,10 +218,16 @@ std::shared_ptr<FileLocation> MetadataCache::fetchFileLocation(
     LOG_FCALL() << LOG_FARG(uuid);
 
     auto location = communication::wait(
-        m_communicator.communicate<FileLocation>(
+        fetch<FileLocation>(
             messages::fuse::GetFileLocation{uuid.toStdString()}),
         m_providerTimeout);
 
+    return putFetchedLocation(uuid, std::move(location));
+}
+
+std::shared_ptr<FileLocation> MetadataCache::putFetchedLocation(
+    const folly::fbstring &uuid, FileLocation location)
+{
     auto sharedLocation = std::make_shared<FileLocation>(std::move(location));
 
     auto &index = boost::multi_index::get<ByUuid>(m_cache);
@@ -251,8 +278,27 @@ void MetadataCache::ensureAttrAndLocationCached(const folly::fbstring &uuid)
 {
     LOG_FCALL() << LOG_FARG(uuid);
 
-    auto it = getAttrIt(uuid);
-    getLocationPtr(it);
+    auto &index = boost::multi_index::get<ByUuid>(m_cache);
+    auto it = index.find(uuid);
+    if (it != index.end()) {
+        getLocationPtr(it);
+        return;
+    }
+
+    LOG_DBG(1) << "Metadata for " << uuid
+               << " not found in cache - fetching attributes and location "
+                  "from server";
+
+    // Location doesn't depend on attributes, so both requests are sent
+    // before waiting for any of the responses
+    auto attrFuture = fetch<FileAttr>(messages::fuse::GetFileAttr{uuid});
+    auto locationFuture = fetch<FileLocation>(
+        messages::fuse::GetFileLocation{uuid.toStdString()});
+
+    putFetchedAttr(
+        communication::wait(std::move(attrFuture), m_providerTimeout));
+    putFetchedLocation(uuid,
+        communication::wait(std::move(locationFuture), m_providerTimeout));
 }
 
 void MetadataCache::erase(const folly::fbstring &uuid)
@@ -426,9 +472,9 @@ bool MetadataCache::rename(const folly::fbstring &uuid,
     return true;
 }
 
-bool MetadataCache::updateAttr(const FileAttr &newAttr)
+bool MetadataCache::updateAttr(const FileAttr &newAttr, const bool force)
 {
-    LOG_FCALL() << LOG_FARG(newAttr.toString());
+    LOG_FCALL() << LOG_FARG(newAttr.toString()) << LOG_FARG(force);
 
     auto &index = boost::multi_index::get<ByUuid>(m_cache);
     auto it = index.find(newAttr.uuid());
@@ -449,9 +495,16 @@ bool MetadataCache::updateAttr(const FileAttr &newAttr)
                     0, *newAttr.size());
         }
 
-        m.attr->atime(std::max(m.attr->atime(), newAttr.atime()));
-        m.attr->ctime(std::max(m.attr->ctime(), newAttr.ctime()));
-        m.attr->mtime(std::max(m.attr->mtime(), newAttr.mtime()));
+        if (force) {
+            m.attr->atime(newAttr.atime());
+            m.attr->ctime(newAttr.ctime());
+            m.attr->mtime(newAttr.mtime());
+        }
+        else {
+            m.attr->atime(std::max(m.attr->atime(), newAttr.atime()));
+            m.attr->ctime(std::max(m.attr->ctime(), newAttr.ctime()));
+            m.attr->mtime(std::max(m.attr->mtime(), newAttr.mtime()));
+        }
         m.attr->gid(newAttr.gid());
         m.attr->mode(newAttr.mode());
         if (newAttr.size())
@@ -13,6 +13,7 @@
 #include "communication/communicator.h"
 #include "helpers/storageHelper.h"
 #include "messages/fuse/fileBlock.h"
+#include "resilientCommunicator.h"
 
 #include <boost/icl/interval_set.hpp>
 #include <boost/multi_index/composite_key.hpp>
@@ -55,6 +56,15 @@ public:
      */
     void setReaddirCache(std::shared_ptr<ReaddirCache> readdirCache);
 
+    /**
+     * Sets a communicator through which attributes and locations are fetched
+     * with hedging and circuit breaking, instead of the plain communicator.
+     * @param communicator Shared pointer to an instance of
+     * @c ResilientCommunicator.
+     */
+    void setResilientCommunicator(
+        std::shared_ptr<ResilientCommunicator> communicator);
+
     /**
      * Retrieves file attributes by uuid.
      * @param uuid Uuid of the file.
@@ -130,7 +140,8 @@ public:
 
     /**
      * Ensures that file attributes and location is present in the cache by
-     * fetching them from the server if missing.
+     * fetching them from the server if missing. If neither is cached, both
+     * are requested concurrently.
      * @param uuid Uuid of the file.
      */
     void ensureAttrAndLocationCached(const folly::fbstring &uuid);
@@ -167,10 +178,12 @@ public:
     /**
      * Updates file attributes, if cached.
      * @param newAttr Updated attributes.
+     * @param force If true, times are taken from @c newAttr even if they are
+     * older than the cached ones (e.g. when they were explicitly set).
      * @returns true if attributes have been updated, false if they were not
      * cached.
      */
-    bool updateAttr(const FileAttr &newAttr);
+    bool updateAttr(const FileAttr &newAttr, const bool force = false);
 
     /**
      * Updates file location, if cached.
@@ -259,13 +272,21 @@ private:
 
     Map::iterator getAttrIt(const folly::fbstring &uuid);
 
+    template <typename SrvMsg, typename ReqMsg>
+    folly::Future<SrvMsg> fetch(ReqMsg msg);
+
     template <typename ReqMsg> Map::iterator fetchAttr(ReqMsg &&msg);
 
+    Map::iterator putFetchedAttr(FileAttr attr);
+
     std::shared_ptr<FileLocation> getLocationPtr(const Map::iterator &it);
 
     std::shared_ptr<FileLocation> fetchFileLocation(
         const folly::fbstring &uuid);
 
+    std::shared_ptr<FileLocation> putFetchedLocation(
+        const folly::fbstring &uuid, FileLocation location);
+
     void markDeletedIt(const Map::iterator &it);
 
     communication::Communicator &m_communicator;
@@ -277,6 +298,7 @@ private:
         m_onRename = [](auto, auto) {};
 
     std::shared_ptr<ReaddirCache> m_readdirCache;
+    std::shared_ptr<ResilientCommunicator> m_resilientCommunicator;
 
     const std::chrono::seconds m_providerTimeout;
 };
@@ -0,0 +1,95 @@
+/**
+ * @file smallFileCache.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "smallFileCache.h"
+
+#include "logging.h"
+#include "monitoring/monitoring.h"
+
+namespace one {
+namespace client {
+namespace cache {
+
+SmallFileCache::SmallFileCache(const std::size_t capacity)
+    : m_capacity{capacity}
+{
+}
+
+void SmallFileCache::put(const folly::fbstring &uuid, folly::fbstring data,
+    const std::chrono::system_clock::time_point mtime)
+{
+    LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(data.size());
+
+    erase(uuid);
+
+    if (data.size() > m_capacity) {
+        LOG_DBG(1) << "Contents of file " << uuid
+                   << " exceed small file cache capacity";
+        return;
+    }
+
+    while (m_size + data.size() > m_capacity) {
+        LOG_DBG(2) << "Evicting contents of file " << m_lruList.back()
+                   << " from small file cache";
+        erase(m_entries.find(m_lruList.back()));
+    }
+
+    m_size += data.size();
+    m_lruList.push_front(uuid);
+
+    Entry entry;
+    entry.data = std::make_shared<const folly::fbstring>(std::move(data));
+    entry.mtime = mtime;
+    entry.lruIt = m_lruList.begin();
+    m_entries.emplace(uuid, std::move(entry));
+
+    ONE_METRIC_COUNTER_SET("comp.oneclient.mod.smallfilecache.size", m_size);
+}
+
+std::shared_ptr<const folly::fbstring> SmallFileCache::get(
+    const folly::fbstring &uuid, const std::size_t size,
+    const std::chrono::system_clock::time_point mtime)
+{
+    LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(size);
+
+    auto it = m_entries.find(uuid);
+    if (it == m_entries.end())
+        return {};
+
+    if (it->second.data->size() != size || it->second.mtime != mtime) {
+        LOG_DBG(1) << "Cached contents of file " << uuid
+                   << " are stale - removing from small file cache";
+        erase(it);
+        return {};
+    }
+
+    m_lruList.splice(m_lruList.begin(), m_lruList, it->second.lruIt);
+
+    return it->second.data;
+}
+
+void SmallFileCache::erase(const folly::fbstring &uuid)
+{
+    auto it = m_entries.find(uuid);
+    if (it != m_entries.end())
+        erase(it);
+}
+
+void SmallFileCache::erase(
+    std::unordered_map<folly::fbstring, Entry>::iterator it)
+{
+    m_size -= it->second.data->size();
+    m_lruList.erase(it->second.lruIt);
+    m_entries.erase(it);
+
+    ONE_METRIC_COUNTER_SET("comp.oneclient.mod.smallfilecache.size", m_size);
+}
+
+} // namespace cache
+} // namespace client
+} // namespace one
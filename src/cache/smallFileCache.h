@@ -0,0 +1,92 @@
+/**
+ * @file smallFileCache.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_SMALL_FILE_CACHE_H
+#define ONECLIENT_SMALL_FILE_CACHE_H
+
+#include <folly/FBString.h>
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace one {
+namespace client {
+namespace cache {
+
+/**
+ * @c SmallFileCache holds whole contents of small files, received inline with
+ * the provider's response to open, so that they can be read without opening
+ * the file on storage. The cache is bounded by the total size of contents
+ * it holds and evicts least recently used files first. Since modification
+ * times have a granularity of one second, contents are also expected to be
+ * erased by the owner on remote changes of the file.
+ */
+class SmallFileCache {
+public:
+    /**
+     * Constructor.
+     * @param capacity Maximum total size of cached contents in bytes.
+     */
+    SmallFileCache(const std::size_t capacity);
+
+    /**
+     * Stores contents of a file in the cache, replacing previous contents.
+     * Contents larger than the cache's capacity are not stored.
+     * @param uuid Uuid of the file.
+     * @param data Whole contents of the file.
+     * @param mtime Modification time of the file the contents correspond to.
+     */
+    void put(const folly::fbstring &uuid, folly::fbstring data,
+        const std::chrono::system_clock::time_point mtime);
+
+    /**
+     * Retrieves contents of a file, if they are cached and still match the
+     * file's attributes.
+     * @param uuid Uuid of the file.
+     * @param size Current size of the file.
+     * @param mtime Current modification time of the file.
+     * @returns Contents of the file or nullptr if they are not cached or are
+     * stale, in which case they are removed from the cache.
+     */
+    std::shared_ptr<const folly::fbstring> get(const folly::fbstring &uuid,
+        const std::size_t size,
+        const std::chrono::system_clock::time_point mtime);
+
+    /**
+     * Removes contents of a file from the cache.
+     * @param uuid Uuid of the file.
+     */
+    void erase(const folly::fbstring &uuid);
+
+    /**
+     * @returns Total size of cached contents in bytes.
+     */
+    std::size_t size() const { return m_size; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const folly::fbstring> data;
+        std::chrono::system_clock::time_point mtime;
+        std::list<folly::fbstring>::iterator lruIt;
+    };
+
+    void erase(std::unordered_map<folly::fbstring, Entry>::iterator it);
+
+    const std::size_t m_capacity;
+    std::size_t m_size = 0;
+    std::list<folly::fbstring> m_lruList;
+    std::unordered_map<folly::fbstring, Entry> m_entries;
+};
+
+} // namespace cache
+} // namespace client
+} // namespace one
+
+#endif // ONECLIENT_SMALL_FILE_CACHE_H
@@ -0,0 +1,131 @@
+/**
+ * @file storageExecutor.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "storageExecutor.h"
+
+#include "buffering/bufferAgent.h"
+#include "logging.h"
+#include "monitoring/monitoring.h"
+#include "options/options.h"
+
+#include <folly/ThreadName.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace one {
+namespace client {
+namespace cache {
+
+StorageExecutor::QueueSlot::QueueSlot(StorageExecutor *executor)
+    : m_executor{executor}
+{
+}
+
+StorageExecutor::QueueSlot::QueueSlot(QueueSlot &&other) noexcept
+    : m_executor{std::exchange(other.m_executor, nullptr)}
+{
+}
+
+StorageExecutor::QueueSlot &StorageExecutor::QueueSlot::operator=(
+    QueueSlot &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_executor = std::exchange(other.m_executor, nullptr);
+    }
+    return *this;
+}
+
+StorageExecutor::QueueSlot::~QueueSlot() { release(); }
+
+void StorageExecutor::QueueSlot::release()
+{
+    if (m_executor)
+        std::exchange(m_executor, nullptr)->releaseQueueSlot();
+}
+
+StorageExecutor::StorageExecutor(folly::fbstring name,
+    const std::size_t threadCount, const std::size_t queueDepth,
+    communication::Communicator &communicator,
+    const options::Options &options)
+    : m_name{std::move(name)}
+    , m_queueDepth{queueDepth}
+    , m_ioService{static_cast<int>(threadCount)}
+    , m_helperFactory
+{
+#if WITH_CEPH
+    m_ioService,
+#endif
+        m_ioService,
+#if WITH_S3
+        m_ioService,
+#endif
+#if WITH_SWIFT
+        m_ioService,
+#endif
+#if WITH_GLUSTERFS
+        m_ioService,
+#endif
+        m_ioService, communicator, options.getBufferSchedulerThreadCount(),
+        helpers::buffering::BufferLimits
+    {
+        options.getReadBufferMinSize(), options.getReadBufferMaxSize(),
+            options.getReadBufferPrefetchDuration(),
+            options.getWriteBufferMinSize(), options.getWriteBufferMaxSize(),
+            options.getWriteBufferFlushDelay()
+    }
+}
+, m_queuedMetric{"comp.oneclient.mod.helpers.executors." +
+      m_name.toStdString() + ".queued"}
+{
+    LOG_DBG(1) << "Starting storage executor " << m_name << " with "
+               << threadCount << " threads and queue depth " << queueDepth;
+
+    if (m_queueDepth > 0)
+        m_queueSlots = std::make_unique<folly::fibers::Semaphore>(m_queueDepth);
+
+    std::generate_n(std::back_inserter(m_workers), threadCount, [this] {
+        return std::thread{[this] {
+            folly::setThreadName("HelpersWorker");
+            m_ioService.run();
+        }};
+    });
+
+    ONE_METRIC_COUNTER_SET("comp.oneclient.mod.helpers.executors." +
+            m_name.toStdString() + ".threads",
+        threadCount);
+}
+
+StorageExecutor::~StorageExecutor()
+{
+    m_ioService.stop();
+    for (auto &worker : m_workers)
+        worker.join();
+}
+
+StorageExecutor::QueueSlot StorageExecutor::acquireQueueSlot()
+{
+    if (m_queueSlots)
+        m_queueSlots->wait();
+
+    ONE_METRIC_COUNTER_SET(m_queuedMetric, ++m_queued);
+    return QueueSlot{this};
+}
+
+void StorageExecutor::releaseQueueSlot()
+{
+    ONE_METRIC_COUNTER_SET(m_queuedMetric, --m_queued);
+
+    if (m_queueSlots)
+        m_queueSlots->signal();
+}
+
+} // namespace cache
+} // namespace client
+} // namespace one
@@ -0,0 +1,128 @@
+/**
+ * @file storageExecutor.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_STORAGE_EXECUTOR_H
+#define ONECLIENT_STORAGE_EXECUTOR_H
+
+#include "communication/communicator.h"
+#include "helpers/storageHelperCreator.h"
+
+#include <asio/io_service.hpp>
+#include <asio/post.hpp>
+#include <asio/ts/executor.hpp>
+#include <folly/FBString.h>
+#include <folly/FBVector.h>
+#include <folly/fibers/Semaphore.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace one {
+namespace client {
+namespace options {
+class Options;
+}
+namespace cache {
+
+/**
+ * @c StorageExecutor owns worker threads and a @c helpers::StorageHelperCreator
+ * running the storage helpers of a single storage, so that a slow storage
+ * backend cannot occupy workers serving other storages. Optionally, it also
+ * limits the number of IO operations queued on the storage at once.
+ */
+class StorageExecutor {
+public:
+    /**
+     * An IO operation admitted to the executor. The operation's slot in the
+     * queue is freed when the object is destroyed.
+     */
+    class QueueSlot {
+    public:
+        QueueSlot() = default;
+        explicit QueueSlot(StorageExecutor *executor);
+        QueueSlot(QueueSlot &&other) noexcept;
+        QueueSlot &operator=(QueueSlot &&other) noexcept;
+        ~QueueSlot();
+
+        /**
+         * Frees the slot before the object is destroyed.
+         */
+        void release();
+
+    private:
+        StorageExecutor *m_executor = nullptr;
+    };
+
+    /**
+     * Constructor.
+     * Starts worker threads of the executor.
+     * @param name Name of the executor, used in its metrics.
+     * @param threadCount Number of worker threads.
+     * @param queueDepth Maximum number of IO operations queued on the storage
+     * at once (0 for no limit).
+     * @param communicator Communicator instance used by proxy helpers.
+     * @param options Options instance used to configure buffer limits.
+     */
+    StorageExecutor(folly::fbstring name, const std::size_t threadCount,
+        const std::size_t queueDepth,
+        communication::Communicator &communicator,
+        const options::Options &options);
+
+    /**
+     * Destructor.
+     * Stops the worker threads.
+     */
+    ~StorageExecutor();
+
+    /**
+     * @returns Factory of storage helpers running on this executor.
+     */
+    helpers::StorageHelperCreator &helperFactory() { return m_helperFactory; }
+
+    /**
+     * Admits an IO operation to the storage's queue. If the queue is full,
+     * the calling fiber is suspended until another operation completes.
+     * @returns Slot of the operation in the queue.
+     */
+    QueueSlot acquireQueueSlot();
+
+    /**
+     * Runs a task on a worker thread of the executor.
+     * @param task Task to run.
+     */
+    template <typename Task> void post(Task &&task)
+    {
+        asio::post(m_ioService, std::forward<Task>(task));
+    }
+
+private:
+    void releaseQueueSlot();
+
+    const folly::fbstring m_name;
+    const std::size_t m_queueDepth;
+
+    asio::io_service m_ioService;
+    asio::executor_work_guard<asio::io_service::executor_type> m_idleWork{
+        asio::make_work_guard(m_ioService)};
+    folly::fbvector<std::thread> m_workers;
+
+    helpers::StorageHelperCreator m_helperFactory;
+
+    std::unique_ptr<folly::fibers::Semaphore> m_queueSlots;
+    std::atomic<std::size_t> m_queued{0};
+    const std::string m_queuedMetric;
+};
+
+} // namespace cache
+} // namespace client
+} // namespace one
+
+#endif // ONECLIENT_STORAGE_EXECUTOR_H
@@ -35,6 +35,13 @@ public:
      * @return A collection of aggregated events.
      */
     virtual Events<T> flush() = 0;
+
+    /**
+     * Removes and returns events aggregated under an aggregation key.
+     * @param key The aggregation key of events to return.
+     * @return A collection of aggregated events.
+     */
+    virtual Events<T> flush(const AggregationKey &key) = 0;
 };
 
 } // namespace events
@@ -41,6 +41,13 @@ public:
      */
     Events<T> flush() override;
 
+    /**
+     * Returns a container with an event aggregated under the aggregation key,
+     * or an empty container if there is no such event.
+     * @see Aggregator::flush(const AggregationKey &key)
+     */
+    Events<T> flush(const AggregationKey &key) override;
+
 private:
     std::unordered_map<AggregationKey, EventPtr<T>> m_events;
 };
@@ -77,6 +84,21 @@ template <class T> Events<T> KeyAggregator<T>::flush()
     return events;
 }
 
+template <class T>
+Events<T> KeyAggregator<T>::flush(const AggregationKey &key)
+{
+    LOG_FCALL() << LOG_FARG(key);
+
+    Events<T> events;
+    auto it = m_events.find(key);
+    if (it != m_events.end()) {
+        LOG_DBG(1) << "Emitting event: " << it->second->toString();
+        events.emplace_back(std::move(it->second));
+        m_events.erase(it);
+    }
+    return events;
+}
+
 } // namespace events
 } // namespace client
 } // namespace one
@@ -45,6 +45,7 @@ class Event;
 class Manager;
 class Stream;
 class SharedStream;
+class StreamTable;
 class Subscription;
 class SubscriptionHandle;
 
@@ -63,13 +64,10 @@ template <class T = Event> using EventPtr = std::unique_ptr<T>;
 template <class T> using Events = std::vector<EventPtr<T>>;
 
 using StreamPtr = std::unique_ptr<Stream>;
-using SharedStreamPtr = std::unique_ptr<SharedStream>;
 using SequencerStreamPtr = std::shared_ptr<SequencerStream>;
 using SubscriptionHandlePtr = std::unique_ptr<SubscriptionHandle>;
 
-using Streams = tbb::concurrent_hash_map<StreamKey, SharedStreamPtr>;
-using StreamAcc = typename Streams::accessor;
-using StreamConstAcc = typename Streams::const_accessor;
+using Streams = StreamTable;
 
 template <class T> using EventHandler = std::function<void(Events<T>)>;
 
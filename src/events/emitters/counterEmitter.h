@@ -33,8 +33,8 @@ public:
         EmitterPtr<T> emitter = std::make_unique<FalseEmitter<T>>());
 
     /**
-     * Increments number of processed events and forwards call to the chained
-     * emitter.
+     * Increments number of processed events by the number of operations
+     * represented by the event and forwards call to the chained emitter.
      * @see Emitter:process(EventPtr<T> event)
      */
     EventPtr<T> process(EventPtr<T> event) override;
@@ -68,7 +68,7 @@ CounterEmitter<T>::CounterEmitter(std::int64_t threshold, EmitterPtr<T> emitter)
 
 template <class T> EventPtr<T> CounterEmitter<T>::process(EventPtr<T> event)
 {
-    ++m_counter;
+    m_counter += event->counter();
     return m_emitter->process(std::move(event));
 }
 
@@ -19,6 +19,7 @@
 #include "router.h"
 #include "streams/asyncStream.h"
 #include "streams/sharedStream.h"
+#include "streams/streamTable.h"
 #include "streams/typedStream.h"
 #include "subscriptions/fileAttrChangedSubscription.h"
 #include "subscriptions/fileLocationChangedSubscription.h"
@@ -26,10 +26,7 @@ Manager::Manager(std::shared_ptr<Context> context)
 
 void Manager::emit(EventPtr<> event)
 {
-    StreamConstAcc streamAcc;
-    if (m_streams.find(streamAcc, event->streamKey())) {
-        streamAcc->second->process(std::move(event));
-    }
+    m_streams.process(std::move(event));
 }
 
 std::int64_t Manager::subscribe(const Subscription &subscription)
@@ -45,18 +42,13 @@ std::int64_t Manager::subscribe(
     LOG_FCALL() << LOG_FARG(subscriptionId)
                 << LOG_FARG(subscription.toString());
 
-    StreamAcc streamAcc;
-    if (m_streams.insert(streamAcc, subscription.streamKey())) {
+    m_streams.add(subscription.streamKey(), [&] {
         LOG_DBG(1) << "Creating stream '" << subscription.streamKey()
                    << "' for subscription " << subscription.toString();
 
-        streamAcc->second = std::make_unique<SharedStream>(
-            subscription.createStream(*this, m_sequencerManager, m_scheduler));
-    }
-    else {
-        streamAcc->second->share();
-    }
-    streamAcc.release();
+        return subscription.createStream(
+            *this, m_sequencerManager, m_scheduler);
+    });
 
     LOG_DBG(1) << "Adding subscription " << subscription.toString()
                << " with ID: '" << subscriptionId << "'";
@@ -114,10 +106,13 @@ void Manager::flush(StreamKey streamKey)
 {
     LOG_FCALL() << LOG_FARG(streamKey);
 
-    StreamConstAcc streamAcc;
-    if (m_streams.find(streamAcc, streamKey)) {
-        streamAcc->second->flush();
-    }
+    m_streams.flush(streamKey);
+}
+
+void Manager::flush(StreamKey streamKey, const AggregationKey &aggregationKey)
+{
+    LOG_FCALL() << LOG_FARG(streamKey) << LOG_FARG(aggregationKey);
+    m_streams.flush(streamKey, aggregationKey);
 }
 
 } // namespace events
@@ -11,6 +11,8 @@
 
 #include "events/declarations.h"
 #include "router.h"
+#include "streams/streamExecutor.h"
+#include "streams/streamTable.h"
 
 #include <atomic>
 #include <string>
@@ -92,12 +94,29 @@ public:
      */
     virtual void flush(StreamKey streamKey);
 
+    /**
+     * Requests handling of events aggregated in the stream under an
+     * aggregation key, leaving other events in the stream intact.
+     * @param streamKey A key that identifies a stream that should be flushed.
+     * @param aggregationKey A key of aggregated events that should be handled.
+     */
+    virtual void flush(
+        StreamKey streamKey, const AggregationKey &aggregationKey);
+
+    /**
+     * @return A @c StreamExecutor instance running asynchronous streams.
+     */
+    StreamExecutor &streamExecutor() { return m_streamExecutor; }
+
 private:
     std::int64_t subscribe(
         std::int64_t subscriptionId, const Subscription &subscription);
 
     std::atomic<std::int64_t> m_nextSubscriptionId{0};
 
+    // Declared before the streams, so that it stops only after they are
+    // destroyed
+    StreamExecutor m_streamExecutor;
     Streams m_streams;
     Scheduler &m_scheduler;
     SequencerManager m_sequencerManager;
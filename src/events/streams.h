@@ -9,6 +9,7 @@
 #ifndef ONECLIENT_EVENTS_STREAMS_H
 #define ONECLIENT_EVENTS_STREAMS_H
 
+#include <cstddef>
 #include <ostream>
 
 namespace one {
@@ -30,6 +31,12 @@ enum class StreamKey {
     TEST
 };
 
+/**
+ * Number of available event streams.
+ */
+constexpr std::size_t STREAM_KEY_COUNT =
+    static_cast<std::size_t>(StreamKey::TEST) + 1;
+
 /**
  * Overloaded operator for printing @c StreamKey name.
  */
@@ -7,45 +7,149 @@
  */
 
 #include "asyncStream.h"
-#include "communication/etls/utils.h"
 #include "events/types/event.h"
 #include "logging.h"
+#include "monitoring/monitoring.h"
+
+#include <asio/io_service_strand.hpp>
+#include <folly/MPMCQueue.h>
+
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <mutex>
 
 namespace one {
 namespace client {
 namespace events {
 
-AsyncStream::AsyncStream(StreamPtr stream)
-    : m_ioService{1}
-    , m_idleWork{asio::make_work_guard(m_ioService)}
-    , m_worker{[=] {
-        communication::etls::utils::nameThread("AsyncStream");
-        m_ioService.run();
-    }}
-    , m_stream{std::move(stream)}
-{
-}
+// Maximum number of events processed by a single drain task, so that a busy
+// stream doesn't occupy a worker thread shared with other streams
+constexpr std::size_t DRAIN_BATCH_SIZE = 256;
+
+struct AsyncStream::State : public std::enable_shared_from_this<State> {
+    State(StreamPtr stream_, StreamExecutor &executor_,
+        const std::size_t queueCapacity)
+        : stream{std::move(stream_)}
+        , executor{executor_}
+        , strand{executor_.ioService()}
+        , queue{queueCapacity}
+    {
+    }
+
+    void push(EventPtr<> event)
+    {
+        if (overflowed || !queue.write(std::move(event))) {
+            std::lock_guard<std::mutex> guard{overflowMutex};
+
+            // The decision is repeated under the lock, as the spilled events
+            // may have been taken by a drain in the meantime. While any
+            // spilled event waits, newer events are spilled after it instead
+            // of overtaking it through the queue.
+            if (!overflow.empty() || !queue.write(std::move(event))) {
+                ONE_METRIC_COUNTER_INC(
+                    "comp.oneclient.mod.events.stream_overflows");
+
+                overflow.emplace_back(std::move(event));
+                overflowed = true;
+            }
+        }
+
+        scheduleDrain();
+    }
+
+    void scheduleDrain()
+    {
+        if (drainScheduled.exchange(true))
+            return;
+
+        executor.post(
+            strand, [state = shared_from_this()] { state->drain(); });
+    }
+
+    template <typename F> void post(F &&f)
+    {
+        executor.post(
+            strand, [ state = shared_from_this(), f = std::forward<F>(f) ] {
+                state->drain(std::numeric_limits<std::size_t>::max());
+                f(*state->stream);
+            });
+    }
+
+    // Runs in the strand
+    void drain(const std::size_t limit = DRAIN_BATCH_SIZE)
+    {
+        // The flag is cleared before reading the queue, so that an event
+        // queued after the queue is found empty schedules another drain
+        drainScheduled = false;
 
-AsyncStream::~AsyncStream()
+        EventPtr<> event;
+        std::size_t processed = 0;
+        while (processed < limit && queue.read(event)) {
+            stream->process(std::move(event));
+            ++processed;
+        }
+
+        if (processed == limit) {
+            scheduleDrain();
+            return;
+        }
+
+        // Events spill over only when the queue is full and while the
+        // spilled events are waiting, so they're newer than all events read
+        // from the queue above
+        if (!overflowed)
+            return;
+
+        std::deque<EventPtr<>> events;
+        {
+            std::lock_guard<std::mutex> guard{overflowMutex};
+            events.swap(overflow);
+            overflowed = false;
+        }
+
+        for (auto &spilled : events)
+            stream->process(std::move(spilled));
+    }
+
+    StreamPtr stream;
+    StreamExecutor &executor;
+    asio::io_service::strand strand;
+
+    folly::MPMCQueue<EventPtr<>> queue;
+    std::atomic<bool> drainScheduled{false};
+
+    std::mutex overflowMutex;
+    std::deque<EventPtr<>> overflow;
+    std::atomic<bool> overflowed{false};
+};
+
+AsyncStream::AsyncStream(StreamPtr stream, StreamExecutor &executor,
+    const std::size_t queueCapacity)
+    : m_state{std::make_shared<State>(
+          std::move(stream), executor, queueCapacity)}
 {
-    m_ioService.stop();
-    m_worker.join();
 }
 
 void AsyncStream::process(EventPtr<> event)
 {
     LOG_FCALL();
 
-    asio::post(m_ioService, [ this, event = std::move(event) ]() mutable {
-        m_stream->process(std::move(event));
-    });
+    m_state->push(std::move(event));
 }
 
 void AsyncStream::flush()
 {
     LOG_FCALL();
 
-    asio::post(m_ioService, [this] { m_stream->flush(); });
+    m_state->post([](Stream &stream) { stream.flush(); });
+}
+
+void AsyncStream::flush(const AggregationKey &key)
+{
+    LOG_FCALL() << LOG_FARG(key);
+
+    m_state->post([key](Stream &stream) { stream.flush(key); });
 }
 
 } // namespace events
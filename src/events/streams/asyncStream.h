@@ -10,55 +10,61 @@
 #define ONECLIENT_EVENTS_STREAMS_ASYNC_STREAM_H
 
 #include "stream.h"
+#include "streamExecutor.h"
 
-#include <asio/io_service.hpp>
-#include <asio/io_service_strand.hpp>
-#include <asio/post.hpp>
-#include <asio/ts/executor.hpp>
-
-#include <thread>
+#include <memory>
 
 namespace one {
 namespace client {
 namespace events {
 
 /**
- * @c AsyncStream is an event stream wrapper that processes events in a single,
- * dedicated thread managed by an IO service. Therefore, synchronization
- * mechanisms are not necessary within the @c AsyncStream.
+ * @c AsyncStream is an event stream wrapper that processes events in a strand
+ * of a @c StreamExecutor shared by all asynchronous streams. The strand
+ * guarantees that events of the stream are processed one at a time and in
+ * order, therefore synchronization mechanisms are not necessary within the
+ * @c AsyncStream. Events are passed to the strand through a bounded
+ * multi-producer queue, so that processing an event doesn't allocate a task;
+ * a task draining the queue is posted only when the queue becomes non-empty.
  */
 class AsyncStream : public Stream {
 public:
     /**
      * Constructor.
      * @param stream A wrapped @c Stream instance.
+     * @param executor A @c StreamExecutor instance running the stream.
+     * @param queueCapacity Number of events which can be queued in the stream
+     * before they spill over to a slower, unbounded queue.
      */
-    AsyncStream(StreamPtr stream);
-
-    /**
-     * Stops IO service and joins worker thread.
-     */
-    ~AsyncStream();
+    AsyncStream(StreamPtr stream, StreamExecutor &executor,
+        const std::size_t queueCapacity = 1024);
 
     /**
-     * Forwards call to a wrapped stream managed by a single, dedicated worker
-     * thread.
+     * Forwards call to a wrapped stream in the stream's strand.
      * @see Stream::process(EventPtr<> event)
      */
     void process(EventPtr<> event) override;
 
     /**
-     * Forwards call to a wrapped stream managed by a single, dedicated worker
-     * thread.
+     * Forwards call to a wrapped stream in the stream's strand, after all
+     * events queued in the stream are processed.
      * @see Stream::flush()
      */
     void flush() override;
 
+    /**
+     * Forwards call to a wrapped stream in the stream's strand, after all
+     * events queued in the stream are processed.
+     * @see Stream::flush(const AggregationKey &key)
+     */
+    void flush(const AggregationKey &key) override;
+
 private:
-    asio::io_service m_ioService;
-    asio::executor_work_guard<asio::io_service::executor_type> m_idleWork;
-    std::thread m_worker;
-    StreamPtr m_stream;
+    struct State;
+
+    // Shared with queued tasks, which may still run after the
+    // @c AsyncStream is destroyed
+    std::shared_ptr<State> m_state;
 };
 
 } // namespace events
@@ -32,6 +32,12 @@ void SharedStream::flush()
     m_stream->flush();
 }
 
+void SharedStream::flush(const AggregationKey &key)
+{
+    LOG_FCALL() << LOG_FARG(key);
+    m_stream->flush(key);
+}
+
 void SharedStream::share() { ++m_counter; }
 
 bool SharedStream::release()
@@ -40,6 +40,12 @@ public:
      */
     void flush() override;
 
+    /**
+     * Forwards call to a wrapped stream.
+     * @see Stream::flush(const AggregationKey &key)
+     */
+    void flush(const AggregationKey &key) override;
+
     /**
      * Increments subscriptions reference count.
      */
@@ -33,6 +33,13 @@ public:
      * Requests handling of events aggregated in the stream.
      */
     virtual void flush() = 0;
+
+    /**
+     * Requests handling of events aggregated in the stream under an
+     * aggregation key.
+     * @param key The aggregation key of events to handle.
+     */
+    virtual void flush(const AggregationKey &key) = 0;
 };
 
 } // namespace events
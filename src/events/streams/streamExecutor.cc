@@ -0,0 +1,124 @@
+/**
+ * @file streamExecutor.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "streamExecutor.h"
+#include "communication/etls/utils.h"
+#include "logging.h"
+#include "monitoring/monitoring.h"
+
+#include <algorithm>
+
+namespace one {
+namespace client {
+namespace events {
+
+// Number of queued tasks per worker thread above which another worker is
+// started; each stream with pending events has at most one task draining
+// them queued, so this is the number of streams waiting for a worker
+constexpr std::size_t QUEUED_TASKS_PER_THREAD = 1;
+
+StreamExecutor::StreamExecutor(
+    const std::size_t maxThreadCount, const std::chrono::seconds idleTimeout)
+    : m_maxThreadCount{std::max<std::size_t>(maxThreadCount, 1)}
+    , m_idleTimeout{idleTimeout}
+{
+    std::lock_guard<std::mutex> guard{m_workersMutex};
+    spawn();
+}
+
+StreamExecutor::~StreamExecutor()
+{
+    m_ioService.stop();
+
+    // Workers are joined without holding the lock, which stopping workers
+    // may be waiting for
+    decltype(m_workers) workers;
+    decltype(m_retiredWorkers) retiredWorkers;
+    {
+        std::lock_guard<std::mutex> guard{m_workersMutex};
+        workers.swap(m_workers);
+        retiredWorkers.swap(m_retiredWorkers);
+    }
+
+    for (auto &worker : workers)
+        worker.second.join();
+    for (auto &worker : retiredWorkers)
+        worker.join();
+}
+
+void StreamExecutor::growIfBusy(const std::size_t queued)
+{
+    if (queued <= m_threadCount * QUEUED_TASKS_PER_THREAD ||
+        m_threadCount >= m_maxThreadCount)
+        return;
+
+    std::lock_guard<std::mutex> guard{m_workersMutex};
+    if (m_ioService.stopped() || m_workers.size() >= m_maxThreadCount ||
+        m_queued <= m_workers.size() * QUEUED_TASKS_PER_THREAD)
+        return;
+
+    LOG_DBG(2) << "Starting event stream worker for " << queued
+               << " queued tasks";
+
+    spawn();
+}
+
+void StreamExecutor::spawn()
+{
+    for (auto &worker : m_retiredWorkers)
+        worker.join();
+    m_retiredWorkers.clear();
+
+    std::thread worker{[this] {
+        communication::etls::utils::nameThread("AsyncStream");
+        work();
+    }};
+    const auto id = worker.get_id();
+    m_workers.emplace(id, std::move(worker));
+
+    m_threadCount = m_workers.size();
+    ONE_METRIC_COUNTER_SET(
+        "comp.oneclient.mod.events.stream_executor.threads", m_threadCount);
+}
+
+void StreamExecutor::work()
+{
+    while (!m_ioService.stopped()) {
+        if (m_ioService.run_one_for(m_idleTimeout) > 0)
+            continue;
+
+        if (!m_ioService.stopped() && retire())
+            return;
+    }
+}
+
+bool StreamExecutor::retire()
+{
+    std::lock_guard<std::mutex> guard{m_workersMutex};
+    if (m_ioService.stopped() || m_workers.size() <= 1)
+        return false;
+
+    auto it = m_workers.find(std::this_thread::get_id());
+    if (it == m_workers.end())
+        return false;
+
+    m_retiredWorkers.emplace_back(std::move(it->second));
+    m_workers.erase(it);
+
+    m_threadCount = m_workers.size();
+    ONE_METRIC_COUNTER_SET(
+        "comp.oneclient.mod.events.stream_executor.threads", m_threadCount);
+
+    LOG_DBG(2) << "Stopped idle event stream worker";
+
+    return true;
+}
+
+} // namespace events
+} // namespace client
+} // namespace one
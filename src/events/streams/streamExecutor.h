@@ -0,0 +1,102 @@
+/**
+ * @file streamExecutor.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_EVENTS_STREAMS_STREAM_EXECUTOR_H
+#define ONECLIENT_EVENTS_STREAMS_STREAM_EXECUTOR_H
+
+#include <asio/io_service.hpp>
+#include <asio/post.hpp>
+#include <asio/ts/executor.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace one {
+namespace client {
+namespace events {
+
+/**
+ * @c StreamExecutor is a pool of worker threads shared by all asynchronous
+ * event streams. The pool starts with a single worker and grows, up to
+ * a maximum number of workers, when more tasks are queued than there are
+ * workers to run them. Workers which stay idle for longer than the idle
+ * timeout are stopped, down to a single worker.
+ */
+class StreamExecutor {
+public:
+    /**
+     * Constructor.
+     * Starts the first worker thread.
+     * @param maxThreadCount Maximum number of worker threads.
+     * @param idleTimeout Time after which an idle worker thread is stopped.
+     */
+    StreamExecutor(const std::size_t maxThreadCount = 4,
+        const std::chrono::seconds idleTimeout = std::chrono::seconds{30});
+
+    /**
+     * Destructor.
+     * Stops the IO service and joins worker threads.
+     */
+    ~StreamExecutor();
+
+    /**
+     * @returns IO service running on the worker threads.
+     */
+    asio::io_service &ioService() { return m_ioService; }
+
+    /**
+     * Posts a task to the pool through an executor, e.g. a strand of the
+     * pool's IO service.
+     * @param executor Executor through which the task is posted.
+     * @param task Task to run.
+     */
+    template <typename Executor, typename Task>
+    void post(Executor &executor, Task &&task);
+
+private:
+    void growIfBusy(const std::size_t queued);
+    void spawn();
+    void work();
+    bool retire();
+
+    const std::size_t m_maxThreadCount;
+    const std::chrono::seconds m_idleTimeout;
+
+    asio::io_service m_ioService;
+    asio::executor_work_guard<asio::io_service::executor_type> m_idleWork{
+        asio::make_work_guard(m_ioService)};
+
+    std::atomic<std::size_t> m_queued{0};
+    std::atomic<std::size_t> m_threadCount{0};
+
+    std::mutex m_workersMutex;
+    std::unordered_map<std::thread::id, std::thread> m_workers;
+    // Stopped workers, which can't join themselves
+    std::vector<std::thread> m_retiredWorkers;
+};
+
+template <typename Executor, typename Task>
+void StreamExecutor::post(Executor &executor, Task &&task)
+{
+    growIfBusy(++m_queued);
+
+    asio::post(executor, [ this, task = std::forward<Task>(task) ]() mutable {
+        --m_queued;
+        task();
+    });
+}
+
+} // namespace events
+} // namespace client
+} // namespace one
+
+#endif // ONECLIENT_EVENTS_STREAMS_STREAM_EXECUTOR_H
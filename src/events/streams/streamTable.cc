@@ -0,0 +1,79 @@
+/**
+ * @file streamTable.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "streamTable.h"
+#include "events/types/event.h"
+#include "logging.h"
+
+#include <thread>
+
+namespace one {
+namespace client {
+namespace events {
+
+StreamTable::~StreamTable()
+{
+    for (auto &slot : m_slots)
+        delete slot.stream.exchange(nullptr);
+}
+
+bool StreamTable::add(
+    StreamKey streamKey, const std::function<StreamPtr()> &createStream)
+{
+    auto &slot = m_slots[static_cast<std::size_t>(streamKey)];
+
+    std::lock_guard<std::mutex> guard{m_mutex};
+    if (auto stream = slot.stream.load()) {
+        stream->share();
+        return false;
+    }
+
+    slot.stream = new SharedStream{createStream()};
+    return true;
+}
+
+bool StreamTable::remove(StreamKey streamKey)
+{
+    auto &slot = m_slots[static_cast<std::size_t>(streamKey)];
+
+    std::unique_lock<std::mutex> guard{m_mutex};
+    auto stream = slot.stream.load();
+    if (stream == nullptr || !stream->release())
+        return false;
+
+    slot.stream = nullptr;
+    guard.unlock();
+
+    while (slot.users > 0)
+        std::this_thread::yield();
+
+    delete stream;
+    return true;
+}
+
+void StreamTable::process(EventPtr<> event)
+{
+    use(event->streamKey(),
+        [&](SharedStream &stream) { stream.process(std::move(event)); });
+}
+
+void StreamTable::flush(StreamKey streamKey)
+{
+    use(streamKey, [](SharedStream &stream) { stream.flush(); });
+}
+
+void StreamTable::flush(
+    StreamKey streamKey, const AggregationKey &aggregationKey)
+{
+    use(streamKey,
+        [&](SharedStream &stream) { stream.flush(aggregationKey); });
+}
+
+} // namespace events
+} // namespace client
+} // namespace one
@@ -0,0 +1,106 @@
+/**
+ * @file streamTable.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_EVENTS_STREAMS_STREAM_TABLE_H
+#define ONECLIENT_EVENTS_STREAMS_STREAM_TABLE_H
+
+#include "sharedStream.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace one {
+namespace client {
+namespace events {
+
+/**
+ * @c StreamTable holds existing event streams in a fixed array indexed by
+ * @c StreamKey. Looking up a stream to process an event or to flush it doesn't
+ * take any locks; adding and removing streams, which happens only on
+ * subscription and its cancellation, is serialized by a mutex.
+ */
+class StreamTable {
+public:
+    /**
+     * Destructor.
+     * Removes remaining streams.
+     */
+    ~StreamTable();
+
+    /**
+     * Creates a stream under a key if not present, otherwise increments its
+     * subscriptions reference count.
+     * @param streamKey A key of the stream.
+     * @param createStream A function creating the stream.
+     * @return True if the stream has been created, otherwise false.
+     */
+    bool add(
+        StreamKey streamKey, const std::function<StreamPtr()> &createStream);
+
+    /**
+     * Decrements subscriptions reference count of a stream under a key and
+     * removes the stream when it goes to zero. Waits for calls which are
+     * still using the removed stream to return.
+     * @param streamKey A key of the stream.
+     * @return True if the stream has been removed, otherwise false.
+     */
+    bool remove(StreamKey streamKey);
+
+    /**
+     * Forwards event to the associated event stream if present.
+     * @param event An event to be forwarded.
+     */
+    void process(EventPtr<> event);
+
+    /**
+     * Requests handling of events aggregated in the stream if present.
+     * @param streamKey A key that identifies a stream that should be flushed.
+     */
+    void flush(StreamKey streamKey);
+
+    /**
+     * Requests handling of events aggregated in the stream under an
+     * aggregation key if the stream is present.
+     * @param streamKey A key that identifies a stream that should be flushed.
+     * @param aggregationKey A key of aggregated events that should be handled.
+     */
+    void flush(StreamKey streamKey, const AggregationKey &aggregationKey);
+
+private:
+    struct Slot {
+        std::atomic<SharedStream *> stream{nullptr};
+        // Number of calls currently using the stream
+        std::atomic<std::size_t> users{0};
+    };
+
+    template <typename F> void use(StreamKey streamKey, F &&f);
+
+    std::array<Slot, STREAM_KEY_COUNT> m_slots;
+    std::mutex m_mutex;
+};
+
+template <typename F> void StreamTable::use(StreamKey streamKey, F &&f)
+{
+    auto &slot = m_slots[static_cast<std::size_t>(streamKey)];
+
+    // The users count is incremented before the stream is loaded, so that
+    // remove(), which clears the slot before checking the count, waits for
+    // this call to finish using the stream
+    ++slot.users;
+    if (auto stream = slot.stream.load())
+        f(*stream);
+    --slot.users;
+}
+
+} // namespace events
+} // namespace client
+} // namespace one
+
+#endif // ONECLIENT_EVENTS_STREAMS_STREAM_TABLE_H
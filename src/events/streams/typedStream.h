@@ -52,6 +52,12 @@ public:
      */
     void flush() override;
 
+    /**
+     * Calls a handler on events aggregated under the aggregation key. The
+     * emitter is not reset, as other events remain aggregated in the stream.
+     */
+    void flush(const AggregationKey &key) override;
+
 private:
     AggregatorPtr<T> m_aggregator;
     EmitterPtr<T> m_emitter;
@@ -93,6 +99,13 @@ template <class T> void TypedStream<T>::flush()
     m_emitter->reset();
 }
 
+template <class T> void TypedStream<T>::flush(const AggregationKey &key)
+{
+    auto events = m_aggregator->flush(key);
+    if (!events.empty())
+        m_handler->process(std::move(events));
+}
+
 } // namespace events
 } // namespace client
 } // namespace one
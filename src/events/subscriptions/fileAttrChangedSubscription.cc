@@ -40,7 +40,8 @@ StreamPtr FileAttrChangedSubscription::createStream(
 
     return std::make_unique<AsyncStream>(
         std::make_unique<TypedStream<FileAttrChanged>>(
-            std::move(aggregator), std::move(emitter), std::move(handler)));
+            std::move(aggregator), std::move(emitter), std::move(handler)),
+        manager.streamExecutor());
 }
 
 std::string FileAttrChangedSubscription::toString() const
@@ -40,7 +40,8 @@ StreamPtr FileLocationChangedSubscription::createStream(
 
     return std::make_unique<AsyncStream>(
         std::make_unique<TypedStream<FileLocationChanged>>(
-            std::move(aggregator), std::move(emitter), std::move(handler)));
+            std::move(aggregator), std::move(emitter), std::move(handler)),
+        manager.streamExecutor());
 }
 
 std::string FileLocationChangedSubscription::toString() const
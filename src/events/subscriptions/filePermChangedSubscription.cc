@@ -36,7 +36,8 @@ StreamPtr FilePermChangedSubscription::createStream(
 
     return std::make_unique<AsyncStream>(
         std::make_unique<TypedStream<FilePermChanged>>(
-            std::move(aggregator), std::move(emitter), std::move(handler)));
+            std::move(aggregator), std::move(emitter), std::move(handler)),
+        manager.streamExecutor());
 }
 
 std::string FilePermChangedSubscription::toString() const
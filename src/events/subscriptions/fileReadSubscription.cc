@@ -50,7 +50,8 @@ StreamPtr FileReadSubscription::createStream(
 
     return std::make_unique<AsyncStream>(
         std::make_unique<TypedStream<FileRead>>(
-            std::move(aggregator), std::move(emitter), std::move(handler)));
+            std::move(aggregator), std::move(emitter), std::move(handler)),
+        manager.streamExecutor());
 }
 
 std::string FileReadSubscription::toString() const
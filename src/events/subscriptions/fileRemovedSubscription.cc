@@ -36,7 +36,8 @@ StreamPtr FileRemovedSubscription::createStream(
 
     return std::make_unique<AsyncStream>(
         std::make_unique<TypedStream<FileRemoved>>(
-            std::move(aggregator), std::move(emitter), std::move(handler)));
+            std::move(aggregator), std::move(emitter), std::move(handler)),
+        manager.streamExecutor());
 }
 
 std::string FileRemovedSubscription::toString() const
@@ -35,7 +35,8 @@ StreamPtr QuotaExceededSubscription::createStream(
 
     return std::make_unique<AsyncStream>(
         std::make_unique<TypedStream<QuotaExceeded>>(
-            std::move(aggregator), std::move(emitter), std::move(handler)));
+            std::move(aggregator), std::move(emitter), std::move(handler)),
+        manager.streamExecutor());
 }
 
 std::string QuotaExceededSubscription::toString() const
@@ -7,7 +7,7 @@
  */
 
 #include "subscriptionHandle.h"
-#include "events/streams/sharedStream.h"
+#include "events/streams/streamTable.h"
 #include "logging.h"
 
 namespace one {
@@ -22,13 +22,8 @@ SubscriptionHandle::SubscriptionHandle(StreamKey streamKey, Streams &streams)
 
 SubscriptionHandle::~SubscriptionHandle()
 {
-    StreamAcc acc;
-    if (m_streams.find(acc, m_streamKey)) {
-        if (acc->second->release()) {
-            LOG_DBG(1) << "Removing stream '" << m_streamKey << "'";
-            m_streams.erase(acc);
-        }
-    }
+    if (m_streams.remove(m_streamKey))
+        LOG_DBG(1) << "Removed stream '" << m_streamKey << "'";
 }
 
 } // namespace events
@@ -40,6 +40,12 @@ public:
      * @return An event description.
      */
     virtual std::string toString() const = 0;
+
+    /**
+     * @return Number of operations represented by this event, which is
+     * greater than one for events aggregated before being emitted.
+     */
+    virtual std::size_t counter() const { return 1; }
 };
 
 } // namespace events
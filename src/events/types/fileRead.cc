@@ -27,6 +27,15 @@ FileRead::FileRead(std::string fileUuid, off_t offset, size_t size,
 {
 }
 
+FileRead::FileRead(std::string fileUuid, std::size_t counter, std::size_t size,
+    FileBlocksMap blocks)
+    : m_counter{counter}
+    , m_fileUuid{std::move(fileUuid)}
+    , m_size{size}
+    , m_blocks{std::move(blocks)}
+{
+}
+
 StreamKey FileRead::streamKey() const { return StreamKey::FILE_READ; }
 
 const AggregationKey &FileRead::aggregationKey() const { return m_fileUuid; }
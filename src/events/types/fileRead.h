@@ -23,10 +23,11 @@ namespace events {
  */
 class FileRead : public RemoteEvent {
     using FileBlock = one::messages::fuse::FileBlock;
+
+public:
     using FileBlocksMap = boost::icl::interval_map<off_t, FileBlock,
         boost::icl::partial_enricher>;
 
-public:
     /**
      * Constructor.
      * @param fileUuid UUID of a file associated with the read operation.
@@ -40,6 +41,17 @@ public:
     FileRead(std::string fileUuid, off_t offset, std::size_t size,
         std::string storageId = {}, std::string fileId = {});
 
+    /**
+     * Constructor of an event representing a number of read operations
+     * aggregated before emission.
+     * @param fileUuid UUID of a file associated with the read operations.
+     * @param counter Number of read operations.
+     * @param size Number of bytes read.
+     * @param blocks Blocks read.
+     */
+    FileRead(std::string fileUuid, std::size_t counter, std::size_t size,
+        FileBlocksMap blocks);
+
     StreamKey streamKey() const override;
 
     /**
@@ -51,6 +63,8 @@ public:
 
     std::string toString() const override;
 
+    std::size_t counter() const override { return m_counter; }
+
     /**
      * Aggregates @c *this event with the other event. Aggregation is done by
      * addition of events' counters and sizes and union of read blocks.
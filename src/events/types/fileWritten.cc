@@ -30,6 +30,15 @@ FileWritten::FileWritten(std::string fileUuid, off_t offset, size_t size,
 {
 }
 
+FileWritten::FileWritten(std::string fileUuid, std::size_t counter,
+    std::size_t size, FileBlocksMap blocks)
+    : m_counter{counter}
+    , m_fileUuid{std::move(fileUuid)}
+    , m_size{size}
+    , m_blocks{std::move(blocks)}
+{
+}
+
 StreamKey FileWritten::streamKey() const { return StreamKey::FILE_WRITTEN; }
 
 const AggregationKey &FileWritten::aggregationKey() const { return m_fileUuid; }
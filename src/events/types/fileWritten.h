@@ -24,10 +24,11 @@ namespace events {
  */
 class FileWritten : public RemoteEvent {
     using FileBlock = one::messages::fuse::FileBlock;
+
+public:
     using FileBlocksMap = boost::icl::interval_map<off_t, FileBlock,
         boost::icl::partial_enricher>;
 
-public:
     /**
      * Constructor.
      * @param fileUuid UUID of a file associated with the write operation.
@@ -43,6 +44,17 @@ public:
         std::string storageId = {}, std::string fileId = {},
         boost::optional<off_t> fileSize = {});
 
+    /**
+     * Constructor of an event representing a number of write operations
+     * aggregated before emission.
+     * @param fileUuid UUID of a file associated with the write operations.
+     * @param counter Number of write operations.
+     * @param size Number of bytes written.
+     * @param blocks Blocks written.
+     */
+    FileWritten(std::string fileUuid, std::size_t counter, std::size_t size,
+        FileBlocksMap blocks);
+
     StreamKey streamKey() const override;
 
     /**
@@ -54,6 +66,8 @@ public:
 
     std::string toString() const override;
 
+    std::size_t counter() const override { return m_counter; }
+
     /**
      * Aggregates @c *this event with the other event. Aggregation is done by
      * addition of events' counters and sizes, union of written blocks and
@@ -0,0 +1,135 @@
+/**
+ * @file updateQueue.h
+ * @author Krzysztof Trzepla
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_EVENTS_UPDATE_QUEUE_H
+#define ONECLIENT_EVENTS_UPDATE_QUEUE_H
+
+#include "events/declarations.h"
+#include "logging.h"
+#include "monitoring/monitoring.h"
+
+#include <folly/Function.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace one {
+namespace client {
+namespace events {
+
+/**
+ * @c UpdateQueue collects remote events which are applied to the local state
+ * inside the main fiber. Events with the same aggregation key are aggregated
+ * while waiting, so that only their latest version is applied. Waiting events
+ * are applied in the order in which their aggregation keys were first queued,
+ * by fiber tasks applying at most a fixed number of events each.
+ */
+template <class T> class UpdateQueue {
+public:
+    /**
+     * Constructor.
+     * @param runInFiber A function that runs callback inside a main fiber.
+     * @param apply A function applying a single event.
+     * @param budget Maximum number of events applied by a single fiber task;
+     * remaining events are applied by another task queued after fiber tasks
+     * which were waiting meanwhile.
+     */
+    UpdateQueue(std::function<void(folly::Function<void()>)> runInFiber,
+        std::function<void(const T &)> apply, std::size_t budget);
+
+    /**
+     * Queues events and schedules their application, unless it's already
+     * scheduled.
+     * @param events Events to apply.
+     */
+    void push(Events<T> events);
+
+private:
+    void scheduleApply();
+
+    std::function<void(folly::Function<void()>)> m_runInFiber;
+    std::function<void(const T &)> m_apply;
+    const std::size_t m_budget;
+
+    std::mutex m_mutex;
+    std::unordered_map<AggregationKey, EventPtr<T>> m_events;
+    std::deque<AggregationKey> m_order;
+    bool m_applyScheduled = false;
+};
+
+template <class T>
+UpdateQueue<T>::UpdateQueue(
+    std::function<void(folly::Function<void()>)> runInFiber,
+    std::function<void(const T &)> apply, std::size_t budget)
+    : m_runInFiber{std::move(runInFiber)}
+    , m_apply{std::move(apply)}
+    , m_budget{budget}
+{
+}
+
+template <class T> void UpdateQueue<T>::push(Events<T> events)
+{
+    LOG_FCALL() << LOG_FARG(events.size());
+
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        for (auto &event : events) {
+            auto it = m_events.find(event->aggregationKey());
+            if (it != m_events.end()) {
+                ONE_METRIC_COUNTER_INC(
+                    "comp.oneclient.mod.events.submod.received.coalesced");
+                it->second->aggregate(std::move(event));
+            }
+            else {
+                auto key = event->aggregationKey();
+                m_order.emplace_back(key);
+                m_events.emplace(std::move(key), std::move(event));
+            }
+        }
+
+        if (m_applyScheduled)
+            return;
+
+        m_applyScheduled = true;
+    }
+
+    scheduleApply();
+}
+
+template <class T> void UpdateQueue<T>::scheduleApply()
+{
+    m_runInFiber([this] {
+        Events<T> events;
+        bool remaining = false;
+        {
+            std::lock_guard<std::mutex> guard{m_mutex};
+            while (!m_order.empty() && events.size() < m_budget) {
+                auto it = m_events.find(m_order.front());
+                events.emplace_back(std::move(it->second));
+                m_events.erase(it);
+                m_order.pop_front();
+            }
+            remaining = !m_order.empty();
+            m_applyScheduled = remaining;
+        }
+
+        for (const auto &event : events)
+            m_apply(*event);
+
+        if (remaining)
+            scheduleApply();
+    });
+}
+
+} // namespace events
+} // namespace client
+} // namespace one
+
+#endif // ONECLIENT_EVENTS_UPDATE_QUEUE_H
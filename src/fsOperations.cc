@@ -213,8 +213,12 @@ void wrap_open(fuse_req_t req, fuse_ino_t ino, struct fuse_file_info *fi)
         [ req, ino, fi = *fi, timer = std::move(timer) ](
             const std::uint64_t fh) mutable {
             const auto userdata = fuse_req_userdata(req);
+            auto &fsLogic =
+                *static_cast<std::unique_ptr<fslogic::Composite> *>(userdata);
             fi.fh = fh;
-            fi.direct_io = 1;
+            // Direct I/O bypasses the kernel page cache, so it can be only
+            // disabled when prefetched data is pushed into the page cache
+            fi.direct_io = fsLogic->isPageCacheEnabled() ? 0 : 1;
             if (fuse_reply_open(req, &fi))
                 callFslogic(&fslogic::Composite::release, userdata, ino, fh);
         },
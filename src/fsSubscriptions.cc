@@ -21,17 +21,42 @@
 namespace one {
 namespace client {
 
+// Maximum number of coalesced remote events applied to the cache by a single
+// fiber task, so that a burst of updates doesn't hold up other fiber tasks
+constexpr std::size_t CACHE_UPDATES_BUDGET = 256;
+
 FsSubscriptions::FsSubscriptions(events::Manager &eventManager,
     cache::LRUMetadataCache &metadataCache,
     cache::ForceProxyIOCache &forceProxyIOCache,
-    std::function<void(folly::Function<void()>)> runInFiber)
+    std::function<void(folly::Function<void()>)> runInFiber,
+    Scheduler &scheduler, std::chrono::milliseconds batchDelay)
     : m_eventManager{eventManager}
     , m_metadataCache{metadataCache}
     , m_forceProxyIOCache{forceProxyIOCache}
     , m_runInFiber{std::move(runInFiber)}
+    , m_scheduler{scheduler}
+    , m_batchDelay{batchDelay}
+    , m_cancelApplyPending{[] {}}
+    , m_pendingAttrUpdates{m_runInFiber,
+          [this](const auto &event) { applyFileAttrChanged(event); },
+          CACHE_UPDATES_BUDGET}
+    , m_pendingLocationUpdates{m_runInFiber,
+          [this](const auto &event) { applyFileLocationChanged(event); },
+          CACHE_UPDATES_BUDGET}
 {
 }
 
+FsSubscriptions::~FsSubscriptions()
+{
+    {
+        std::lock_guard<std::mutex> guard{m_lifetime->mutex};
+        m_lifetime->alive = false;
+    }
+
+    std::lock_guard<std::mutex> guard{m_pendingMutex};
+    m_cancelApplyPending();
+}
+
 void FsSubscriptions::subscribeFileAttrChanged(const folly::fbstring &fileUuid)
 {
     LOG_FCALL() << LOG_FARG(fileUuid);
@@ -55,17 +80,23 @@ void FsSubscriptions::handleFileAttrChanged(
 
     ONE_METRIC_COUNTER_INC(
         "comp.oneclient.mod.events.submod.received.file_attr_changed");
-    m_runInFiber([ this, events = std::move(events) ] {
-        for (auto &event : events) {
-            auto &attr = event->fileAttr();
-            if (m_metadataCache.updateAttr(attr))
-                LOG_DBG(1) << "Updated attributes for uuid: '" << attr.uuid()
-                           << "', size: " << (attr.size() ? *attr.size() : -1);
-            else
-                LOG_DBG(1) << "No attributes to update for uuid: '"
-                           << attr.uuid() << "'";
-        }
-    });
+    m_pendingAttrUpdates.push(std::move(events));
+}
+
+void FsSubscriptions::applyFileAttrChanged(
+    const events::FileAttrChanged &event)
+{
+    auto &attr = event.fileAttr();
+    m_onAccessChange(attr.uuid());
+
+    if (m_metadataCache.updateAttr(attr)) {
+        LOG_DBG(1) << "Updated attributes for uuid: '" << attr.uuid()
+                   << "', size: " << (attr.size() ? *attr.size() : -1);
+        m_onRemoteUpdate(attr.uuid());
+    }
+    else
+        LOG_DBG(1) << "No attributes to update for uuid: '" << attr.uuid()
+                   << "'";
 }
 
 bool FsSubscriptions::unsubscribeFileAttrChanged(
@@ -101,17 +132,20 @@ void FsSubscriptions::handleFileLocationChanged(
 
     ONE_METRIC_COUNTER_INC(
         "comp.oneclient.mod.events.submod.received.file_location_changed");
-    m_runInFiber([ this, events = std::move(events) ] {
-        for (auto &event : events) {
-            auto &loc = event->fileLocation();
-            if (m_metadataCache.updateLocation(loc))
-                LOG_DBG(1) << "Updated locations for uuid: '" << loc.uuid()
-                           << "'";
-            else
-                LOG_DBG(1) << "No location to update for uuid: '" << loc.uuid()
-                           << "'";
-        }
-    });
+    m_pendingLocationUpdates.push(std::move(events));
+}
+
+void FsSubscriptions::applyFileLocationChanged(
+    const events::FileLocationChanged &event)
+{
+    auto &loc = event.fileLocation();
+    if (m_metadataCache.updateLocation(loc)) {
+        LOG_DBG(1) << "Updated locations for uuid: '" << loc.uuid() << "'";
+        m_onRemoteUpdate(loc.uuid());
+    }
+    else
+        LOG_DBG(1) << "No location to update for uuid: '" << loc.uuid()
+                   << "'";
 }
 
 bool FsSubscriptions::unsubscribeFileLocationChanged(
@@ -147,6 +181,7 @@ void FsSubscriptions::handlePermissionChanged(
     m_runInFiber([ this, events = std::move(events) ] {
         for (auto &event : events) {
             m_forceProxyIOCache.remove(event->fileUuid());
+            m_onAccessChange(event->fileUuid());
         }
     });
 }
@@ -249,26 +284,119 @@ bool FsSubscriptions::unsubscribeFileRenamed(const folly::fbstring &fileUuid)
     return unsubscribe(events::StreamKey::FILE_RENAMED, fileUuid);
 }
 
+template <typename Subscription>
 void FsSubscriptions::subscribe(
-    const folly::fbstring &fileUuid, const events::Subscription &subscription)
+    const folly::fbstring &fileUuid, Subscription subscription)
 {
-    SubscriptionAcc subscriptionAcc;
-    if (m_subscriptions.insert(
-            subscriptionAcc, {subscription.streamKey(), fileUuid})) {
-        subscriptionAcc->second = m_eventManager.subscribe(subscription);
+    const Key key{subscription.streamKey(), fileUuid};
+
+    if (m_batchDelay.count() == 0) {
+        SubscriptionAcc subscriptionAcc;
+        if (m_subscriptions.insert(subscriptionAcc, key)) {
+            subscriptionAcc->second = m_eventManager.subscribe(subscription);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard{m_pendingMutex};
+    if (m_pendingCancellations.erase(key) > 0) {
+        ONE_METRIC_COUNTER_INC(
+            "comp.oneclient.mod.events.submod.subscriptions.cancelled_out");
+        return;
     }
+
+    SubscriptionAcc subscriptionAcc;
+    if (m_subscriptions.find(subscriptionAcc, key))
+        return;
+
+    m_pendingSubscriptions.emplace(
+        key, [ this, subscription = std::move(subscription) ] {
+            return m_eventManager.subscribe(subscription);
+        });
+    scheduleApplyPending();
 }
 
 bool FsSubscriptions::unsubscribe(
     events::StreamKey streamKey, const folly::fbstring &fileUuid)
 {
-    SubscriptionAcc subscriptionAcc;
-    if (m_subscriptions.find(subscriptionAcc, {streamKey, fileUuid})) {
-        m_eventManager.unsubscribe(subscriptionAcc->second);
-        m_subscriptions.erase(subscriptionAcc);
+    const Key key{streamKey, fileUuid};
+
+    if (m_batchDelay.count() == 0) {
+        SubscriptionAcc subscriptionAcc;
+        if (m_subscriptions.find(subscriptionAcc, key)) {
+            m_eventManager.unsubscribe(subscriptionAcc->second);
+            m_subscriptions.erase(subscriptionAcc);
+            return true;
+        }
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard{m_pendingMutex};
+    if (m_pendingSubscriptions.erase(key) > 0) {
+        ONE_METRIC_COUNTER_INC(
+            "comp.oneclient.mod.events.submod.subscriptions.cancelled_out");
         return true;
     }
-    return false;
+
+    SubscriptionAcc subscriptionAcc;
+    if (!m_subscriptions.find(subscriptionAcc, key) ||
+        !m_pendingCancellations.emplace(key).second)
+        return false;
+
+    scheduleApplyPending();
+    return true;
+}
+
+void FsSubscriptions::scheduleApplyPending()
+{
+    // Called with the pending changes lock held; a single application is
+    // scheduled for all changes made within the batch delay
+    if (m_applyPendingScheduled)
+        return;
+
+    m_applyPendingScheduled = true;
+    m_cancelApplyPending = m_scheduler.schedule(m_batchDelay,
+        [ this, runInFiber = m_runInFiber, lifetime = m_lifetime ] {
+            runInFiber([this, lifetime] {
+                // Holding the lifetime lock makes the destructor wait until
+                // the changes are applied
+                std::lock_guard<std::mutex> guard{lifetime->mutex};
+                if (lifetime->alive)
+                    applyPending();
+            });
+        });
+}
+
+void FsSubscriptions::applyPending()
+{
+    LOG_FCALL();
+
+    // The lock is held while the changes are applied, so that a change made
+    // meanwhile isn't checked against subscriptions about to be changed
+    std::lock_guard<std::mutex> guard{m_pendingMutex};
+
+    LOG_DBG(1) << "Applying " << m_pendingSubscriptions.size()
+               << " subscriptions and " << m_pendingCancellations.size()
+               << " subscription cancellations";
+
+    for (const auto &key : m_pendingCancellations) {
+        SubscriptionAcc subscriptionAcc;
+        if (m_subscriptions.find(subscriptionAcc, key)) {
+            m_eventManager.unsubscribe(subscriptionAcc->second);
+            m_subscriptions.erase(subscriptionAcc);
+        }
+    }
+
+    for (auto &subscription : m_pendingSubscriptions) {
+        SubscriptionAcc subscriptionAcc;
+        if (m_subscriptions.insert(subscriptionAcc, subscription.first))
+            subscriptionAcc->second = subscription.second();
+    }
+
+    m_pendingCancellations.clear();
+    m_pendingSubscriptions.clear();
+    m_cancelApplyPending = [] {};
+    m_applyPendingScheduled = false;
 }
 
 } // namespace client
@@ -0,0 +1,89 @@
+/**
+ * @file directIOReprober.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "directIOReprober.h"
+
+#include "logging.h"
+
+#include <algorithm>
+
+namespace one {
+namespace client {
+namespace fslogic {
+
+constexpr std::chrono::seconds DirectIOReprober::MAX_DELAY;
+
+DirectIOReprober::DirectIOReprober(const std::chrono::seconds delay,
+    Schedule schedule,
+    std::function<void(folly::Function<void()>)> runInFiber,
+    std::function<bool(const folly::fbstring &, const int)> probe,
+    std::function<void(const folly::fbstring &)> lift)
+    : m_delay{delay}
+    , m_schedule{std::move(schedule)}
+    , m_runInFiber{std::move(runInFiber)}
+    , m_probe{std::move(probe)}
+    , m_lift{std::move(lift)}
+{
+}
+
+DirectIOReprober::~DirectIOReprober()
+{
+    for (auto &reprobe : m_reprobes)
+        reprobe.second();
+}
+
+void DirectIOReprober::start(const folly::fbstring &uuid, const int flags)
+{
+    if (m_delay.count() > 0 && !scheduled(uuid))
+        schedule(uuid, flags, m_delay);
+}
+
+void DirectIOReprober::cancel(const folly::fbstring &uuid)
+{
+    auto it = m_reprobes.find(uuid);
+    if (it == m_reprobes.end())
+        return;
+
+    it->second();
+    m_reprobes.erase(it);
+}
+
+void DirectIOReprober::schedule(const folly::fbstring &uuid, const int flags,
+    const std::chrono::seconds delay)
+{
+    LOG_DBG(1) << "Retrying direct IO for file " << uuid << " in "
+               << delay.count() << "s";
+
+    m_reprobes[uuid] = m_schedule(delay, [this, uuid, flags, delay] {
+        m_runInFiber([this, uuid, flags, delay] {
+            if (m_reprobes.erase(uuid))
+                reprobe(uuid, flags, delay);
+        });
+    });
+}
+
+void DirectIOReprober::reprobe(const folly::fbstring &uuid, const int flags,
+    const std::chrono::seconds delay)
+{
+    LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(flags)
+                << LOG_FARG(delay.count());
+
+    if (m_probe(uuid, flags)) {
+        m_lift(uuid);
+        return;
+    }
+
+    // Retries might have been started again while the probe waited for
+    // the storage
+    if (!scheduled(uuid))
+        schedule(uuid, flags, std::min(2 * delay, MAX_DELAY));
+}
+
+} // namespace fslogic
+} // namespace client
+} // namespace one
@@ -0,0 +1,98 @@
+/**
+ * @file directIOReprober.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#pragma once
+
+#include <folly/FBString.h>
+#include <folly/Function.h>
+
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+namespace one {
+namespace client {
+namespace fslogic {
+
+/**
+ * @c DirectIOReprober periodically retries direct IO for files forced to
+ * proxy IO, e.g. after a permission error on storage, so that they don't
+ * stay on proxy IO until remount. The delay between retries of a file
+ * starts at a configured value and is doubled after each failed retry, up
+ * to @c MAX_DELAY. All methods, as well as the probes, are expected to run
+ * in the same fiber.
+ */
+class DirectIOReprober {
+public:
+    static constexpr std::chrono::seconds MAX_DELAY{3600};
+
+    using Schedule = std::function<std::function<void()>(
+        std::chrono::seconds, std::function<void()>)>;
+
+    /**
+     * Constructor.
+     * @param delay Initial delay of retries (0 disables retries).
+     * @param schedule Function scheduling a task after a delay, returning
+     * a function which cancels it.
+     * @param runInFiber Function running a task in the fiber of the owner.
+     * @param probe Function trying direct IO for a file with given open
+     * flags, returning true if the file doesn't need proxy IO anymore.
+     * @param lift Function lifting forced proxy IO of a file after a
+     * successful probe.
+     */
+    DirectIOReprober(const std::chrono::seconds delay, Schedule schedule,
+        std::function<void(folly::Function<void()>)> runInFiber,
+        std::function<bool(const folly::fbstring &, const int)> probe,
+        std::function<void(const folly::fbstring &)> lift);
+
+    /**
+     * Cancels all scheduled retries.
+     */
+    ~DirectIOReprober();
+
+    /**
+     * Schedules retries of direct IO for a file, unless they are already
+     * scheduled.
+     * @param uuid Uuid of the file.
+     * @param flags Open flags with which direct IO is retried.
+     */
+    void start(const folly::fbstring &uuid, const int flags);
+
+    /**
+     * Cancels retries of direct IO for a file.
+     * @param uuid Uuid of the file.
+     */
+    void cancel(const folly::fbstring &uuid);
+
+    /**
+     * @param uuid Uuid of the file.
+     * @return true if a retry of direct IO is scheduled for the file.
+     */
+    bool scheduled(const folly::fbstring &uuid) const
+    {
+        return m_reprobes.count(uuid) > 0;
+    }
+
+private:
+    void schedule(const folly::fbstring &uuid, const int flags,
+        const std::chrono::seconds delay);
+
+    void reprobe(const folly::fbstring &uuid, const int flags,
+        const std::chrono::seconds delay);
+
+    const std::chrono::seconds m_delay;
+    Schedule m_schedule;
+    std::function<void(folly::Function<void()>)> m_runInFiber;
+    std::function<bool(const folly::fbstring &, const int)> m_probe;
+    std::function<void(const folly::fbstring &)> m_lift;
+    std::unordered_map<folly::fbstring, std::function<void()>> m_reprobes;
+};
+
+} // namespace fslogic
+} // namespace client
+} // namespace one
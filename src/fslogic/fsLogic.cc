@@ -15,6 +15,7 @@
 #include "messages/fuse/changeMode.h"
 #include "messages/fuse/createDir.h"
 #include "messages/fuse/createFile.h"
+#include "messages/fuse/deleteChild.h"
 #include "messages/fuse/deleteFile.h"
 #include "messages/fuse/fileAttr.h"
 #include "messages/fuse/fileBlock.h"
@@ -35,21 +36,25 @@
 #include "messages/fuse/release.h"
 #include "messages/fuse/removeXAttr.h"
 #include "messages/fuse/rename.h"
+#include "messages/fuse/renameChild.h"
+#include "messages/fuse/setAttr.h"
 #include "messages/fuse/setXAttr.h"
 #include "messages/fuse/syncResponse.h"
 #include "messages/fuse/synchronizeBlock.h"
 #include "messages/fuse/synchronizeBlockAndComputeChecksum.h"
 #include "messages/fuse/truncate.h"
-#include "messages/fuse/updateTimes.h"
 #include "messages/fuse/xattr.h"
 #include "messages/fuse/xattrList.h"
 #include "monitoring/monitoring.h"
+#include "options/options.h"
+#include "scheduler.h"
 
 #include <boost/icl/interval_set.hpp>
 #include <folly/Enumerate.h>
 #include <folly/Range.h>
 #include <folly/fibers/FiberManager.h>
 #include <folly/fibers/ForEach.h>
+#include <folly/io/Cursor.h>
 #include <fuse/fuse_lowlevel.h>
 #include <openssl/md4.h>
 
@@ -58,6 +63,31 @@ namespace client {
 namespace fslogic {
 using namespace std::literals;
 
+// Read and write operations accounted in a file handle are emitted as
+// a single event after this delay, or earlier when there are more of them
+// than the limits below
+constexpr std::chrono::milliseconds IO_EVENTS_FLUSH_DELAY{100};
+constexpr std::size_t IO_EVENTS_MAX_OPERATIONS = 1024;
+constexpr std::size_t IO_EVENTS_MAX_EXTENTS = 64;
+
+// Errors of background releases are kept for the next flush or fsync of the
+// file for at most this long, and for at most this many files
+constexpr std::chrono::minutes DEFERRED_RELEASE_ERROR_TTL{5};
+constexpr std::size_t DEFERRED_RELEASE_ERRORS_LIMIT = 1024;
+
+template <typename Event>
+typename Event::FileBlocksMap toFileBlocks(const IOExtents &ioExtents)
+{
+    typename Event::FileBlocksMap blocks;
+    for (const auto &extent : ioExtents.extents)
+        blocks += std::make_pair(
+            boost::icl::discrete_interval<off_t>::right_open(
+                extent.offset, extent.end),
+            messages::fuse::FileBlock{extent.storageId, extent.fileId});
+
+    return blocks;
+}
+
 /**
  * Filters given flags set to one of RDONLY, WRONLY or RDWR.
  * Returns RDONLY if flag value is zero.
@@ -95,10 +125,47 @@ FsLogic::FsLogic(std::shared_ptr<Context> context,
     , m_helpersCache{std::move(helpersCache)}
     , m_readdirCache{std::make_shared<cache::ReaddirCache>(
           m_metadataCache, m_context)}
+    , m_resilientCommunicator{std::make_shared<ResilientCommunicator>(
+          *m_context->communicator(), *m_context->scheduler(),
+          m_context->options()->getHedgePercentile(),
+          m_context->options()->getCircuitBreakerFailureThreshold(),
+          m_context->options()->getCircuitBreakerResetTimeout())}
     , m_readEventsDisabled{readEventsDisabled}
     , m_forceFullblockRead{forceFullblockRead}
+    , m_compoundFileRequests{WITH_COMPOUND_FILE_REQUESTS &&
+          m_context->options()->areCompoundFileRequestsEnabled()}
+    , m_pageCachePrefetchSize{
+          m_context->options()->getPageCachePrefetchSize()}
+    , m_writeBehindBufferSize{
+          m_context->options()->getWriteBehindBufferSize()}
+    , m_writeBehindFlushDelay{
+          m_context->options()->getWriteBehindFlushDelay()}
+    , m_writeStripeSize{m_context->options()->getWriteStripeSize()}
+    , m_writeStripeCount{
+          std::max(1u, m_context->options()->getWriteStripeCount())}
+    , m_timesWriteBackDelay{m_context->options()->getTimesWriteBackDelay()}
+    , m_fastRelease{m_context->options()->isFastReleaseEnabled()}
+    , m_handlePoolSize{m_context->options()->getHandlePoolSize()}
+    , m_handlePoolIdleTimeout{
+          m_context->options()->getHandlePoolIdleTimeout()}
+    , m_smallFileInlineSize{WITH_INLINE_FILE_DATA
+              ? m_context->options()->getSmallFileInlineSize()
+              : 0}
+    , m_smallFileCache{m_context->options()->getSmallFileCacheSize()}
+    , m_directIOReprober{m_context->options()->getDirectIOReprobeDelay(),
+          [this](auto delay, auto task) {
+              return m_context->scheduler()->schedule(delay, std::move(task));
+          },
+          runInFiber,
+          [this](const folly::fbstring &uuid, const int flags) {
+              return reprobeDirectIO(uuid, flags);
+          },
+          [this](const folly::fbstring &uuid) {
+              m_forceProxyIOCache.remove(uuid);
+          }}
     , m_fsSubscriptions{m_eventManager, m_metadataCache, m_forceProxyIOCache,
-          runInFiber}
+          runInFiber, *m_context->scheduler(),
+          m_context->options()->getSubscriptionBatchDelay()}
     , m_providerTimeout{std::move(providerTimeout)}
     , m_runInFiber{std::move(runInFiber)}
 {
@@ -106,7 +173,18 @@ FsLogic::FsLogic(std::shared_ptr<Context> context,
 
     m_eventManager.subscribe(*configuration);
 
+    if (!WITH_COMPOUND_FILE_REQUESTS &&
+        m_context->options()->areCompoundFileRequestsEnabled())
+        LOG(WARNING) << "Compound file requests are not supported by this "
+                        "build - using separate requests instead";
+
+    if (!WITH_INLINE_FILE_DATA &&
+        m_context->options()->getSmallFileInlineSize() > 0)
+        LOG(WARNING) << "Inline small file contents are not supported by "
+                        "this build - reading them from storage instead";
+
     m_metadataCache.setReaddirCache(m_readdirCache);
+    m_metadataCache.setResilientCommunicator(m_resilientCommunicator);
 
     // Quota initial configuration
     m_eventManager.subscribe(
@@ -123,6 +201,7 @@ FsLogic::FsLogic(std::shared_ptr<Context> context,
 
     m_forceProxyIOCache.onRemove([this](const folly::fbstring &uuid) {
         m_fsSubscriptions.unsubscribeFilePermChanged(uuid);
+        m_directIOReprober.cancel(uuid);
     });
 
     m_metadataCache.onAdd([this](const folly::fbstring &uuid) {
@@ -141,6 +220,9 @@ FsLogic::FsLogic(std::shared_ptr<Context> context,
         m_fsSubscriptions.unsubscribeFileLocationChanged(uuid);
         m_fsSubscriptions.unsubscribeFileRemoved(uuid);
         m_fsSubscriptions.unsubscribeFileRenamed(uuid);
+
+        // Without subscriptions remote changes of the file go unnoticed
+        m_smallFileCache.erase(uuid);
     });
 
     m_metadataCache.onRename(
@@ -155,11 +237,31 @@ FsLogic::FsLogic(std::shared_ptr<Context> context,
             if (m_fsSubscriptions.unsubscribeFileLocationChanged(oldUuid))
                 m_fsSubscriptions.subscribeFileLocationChanged(newUuid);
 
+            evictPooledHandles(oldUuid);
+            m_smallFileCache.erase(oldUuid);
             m_onRename(oldUuid, newUuid);
         });
 
-    m_metadataCache.onMarkDeleted(
-        [this](const folly::fbstring &uuid) { m_onMarkDeleted(uuid); });
+    // Files are opened without direct_io when the page cache is enabled, so
+    // pages read before a remote change must not be served afterwards; the
+    // same holds for cached small file contents, whose size and mtime may
+    // not change with a write within the same second
+    m_fsSubscriptions.onRemoteUpdate([this](const folly::fbstring &uuid) {
+        m_smallFileCache.erase(uuid);
+        if (isPageCacheEnabled())
+            m_onPageCacheInvalidate(uuid);
+    });
+
+    // Pooled handles are reused without sending OpenFile, so they must not
+    // outlive a change of mode or permissions that the provider would check
+    m_fsSubscriptions.onAccessChange(
+        [this](const folly::fbstring &uuid) { evictPooledHandles(uuid); });
+
+    m_metadataCache.onMarkDeleted([this](const folly::fbstring &uuid) {
+        evictPooledHandles(uuid);
+        m_smallFileCache.erase(uuid);
+        m_onMarkDeleted(uuid);
+    });
 }
 
 FileAttrPtr FsLogic::lookup(
@@ -167,13 +269,17 @@ FileAttrPtr FsLogic::lookup(
 {
     LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(name);
 
-    return m_metadataCache.getAttr(uuid, name);
+    auto attr = m_metadataCache.getAttr(uuid, name);
+    flushWriteBuffers(attr->uuid());
+    return attr;
 }
 
 FileAttrPtr FsLogic::getattr(const folly::fbstring &uuid)
 {
     LOG_FCALL() << LOG_FARG(uuid);
 
+    // Make sure that the size reflects all acknowledged writes
+    flushWriteBuffers(uuid);
     return m_metadataCache.getAttr(uuid);
 }
 
@@ -189,29 +295,128 @@ std::uint64_t FsLogic::open(const folly::fbstring &uuid, const int flags)
 {
     LOG_FCALL() << LOG_FARG(uuid) << LOG_FARGH(flags);
 
-    auto openFileToken = m_metadataCache.open(uuid);
-
     const auto filteredFlags = flags & (~O_CREAT) & (~O_APPEND);
 
+    if (auto pooledHandle = takePooledHandle(uuid, filteredFlags)) {
+        const auto fuseFileHandleId = m_nextFuseHandleId++;
+        m_fuseFileHandles.emplace(fuseFileHandleId, std::move(pooledHandle));
+
+        LOG_DBG(1) << "Reused pooled fuse handle for file " << uuid;
+        ONE_METRIC_COUNTER_INC("comp.oneclient.mod.fuse.handle_pool_hits");
+
+        return fuseFileHandleId;
+    }
+
     const auto flag = getOpenFlag(helpers::maskToFlags(filteredFlags));
-    messages::fuse::OpenFile msg{uuid.toStdString(), flag};
+
+    // Contents of small files are only requested for reading, as writes
+    // need a storage handle anyway
+    const bool inlineData = m_smallFileInlineSize > 0 &&
+        flag == helpers::Flag::RDONLY && !(filteredFlags & O_TRUNC);
+
+    messages::fuse::OpenFile msg{uuid.toStdString(), flag,
+        inlineData ? m_smallFileInlineSize : 0};
 
     LOG_DBG(1) << "Sending file opened message for " << uuid;
 
-    auto opened = communicate<messages::fuse::FileOpened>(
-        std::move(msg), m_providerTimeout);
+    // OpenFile doesn't depend on the file's metadata, so it's sent before
+    // the attributes and location are fetched into the cache
+    auto openedFuture =
+        m_resilientCommunicator->communicate<messages::fuse::FileOpened>(
+            std::move(msg), m_providerTimeout);
+
+    std::shared_ptr<cache::LRUMetadataCache::OpenFileToken> openFileToken;
+    try {
+        openFileToken = m_metadataCache.open(uuid);
+    }
+    catch (...) {
+        // Don't leave the file open on the provider if it has been opened
+        std::move(openedFuture)
+            .then([this, uuid](const messages::fuse::FileOpened &opened) {
+                return m_resilientCommunicator
+                    ->communicate<messages::fuse::FuseResponse>(
+                        messages::fuse::Release{
+                            uuid.toStdString(), opened.handleId()},
+                        m_providerTimeout)
+                    .then([](const messages::fuse::FuseResponse &) {});
+            })
+            .onError([uuid](folly::exception_wrapper ew) {
+                LOG_DBG(1) << "Release of file " << uuid
+                           << " after failed open failed: " << ew.what();
+            });
+        throw;
+    }
+
+    auto opened =
+        communication::wait(std::move(openedFuture), m_providerTimeout);
+
+    auto fuseFileHandle = std::make_shared<FuseFileHandle>(filteredFlags,
+        opened.handleId(), openFileToken, *m_helpersCache, m_forceProxyIOCache,
+        m_helperHandleRegistry, m_providerTimeout);
 
     const auto fuseFileHandleId = m_nextFuseHandleId++;
-    m_fuseFileHandles.emplace(fuseFileHandleId,
-        std::make_shared<FuseFileHandle>(filteredFlags, opened.handleId(),
-            openFileToken, *m_helpersCache, m_forceProxyIOCache,
-            m_providerTimeout));
+    m_fuseFileHandles.emplace(fuseFileHandleId, fuseFileHandle);
 
     LOG_DBG(1) << "Stored fuse handle for file " << uuid;
 
+    if (inlineData && cacheInlineData(uuid, opened))
+        return fuseFileHandleId;
+
+    openDefaultHelperHandle(uuid, std::move(fuseFileHandle));
+
     return fuseFileHandleId;
 }
 
+bool FsLogic::cacheInlineData(
+    const folly::fbstring &uuid, const messages::fuse::FileOpened &opened)
+{
+    LOG_FCALL() << LOG_FARG(uuid);
+
+    auto attr = m_metadataCache.getAttr(uuid);
+
+    if (opened.inlineData()) {
+        if (opened.inlineData()->size() != *attr->size()) {
+            LOG_DBG(1) << "Inline contents of file " << uuid
+                       << " don't match its size - ignoring";
+            return false;
+        }
+
+        LOG_DBG(1) << "Caching inline contents of file " << uuid;
+        m_smallFileCache.put(uuid, *opened.inlineData(), attr->mtime());
+    }
+
+    return m_smallFileCache.get(uuid, *attr->size(), attr->mtime()) !=
+        nullptr;
+}
+
+void FsLogic::openDefaultHelperHandle(
+    const folly::fbstring &uuid, std::shared_ptr<FuseFileHandle> fuseFileHandle)
+{
+    LOG_FCALL() << LOG_FARG(uuid);
+
+    // The storage handle is opened in a separate fiber, so that open returns
+    // right away and the first read or write joins the open in progress
+    m_runInFiber([this, uuid, fuseFileHandle = std::move(fuseFileHandle)] {
+        try {
+            auto defaultBlock = m_metadataCache.getDefaultBlock(uuid);
+            fuseFileHandle->getHelperHandle(uuid,
+                m_metadataCache.getSpaceId(uuid), defaultBlock.storageId(),
+                defaultBlock.fileId());
+
+            if (fuseFileHandle->released()) {
+                LOG_DBG(1) << "File " << uuid
+                           << " released before its helper handle was "
+                              "opened - releasing helper handle";
+                fuseFileHandle->releaseHelperHandles();
+            }
+        }
+        catch (const std::exception &e) {
+            LOG_DBG(1) << "Eager helper handle open for file " << uuid
+                       << " failed: " << e.what();
+        }
+    });
+}
+
 void FsLogic::release(
     const folly::fbstring &uuid, const std::uint64_t fileHandleId)
 {
@@ -219,11 +424,55 @@ void FsLogic::release(
 
     auto fuseFileHandle = m_fuseFileHandles.at(fileHandleId);
 
-    fsync(uuid, fileHandleId, false);
+    if (m_fastRelease) {
+        // Only buffered data is written on close, the release itself is
+        // completed without blocking the caller
+        std::exception_ptr flushException;
+        try {
+            flushWriteBuffer(fileHandleId, fuseFileHandle);
+            fuseFileHandle->rethrowWriteBufferError();
+            flushTimes(uuid);
+        }
+        catch (...) {
+            flushException = std::current_exception();
+        }
+
+        // Writes of the buffer flushed above are accounted in the handle, so
+        // they're emitted only now
+        flushIOEvents(fuseFileHandle);
+
+        // Data which failed to be written is dropped with the handle, its
+        // error is returned by this release
+        m_writeBufferedHandles.erase(fileHandleId);
+        m_fuseFileHandles.erase(fileHandleId);
+        if (flushException || !poolHandle(uuid, fuseFileHandle))
+            releaseInBackground(uuid, std::move(fuseFileHandle));
+
+        if (flushException)
+            std::rethrow_exception(flushException);
+
+        return;
+    }
 
-    folly::fbvector<folly::Future<folly::Unit>> releaseFutures;
-    for (auto &helperHandle : fuseFileHandle->helperHandles())
-        releaseFutures.emplace_back(helperHandle->release());
+    std::exception_ptr releaseException;
+    try {
+        fsync(uuid, fileHandleId, false);
+    }
+    catch (...) {
+        releaseException = std::current_exception();
+    }
+
+    // A failed fsync may return before emitting the handle's events
+    flushIOEvents(fuseFileHandle);
+
+    if (!releaseException && poolHandle(uuid, fuseFileHandle)) {
+        m_fuseFileHandles.erase(fileHandleId);
+        return;
+    }
+
+    fuseFileHandle->setReleased();
+
+    auto releaseFutures = fuseFileHandle->releaseHelperHandles();
 
     auto releaseExceptionFuture =
         folly::collectAll(releaseFutures)
@@ -232,12 +481,12 @@ void FsLogic::release(
                     t.value();
             });
 
-    std::exception_ptr releaseException;
     try {
         communication::wait(releaseExceptionFuture, m_providerTimeout);
     }
     catch (...) {
-        releaseException = std::current_exception();
+        if (!releaseException)
+            releaseException = std::current_exception();
     }
 
     LOG_DBG(1) << "Sending file release message for " << uuid;
@@ -246,12 +495,248 @@ void FsLogic::release(
                     fuseFileHandle->providerHandleId()->toStdString()},
         m_providerTimeout);
 
+    m_writeBufferedHandles.erase(fileHandleId);
     m_fuseFileHandles.erase(fileHandleId);
 
     if (releaseException)
         std::rethrow_exception(releaseException);
 }
 
+void FsLogic::releaseInBackground(const folly::fbstring &uuid,
+    std::shared_ptr<FuseFileHandle> fuseFileHandle)
+{
+    LOG_FCALL() << LOG_FARG(uuid);
+
+    fuseFileHandle->setReleased();
+
+    auto releaseFutures = fuseFileHandle->releaseHelperHandles();
+
+    LOG_DBG(1) << "Releasing file " << uuid << " in background";
+
+    folly::collectAll(releaseFutures)
+        .then([ this, uuid, fuseFileHandle = std::move(fuseFileHandle) ](
+            std::vector<folly::Try<folly::Unit>> tries) {
+            return m_resilientCommunicator
+                ->communicate<messages::fuse::FuseResponse>(
+                    messages::fuse::Release{uuid.toStdString(),
+                        fuseFileHandle->providerHandleId()->toStdString()},
+                    m_providerTimeout)
+                .then([ tries = std::move(tries) ](
+                    const messages::fuse::FuseResponse &) {
+                    for (auto &t : tries)
+                        t.value();
+                });
+        })
+        .onError([this, uuid](folly::exception_wrapper ew) {
+            LOG(ERROR) << "Background release of file " << uuid
+                       << " failed: " << ew.what();
+
+            ONE_METRIC_COUNTER_INC(
+                "comp.oneclient.mod.fuse.release_deferred_errors");
+
+            m_runInFiber([this, uuid, ew] {
+                deferReleaseError(uuid, ew.to_exception_ptr());
+            });
+        });
+}
+
+bool FsLogic::poolHandle(const folly::fbstring &uuid,
+    std::shared_ptr<FuseFileHandle> fuseFileHandle)
+{
+    LOG_FCALL() << LOG_FARG(uuid);
+
+    if (m_handlePoolSize == 0)
+        return false;
+
+    auto key = std::make_tuple(uuid, fuseFileHandle->flags());
+    if (m_handlePool.count(key))
+        return false;
+
+    if (m_handlePool.size() >= m_handlePoolSize) {
+        auto oldest = std::min_element(m_handlePool.begin(),
+            m_handlePool.end(), [](const auto &a, const auto &b) {
+                return a.second.sequence < b.second.sequence;
+            });
+
+        LOG_DBG(1) << "Evicting oldest pooled handle of file "
+                   << std::get<0>(oldest->first);
+
+        oldest->second.cancelExpiry();
+        releaseInBackground(
+            std::get<0>(oldest->first), std::move(oldest->second.handle));
+        m_handlePool.erase(oldest);
+    }
+
+    PooledHandle pooledHandle;
+    pooledHandle.handle = std::move(fuseFileHandle);
+    pooledHandle.sequence = m_nextPooledHandleSequence++;
+    pooledHandle.cancelExpiry = m_context->scheduler()->schedule(
+        m_handlePoolIdleTimeout, [this, key] {
+            m_runInFiber([this, key] {
+                auto it = m_handlePool.find(key);
+                if (it == m_handlePool.end())
+                    return;
+
+                LOG_DBG(1) << "Releasing idle pooled handle of file "
+                           << std::get<0>(key);
+
+                auto fuseFileHandle = std::move(it->second.handle);
+                m_handlePool.erase(it);
+                releaseInBackground(
+                    std::get<0>(key), std::move(fuseFileHandle));
+            });
+        });
+
+    m_handlePool.emplace(std::move(key), std::move(pooledHandle));
+
+    LOG_DBG(1) << "Pooled fuse handle of file " << uuid;
+
+    return true;
+}
+
+std::shared_ptr<FuseFileHandle> FsLogic::takePooledHandle(
+    const folly::fbstring &uuid, const int flags)
+{
+    // Truncating opens must reach the provider
+    if (m_handlePool.empty() || (flags & O_TRUNC))
+        return {};
+
+    auto it = m_handlePool.find(std::make_tuple(uuid, flags));
+    if (it == m_handlePool.end())
+        return {};
+
+    it->second.cancelExpiry();
+    auto fuseFileHandle = std::move(it->second.handle);
+    m_handlePool.erase(it);
+
+    fuseFileHandle->setLastPrefetch({});
+    fuseFileHandle->setPageCacheStoredUpTo(0);
+
+    return fuseFileHandle;
+}
+
+void FsLogic::evictPooledHandles(const folly::fbstring &uuid)
+{
+    for (auto it = m_handlePool.begin(); it != m_handlePool.end();) {
+        if (std::get<0>(it->first) != uuid) {
+            ++it;
+            continue;
+        }
+
+        it->second.cancelExpiry();
+        releaseInBackground(uuid, std::move(it->second.handle));
+        it = m_handlePool.erase(it);
+    }
+}
+
+void FsLogic::forceProxyIO(const folly::fbstring &uuid, const int flags)
+{
+    m_forceProxyIOCache.add(uuid);
+    m_directIOReprober.start(uuid, flags);
+}
+
+bool FsLogic::reprobeDirectIO(const folly::fbstring &uuid, const int flags)
+{
+    LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(flags);
+
+    if (!m_forceProxyIOCache.contains(uuid))
+        return true;
+
+    auto retryLater = [&](const char *reason) {
+        LOG_DBG(1) << "Direct IO for file " << uuid
+                   << " still unavailable: " << reason;
+
+        ONE_METRIC_COUNTER_INC(
+            "comp.oneclient.mod.fslogic.direct_io_reprobe_failures");
+
+        return !m_forceProxyIOCache.contains(uuid);
+    };
+
+    try {
+        auto fileBlock = m_metadataCache.getDefaultBlock(uuid);
+        auto helper = m_helpersCache->get(uuid,
+            m_metadataCache.getSpaceId(uuid), fileBlock.storageId(), false);
+
+        // Without direct access the probe would succeed through proxy IO
+        if (m_helpersCache->getAccessType(fileBlock.storageId()) !=
+            cache::HelpersCache::AccessType::DIRECT) {
+            return retryLater("storage is not directly accessible");
+        }
+
+        auto helperHandle = communication::wait(
+            helper->open(fileBlock.fileId(), flags & O_ACCMODE,
+                {{"file_uuid", uuid}}),
+            m_providerTimeout);
+
+        communication::wait(helperHandle->release(), m_providerTimeout);
+    }
+    catch (const std::system_error &e) {
+        if (e.code().value() == ENOENT) {
+            LOG_DBG(1) << "File " << uuid
+                       << " no longer exists, not retrying direct IO";
+            return true;
+        }
+
+        return retryLater(e.what());
+    }
+    catch (const std::exception &e) {
+        return retryLater(e.what());
+    }
+
+    LOG(INFO) << "Direct IO for file " << uuid
+              << " is available again, disabling forced proxy IO";
+
+    ONE_METRIC_COUNTER_INC(
+        "comp.oneclient.mod.fslogic.direct_io_reprobe_successes");
+
+    return true;
+}
+
+void FsLogic::deferReleaseError(
+    const folly::fbstring &uuid, std::exception_ptr releaseException)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto it = m_deferredReleaseErrors.begin();
+         it != m_deferredReleaseErrors.end();) {
+        if (it->second.expiresAt <= now)
+            it = m_deferredReleaseErrors.erase(it);
+        else
+            ++it;
+    }
+
+    if (m_deferredReleaseErrors.size() >= DEFERRED_RELEASE_ERRORS_LIMIT &&
+        !m_deferredReleaseErrors.count(uuid)) {
+        auto oldest = std::min_element(m_deferredReleaseErrors.begin(),
+            m_deferredReleaseErrors.end(), [](const auto &a, const auto &b) {
+                return a.second.expiresAt < b.second.expiresAt;
+            });
+
+        LOG(WARNING) << "Dropping deferred release error of file "
+                     << oldest->first;
+
+        m_deferredReleaseErrors.erase(oldest);
+    }
+
+    m_deferredReleaseErrors[uuid] = {
+        std::move(releaseException), now + DEFERRED_RELEASE_ERROR_TTL};
+}
+
+void FsLogic::rethrowDeferredReleaseError(const folly::fbstring &uuid)
+{
+    auto it = m_deferredReleaseErrors.find(uuid);
+    if (it == m_deferredReleaseErrors.end())
+        return;
+
+    auto deferredError = std::move(it->second);
+    m_deferredReleaseErrors.erase(it);
+
+    if (deferredError.expiresAt <= std::chrono::steady_clock::now())
+        return;
+
+    std::rethrow_exception(deferredError.exception);
+}
+
 void FsLogic::flush(
     const folly::fbstring &uuid, const std::uint64_t fileHandleId)
 {
@@ -259,10 +744,24 @@ void FsLogic::flush(
 
     auto fuseFileHandle = m_fuseFileHandles.at(fileHandleId);
 
+    flushWriteBuffer(fileHandleId, fuseFileHandle);
+    fuseFileHandle->rethrowWriteBufferError();
+    rethrowDeferredReleaseError(uuid);
+
     LOG_DBG(1) << "Sending file flush message for " << uuid;
 
-    for (auto &helperHandle : fuseFileHandle->helperHandles())
-        communication::wait(helperHandle->flush(), helperHandle->timeout());
+    folly::fbvector<folly::Future<folly::Unit>> flushFutures;
+    auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+        m_providerTimeout);
+
+    for (auto &helperHandle : fuseFileHandle->helperHandles()) {
+        flushFutures.emplace_back(helperHandle->flush());
+        timeout = std::max(timeout,
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                helperHandle->timeout()));
+    }
+
+    waitForAll(std::move(flushFutures), timeout);
 }
 
 void FsLogic::fsync(const folly::fbstring &uuid,
@@ -271,18 +770,55 @@ void FsLogic::fsync(const folly::fbstring &uuid,
     LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(fileHandleId)
                 << LOG_FARG(dataOnly);
 
-    m_eventManager.flush();
-
     auto fuseFileHandle = m_fuseFileHandles.at(fileHandleId);
 
+    flushWriteBuffer(fileHandleId, fuseFileHandle);
+    fuseFileHandle->rethrowWriteBufferError();
+    rethrowDeferredReleaseError(uuid);
+
+    // Only read and write events of the synchronized file are sent
+    flushIOEvents(uuid);
+    m_eventManager.flush(events::StreamKey::FILE_READ, uuid.toStdString());
+    m_eventManager.flush(events::StreamKey::FILE_WRITTEN, uuid.toStdString());
+    flushTimes(uuid);
+
     LOG_DBG(1) << "Sending file fsync message for " << uuid;
 
-    communicate(messages::fuse::FSync{uuid.toStdString(), dataOnly,
-                    fuseFileHandle->providerHandleId()->toStdString()},
+    // Provider and storage syncs are independent, so they're all issued
+    // at once and the fsync takes as long as the slowest of them
+    folly::fbvector<folly::Future<folly::Unit>> fsyncFutures;
+    auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
         m_providerTimeout);
-    for (auto &helperHandle : fuseFileHandle->helperHandles())
-        communication::wait(
-            helperHandle->fsync(dataOnly), helperHandle->timeout());
+
+    fsyncFutures.emplace_back(
+        m_resilientCommunicator
+            ->communicate<messages::fuse::FuseResponse>(
+                messages::fuse::FSync{uuid.toStdString(), dataOnly,
+                    fuseFileHandle->providerHandleId()->toStdString()},
+                m_providerTimeout)
+            .then([](const messages::fuse::FuseResponse &) {}));
+
+    for (auto &helperHandle : fuseFileHandle->helperHandles()) {
+        fsyncFutures.emplace_back(helperHandle->fsync(dataOnly));
+        timeout = std::max(timeout,
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                helperHandle->timeout()));
+    }
+
+    waitForAll(std::move(fsyncFutures), timeout);
+}
+
+void FsLogic::waitForAll(folly::fbvector<folly::Future<folly::Unit>> futures,
+    const std::chrono::milliseconds timeout)
+{
+    auto allFuture =
+        folly::collectAll(futures).then(
+            [](const std::vector<folly::Try<folly::Unit>> &tries) {
+                for (auto &t : tries)
+                    t.value();
+            });
+
+    communication::wait(allFuture, timeout);
 }
 
 folly::IOBufQueue FsLogic::read(const folly::fbstring &uuid,
@@ -293,6 +829,11 @@ folly::IOBufQueue FsLogic::read(const folly::fbstring &uuid,
                 << LOG_FARG(size);
 
     auto fuseFileHandle = m_fuseFileHandles.at(fileHandleId);
+
+    flushWriteBuffers(uuid,
+        boost::icl::discrete_interval<off_t>::right_open(
+            offset, offset + size));
+
     auto attr = m_metadataCache.getAttr(uuid);
 
     const auto possibleRange =
@@ -309,6 +850,23 @@ folly::IOBufQueue FsLogic::read(const folly::fbstring &uuid,
         return folly::IOBufQueue{folly::IOBufQueue::cacheChainLength()};
     }
 
+    if (m_smallFileInlineSize > 0) {
+        if (auto data =
+                m_smallFileCache.get(uuid, *attr->size(), attr->mtime())) {
+            LOG_DBG(1) << "Reading file " << uuid << " from range "
+                       << wantedRange << " from small file cache";
+
+            ONE_METRIC_COUNTER_INC(
+                "comp.oneclient.mod.fuse.small_file_cache_hits");
+
+            folly::IOBufQueue buf{folly::IOBufQueue::cacheChainLength()};
+            buf.append(folly::IOBuf::copyBuffer(
+                data->data() + boost::icl::first(wantedRange),
+                boost::icl::size(wantedRange)));
+            return buf;
+        }
+    }
+
     LOG_DBG(1) << "Reading from file " << uuid << " from range " << wantedRange;
 
     // Even if several "touching" blocks with different helpers are
@@ -367,10 +925,20 @@ folly::IOBufQueue FsLogic::read(const folly::fbstring &uuid,
         LOG_DBG(1) << "Reading " << availableSize << " bytes from " << uuid
                    << " at offset " << offset;
 
+        auto queueSlot =
+            m_helpersCache->acquireQueueSlot(fileBlock.storageId());
+        const auto readStart = std::chrono::steady_clock::now();
+
         auto readBuffer = communication::wait(
             helperHandle->read(offset, availableSize, continuousSize),
             helperHandle->timeout());
 
+        queueSlot.release();
+
+        m_helpersCache->recordIO(fileBlock.storageId(),
+            fuseFileHandle->proxyIO(helperHandle), readBuffer.chainLength(),
+            std::chrono::steady_clock::now() - readStart);
+
         if (helperHandle->needsDataConsistencyCheck() && checksum &&
             dataCorrupted(uuid, readBuffer, *checksum, wantedAvailableRange,
                 wantedRange)) {
@@ -387,13 +955,17 @@ folly::IOBufQueue FsLogic::read(const folly::fbstring &uuid,
 
         const auto bytesRead = readBuffer.chainLength();
         if (!m_readEventsDisabled) {
-            m_eventManager.emit<events::FileRead>(
-                uuid.toStdString(), offset, bytesRead);
+            accountedIO(uuid, fuseFileHandle).read.add(offset, bytesRead);
+            flushIOEventsIfFull(fuseFileHandle);
         }
 
         LOG_DBG(1) << "Read " << bytesRead << " bytes from " << uuid
                    << " at offset " << offset;
 
+        if (isPageCacheEnabled() && bytesRead > 0)
+            storeInPageCache(fuseFileHandle, helperHandle, offset, bytesRead,
+                uuid, availableRange);
+
         return readBuffer;
     }
     catch (const std::system_error &e) {
@@ -410,7 +982,7 @@ folly::IOBufQueue FsLogic::read(const folly::fbstring &uuid,
 
         LOG_DBG(1) << "Adding file " << uuid
                    << " to force proxy cache after direct read failed";
-        m_forceProxyIOCache.add(uuid);
+        forceProxyIO(uuid, fuseFileHandle->flags());
 
         LOG_DBG(1) << "Rereading requested block for " << uuid
                    << " via proxy fallback";
@@ -453,6 +1025,71 @@ void FsLogic::prefetchSync(std::shared_ptr<FuseFileHandle> fuseFileHandle,
     }
 }
 
+void FsLogic::storeInPageCache(std::shared_ptr<FuseFileHandle> fuseFileHandle,
+    helpers::FileHandlePtr helperHandle, const off_t offset,
+    const std::size_t size, const folly::fbstring &uuid,
+    const boost::icl::discrete_interval<off_t> availableRange)
+{
+    // Only push the data which the helper is already reading ahead, so that
+    // populating the page cache does not generate any additional storage I/O
+    const std::size_t wouldPrefetch = helperHandle->wouldPrefetch(offset, size);
+    if (wouldPrefetch == 0)
+        return;
+
+    // A read below the pushed data means the kernel no longer has those
+    // pages, e.g. after a backward seek past evicted pages or invalidation
+    if (offset < fuseFileHandle->pageCacheStoredUpTo())
+        fuseFileHandle->setPageCacheStoredUpTo(0);
+
+    const off_t readEnd = offset + size;
+    const auto wantToStoreRange =
+        boost::icl::discrete_interval<off_t>::right_open(
+            std::max(readEnd, fuseFileHandle->pageCacheStoredUpTo()),
+            readEnd + std::min(wouldPrefetch, m_pageCachePrefetchSize));
+
+    const auto storeRange = wantToStoreRange & availableRange;
+    const std::size_t storeSize = boost::icl::size(storeRange);
+
+    if (storeSize == 0 ||
+        m_pageCacheStoreInFlight + storeSize > m_pageCachePrefetchSize)
+        return;
+
+    const off_t storeOffset = boost::icl::first(storeRange);
+    fuseFileHandle->setPageCacheStoredUpTo(storeOffset + storeSize);
+    m_pageCacheStoreInFlight += storeSize;
+
+    LOG_DBG(2) << "Pushing " << storeSize << " bytes of " << uuid
+               << " at offset " << storeOffset << " into page cache";
+
+    helperHandle->read(storeOffset, storeSize, storeSize)
+        .then([ this, uuid, storeOffset, storeSize ](
+            folly::Try<folly::IOBufQueue> maybeBuf) {
+            m_runInFiber([
+                this, uuid, storeOffset, storeSize,
+                maybeBuf = std::move(maybeBuf)
+            ]() mutable {
+                m_pageCacheStoreInFlight -= storeSize;
+
+                if (maybeBuf.hasException()) {
+                    LOG_DBG(1) << "Failed to read " << storeSize << " bytes of "
+                               << uuid << " at offset " << storeOffset
+                               << " for page cache";
+                    return;
+                }
+
+                if (maybeBuf->empty())
+                    return;
+
+                ONE_METRIC_COUNTER_ADD(
+                    "comp.oneclient.mod.fuse.page_cache_stored",
+                    maybeBuf->chainLength());
+
+                m_onPageCacheStore(
+                    uuid, storeOffset, std::move(maybeBuf.value()));
+            });
+        });
+}
+
 std::size_t FsLogic::write(const folly::fbstring &uuid,
     const std::uint64_t fuseFileHandleId, const off_t offset,
     folly::IOBufQueue buf)
@@ -466,6 +1103,313 @@ std::size_t FsLogic::write(const folly::fbstring &uuid,
     }
 
     auto fuseFileHandle = m_fuseFileHandles.at(fuseFileHandleId);
+
+    m_smallFileCache.erase(uuid);
+    waitForWriteBufferFlush(*fuseFileHandle);
+    fuseFileHandle->rethrowWriteBufferError();
+
+    // Writes that wouldn't fit in the buffer, as well as all writes when
+    // write-behind is disabled, go directly to the storage
+    const std::size_t size = buf.chainLength();
+    if (size >= m_writeBehindBufferSize) {
+        flushWriteBuffer(fuseFileHandleId, fuseFileHandle);
+        return writeToStorage(uuid, fuseFileHandle, offset, std::move(buf));
+    }
+
+    auto &writeBuffer = fuseFileHandle->writeBuffer();
+    if (writeBuffer &&
+        (writeBuffer->end() != offset ||
+            writeBuffer->data.chainLength() + size > m_writeBehindBufferSize))
+        flushWriteBuffer(fuseFileHandleId, fuseFileHandle);
+
+    if (!writeBuffer) {
+        // Quota is checked once per coalesced extent
+        if (isSpaceDisabled(m_metadataCache.getSpaceId(uuid))) {
+            LOG(ERROR) << "Write to file " << uuid << " failed - space "
+                       << m_metadataCache.getSpaceId(uuid)
+                       << " quota exceeded";
+            throw std::errc::no_space_on_device;
+        }
+
+        writeBuffer.emplace();
+        writeBuffer->uuid = uuid;
+        writeBuffer->offset = offset;
+        writeBuffer->cancelFlush = m_context->scheduler()->schedule(
+            m_writeBehindFlushDelay, [this, fuseFileHandleId] {
+                m_runInFiber([this, fuseFileHandleId] {
+                    auto it = m_fuseFileHandles.find(fuseFileHandleId);
+                    if (it == m_fuseFileHandles.end())
+                        return;
+
+                    try {
+                        flushWriteBuffer(fuseFileHandleId, it->second);
+                    }
+                    catch (...) {
+                        it->second->setWriteBufferError(
+                            std::current_exception());
+                    }
+                });
+            });
+
+        m_writeBufferedHandles.insert(fuseFileHandleId);
+    }
+
+    writeBuffer->data.append(std::move(buf));
+
+    LOG_DBG(2) << "Buffered " << size << " bytes for file " << uuid
+               << " at offset " << offset;
+
+    if (writeBuffer->data.chainLength() >= m_writeBehindBufferSize)
+        flushWriteBuffer(fuseFileHandleId, fuseFileHandle);
+
+    return size;
+}
+
+void FsLogic::flushWriteBuffer(const std::uint64_t fuseFileHandleId,
+    std::shared_ptr<FuseFileHandle> fuseFileHandle)
+{
+    waitForWriteBufferFlush(*fuseFileHandle);
+
+    auto &writeBuffer = fuseFileHandle->writeBuffer();
+    if (!writeBuffer)
+        return;
+
+    auto buffer = std::move(*writeBuffer);
+    writeBuffer.clear();
+    m_writeBufferedHandles.erase(fuseFileHandleId);
+    buffer.cancelFlush();
+
+    auto flush = std::make_shared<folly::SharedPromise<folly::Unit>>();
+    fuseFileHandle->writeBufferFlush() = flush;
+
+    LOG_DBG(1) << "Flushing " << buffer.data.chainLength()
+               << " bytes buffered for file " << buffer.uuid << " at offset "
+               << buffer.offset;
+
+    try {
+        while (!buffer.data.empty()) {
+            folly::IOBufQueue chunk{folly::IOBufQueue::cacheChainLength()};
+            chunk.append(buffer.data.front()->clone());
+
+            const auto bytesWritten = writeToStorage(
+                buffer.uuid, fuseFileHandle, buffer.offset, std::move(chunk));
+            if (bytesWritten == 0)
+                throw std::errc::io_error;
+
+            buffer.data.trimStart(bytesWritten);
+            buffer.offset += bytesWritten;
+        }
+    }
+    catch (...) {
+        restoreWriteBuffer(
+            fuseFileHandleId, *fuseFileHandle, std::move(buffer));
+        fuseFileHandle->writeBufferFlush().reset();
+        flush->setValue();
+        throw;
+    }
+
+    fuseFileHandle->writeBufferFlush().reset();
+    flush->setValue();
+}
+
+void FsLogic::restoreWriteBuffer(const std::uint64_t fuseFileHandleId,
+    FuseFileHandle &fuseFileHandle, WriteBuffer buffer)
+{
+    // The data has already been acknowledged to the application, so the part
+    // which hasn't been written stays buffered in the handle and is written
+    // by its next flush. Nothing else can be buffered in the handle meanwhile,
+    // as writes wait for the flush to complete.
+    buffer.cancelFlush = [] {};
+    fuseFileHandle.writeBuffer() = std::move(buffer);
+    m_writeBufferedHandles.insert(fuseFileHandleId);
+}
+
+void FsLogic::waitForWriteBufferFlush(FuseFileHandle &fuseFileHandle)
+{
+    // Buffered data is moved out of the handle while it's being written, so
+    // writes and flushes wait for it instead of buffering data which, if the
+    // flush fails, could not be joined with the unwritten part
+    while (auto flush = fuseFileHandle.writeBufferFlush())
+        communication::wait(flush->getFuture(), m_providerTimeout);
+}
+
+void FsLogic::flushWriteBuffers(const folly::fbstring &uuid,
+    const boost::icl::discrete_interval<off_t> &range)
+{
+    if (m_writeBufferedHandles.empty())
+        return;
+
+    const auto bufferedHandles = m_writeBufferedHandles;
+    for (const auto fuseFileHandleId : bufferedHandles) {
+        auto &fuseFileHandle = m_fuseFileHandles.at(fuseFileHandleId);
+        auto &writeBuffer = fuseFileHandle->writeBuffer();
+        if (writeBuffer->uuid != uuid)
+            continue;
+
+        const auto bufferedRange =
+            boost::icl::discrete_interval<off_t>::right_open(
+                writeBuffer->offset, writeBuffer->end());
+        if (boost::icl::size(bufferedRange & range) == 0)
+            continue;
+
+        // The write has already been acknowledged, so its error is reported
+        // on the next flush of the handle instead of the current operation
+        try {
+            flushWriteBuffer(fuseFileHandleId, fuseFileHandle);
+        }
+        catch (...) {
+            fuseFileHandle->setWriteBufferError(std::current_exception());
+        }
+    }
+}
+
+void FsLogic::queueTimesUpdate(const folly::fbstring &uuid,
+    const messages::fuse::UpdateTimes &updateTimes)
+{
+    LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(updateTimes.toString());
+
+    auto it = m_pendingTimes.find(uuid);
+    if (it == m_pendingTimes.end()) {
+        it = m_pendingTimes.emplace(uuid, PendingTimes{uuid}).first;
+
+        // The first queued update bounds the staleness of times known to the
+        // provider, later updates are only merged into it
+        it->second.cancelFlush = m_context->scheduler()->schedule(
+            m_timesWriteBackDelay, [this, uuid] {
+                m_runInFiber([this, uuid] {
+                    auto updateTimes = takePendingTimes(uuid);
+                    if (!updateTimes)
+                        return;
+
+                    LOG_DBG(1) << "Sending coalesced times update for "
+                               << uuid;
+
+                    m_resilientCommunicator
+                        ->communicate<messages::fuse::FuseResponse>(
+                            std::move(*updateTimes), m_providerTimeout)
+                        .then([uuid](folly::Try<messages::fuse::FuseResponse>
+                                  result) {
+                            if (result.hasException())
+                                LOG(WARNING) << "Failed to update times of "
+                                             << uuid << ": "
+                                             << result.exception().what();
+                        });
+                });
+            });
+    }
+    else {
+        ONE_METRIC_COUNTER_INC("comp.oneclient.mod.fuse.times_coalesced");
+    }
+
+    auto &pendingTimes = it->second.updateTimes;
+    if (updateTimes.atime())
+        pendingTimes.atime(*updateTimes.atime());
+    if (updateTimes.mtime())
+        pendingTimes.mtime(*updateTimes.mtime());
+    if (updateTimes.ctime())
+        pendingTimes.ctime(*updateTimes.ctime());
+}
+
+folly::Optional<messages::fuse::UpdateTimes> FsLogic::takePendingTimes(
+    const folly::fbstring &uuid)
+{
+    auto it = m_pendingTimes.find(uuid);
+    if (it == m_pendingTimes.end())
+        return {};
+
+    it->second.cancelFlush();
+    auto updateTimes = std::move(it->second.updateTimes);
+    m_pendingTimes.erase(it);
+
+    return updateTimes;
+}
+
+void FsLogic::flushTimes(const folly::fbstring &uuid)
+{
+    auto updateTimes = takePendingTimes(uuid);
+    if (!updateTimes)
+        return;
+
+    LOG_DBG(1) << "Flushing coalesced times update for " << uuid;
+
+    communicate(std::move(*updateTimes), m_providerTimeout);
+}
+
+IOEvents &FsLogic::accountedIO(const folly::fbstring &uuid,
+    const std::shared_ptr<FuseFileHandle> &fuseFileHandle)
+{
+    auto &ioEvents = fuseFileHandle->ioEvents();
+    if (ioEvents && ioEvents->uuid != uuid)
+        flushIOEvents(fuseFileHandle);
+
+    if (!ioEvents) {
+        ioEvents.emplace();
+        ioEvents->uuid = uuid;
+        ioEvents->cancelFlush = m_context->scheduler()->schedule(
+            IO_EVENTS_FLUSH_DELAY,
+            [ this, weakHandle = std::weak_ptr<FuseFileHandle>{
+                        fuseFileHandle} ] {
+                m_runInFiber([this, weakHandle] {
+                    if (auto handle = weakHandle.lock())
+                        flushIOEvents(handle);
+                });
+            });
+    }
+
+    return *ioEvents;
+}
+
+void FsLogic::flushIOEventsIfFull(
+    const std::shared_ptr<FuseFileHandle> &fuseFileHandle)
+{
+    const auto &ioEvents = fuseFileHandle->ioEvents();
+    if (ioEvents &&
+        (ioEvents->read.counter + ioEvents->written.counter >=
+                IO_EVENTS_MAX_OPERATIONS ||
+            ioEvents->read.extents.size() + ioEvents->written.extents.size() >=
+                IO_EVENTS_MAX_EXTENTS))
+        flushIOEvents(fuseFileHandle);
+}
+
+void FsLogic::flushIOEvents(
+    const std::shared_ptr<FuseFileHandle> &fuseFileHandle)
+{
+    auto &ioEvents = fuseFileHandle->ioEvents();
+    if (!ioEvents)
+        return;
+
+    auto pending = std::move(*ioEvents);
+    ioEvents.clear();
+    pending.cancelFlush();
+
+    const auto uuid = pending.uuid.toStdString();
+
+    if (!pending.read.empty())
+        m_eventManager.emit<events::FileRead>(uuid, pending.read.counter,
+            pending.read.bytes, toFileBlocks<events::FileRead>(pending.read));
+
+    if (!pending.written.empty())
+        m_eventManager.emit<events::FileWritten>(uuid, pending.written.counter,
+            pending.written.bytes,
+            toFileBlocks<events::FileWritten>(pending.written));
+}
+
+void FsLogic::flushIOEvents(const folly::fbstring &uuid)
+{
+    for (auto &fuseFileHandle : m_fuseFileHandles) {
+        const auto &ioEvents = fuseFileHandle.second->ioEvents();
+        if (ioEvents && ioEvents->uuid == uuid)
+            flushIOEvents(fuseFileHandle.second);
+    }
+}
+
+std::size_t FsLogic::writeToStorage(const folly::fbstring &uuid,
+    std::shared_ptr<FuseFileHandle> fuseFileHandle, const off_t offset,
+    folly::IOBufQueue buf)
+{
+    LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(offset)
+                << LOG_FARG(buf.chainLength());
+
     auto attr = m_metadataCache.getAttr(uuid);
     auto spaceId = m_metadataCache.getSpaceId(uuid);
 
@@ -483,9 +1427,22 @@ std::size_t FsLogic::write(const folly::fbstring &uuid,
         auto helperHandle = fuseFileHandle->getHelperHandle(
             uuid, spaceId, fileBlock.storageId(), fileBlock.fileId());
 
-        bytesWritten =
-            communication::wait(helperHandle->write(offset, std::move(buf)),
+        auto queueSlot =
+            m_helpersCache->acquireQueueSlot(fileBlock.storageId());
+        const auto writeStart = std::chrono::steady_clock::now();
+
+        if (m_writeStripeSize > 0 && buf.chainLength() > m_writeStripeSize)
+            bytesWritten = writeStripes(helperHandle, offset, buf);
+        else
+            bytesWritten = communication::wait(
+                helperHandle->write(offset, std::move(buf)),
                 helperHandle->timeout());
+
+        queueSlot.release();
+
+        m_helpersCache->recordIO(fileBlock.storageId(),
+            fuseFileHandle->proxyIO(helperHandle), bytesWritten,
+            std::chrono::steady_clock::now() - writeStart);
     }
     catch (const std::system_error &e) {
         if (e.code().value() != EPERM && e.code().value() != EACCES) {
@@ -503,16 +1460,18 @@ std::size_t FsLogic::write(const folly::fbstring &uuid,
         LOG_DBG(1) << "Adding file " << uuid
                    << " to force proxy cache after direct read failed";
 
-        m_forceProxyIOCache.add(uuid);
+        forceProxyIO(uuid, fuseFileHandle->flags());
 
         LOG_DBG(1) << "Writing requested block for " << uuid
                    << " via proxy fallback";
 
-        return write(uuid, fuseFileHandleId, offset, std::move(buf));
+        return writeToStorage(uuid, fuseFileHandle, offset, std::move(buf));
     }
 
-    m_eventManager.emit<events::FileWritten>(uuid.toStdString(), offset,
-        bytesWritten, fileBlock.storageId(), fileBlock.fileId());
+    accountedIO(uuid, fuseFileHandle)
+        .written.add(offset, bytesWritten, fileBlock.storageId(),
+            fileBlock.fileId());
+    flushIOEventsIfFull(fuseFileHandle);
 
     auto writtenRange = boost::icl::discrete_interval<off_t>::right_open(
         offset, offset + bytesWritten);
@@ -526,20 +1485,101 @@ std::size_t FsLogic::write(const folly::fbstring &uuid,
     return bytesWritten;
 }
 
+std::size_t FsLogic::writeStripes(helpers::FileHandlePtr helperHandle,
+    const off_t offset, const folly::IOBufQueue &buf)
+{
+    LOG_FCALL() << LOG_FARG(offset) << LOG_FARG(buf.chainLength());
+
+    // Stripes share the memory of the original buffer, so that it stays
+    // intact for a possible proxy fallback
+    folly::fbvector<std::pair<off_t, std::size_t>> stripes;
+    folly::fbvector<folly::Future<std::size_t>> stripeFutures;
+    folly::io::Cursor cursor{buf.front()};
+
+    std::size_t bytesWritten = 0;
+    bool continuous = true;
+    std::exception_ptr stripeException;
+
+    auto waitForStripe = [&](const std::size_t i) {
+        try {
+            const auto stripeWritten = communication::wait(
+                stripeFutures[i], helperHandle->timeout());
+
+            // Only the continuous prefix of written data is reported back,
+            // the rest will be rewritten by the caller
+            if (continuous)
+                bytesWritten += stripeWritten;
+            continuous = continuous && stripeWritten == stripes[i].second;
+        }
+        catch (...) {
+            continuous = false;
+            if (!stripeException)
+                stripeException = std::current_exception();
+        }
+    };
+
+    std::size_t completed = 0;
+    for (off_t stripeOffset = offset; !cursor.isAtEnd() && !stripeException;
+         stripeOffset += m_writeStripeSize) {
+        if (stripeFutures.size() - completed == m_writeStripeCount)
+            waitForStripe(completed++);
+
+        if (stripeException)
+            break;
+
+        std::unique_ptr<folly::IOBuf> stripeBuf;
+        const auto stripeSize =
+            cursor.cloneAtMost(stripeBuf, m_writeStripeSize);
+
+        folly::IOBufQueue stripe{folly::IOBufQueue::cacheChainLength()};
+        stripe.append(std::move(stripeBuf));
+
+        LOG_DBG(2) << "Writing stripe of " << stripeSize << " bytes at offset "
+                   << stripeOffset;
+
+        stripes.emplace_back(stripeOffset, stripeSize);
+        stripeFutures.emplace_back(
+            helperHandle->write(stripeOffset, std::move(stripe)));
+    }
+
+    while (completed < stripeFutures.size())
+        waitForStripe(completed++);
+
+    ONE_METRIC_COUNTER_ADD(
+        "comp.oneclient.mod.fuse.write_stripes", stripeFutures.size());
+
+    if (bytesWritten == 0 && stripeException)
+        std::rethrow_exception(stripeException);
+
+    return bytesWritten;
+}
+
 FileAttrPtr FsLogic::mkdir(const folly::fbstring &parentUuid,
     const folly::fbstring &name, const mode_t mode)
 {
     LOG_FCALL() << LOG_FARG(parentUuid) << LOG_FARG(name) << LOG_FARG(mode);
 
-    // TODO: CreateDir should probably also return attrs
-    communicate(messages::fuse::CreateDir{parentUuid.toStdString(),
-                    name.toStdString(), mode},
-        m_providerTimeout);
+    messages::fuse::CreateDir msg{
+        parentUuid.toStdString(), name.toStdString(), mode};
+
+    if (!m_compoundFileRequests) {
+        communicate(std::move(msg), m_providerTimeout);
 
-    LOG_DBG(1) << "Created directory " << name << " in " << parentUuid;
+        LOG_DBG(1) << "Created directory " << name << " in " << parentUuid;
 
-    // TODO: Provider returns uuid of the created dir, no need for lookup
-    return m_metadataCache.getAttr(parentUuid, name);
+        return m_metadataCache.getAttr(parentUuid, name);
+    }
+
+    auto attr = communicate<FileAttr>(std::move(msg), m_providerTimeout);
+    auto sharedAttr = std::make_shared<FileAttr>(std::move(attr));
+    m_metadataCache.putAttr(sharedAttr);
+
+    m_readdirCache->invalidate(parentUuid);
+
+    LOG_DBG(1) << "Created directory " << name << " in " << parentUuid
+               << " with uuid " << sharedAttr->uuid();
+
+    return sharedAttr;
 }
 
 FileAttrPtr FsLogic::mknod(const folly::fbstring &parentUuid,
@@ -583,7 +1623,7 @@ std::pair<FileAttrPtr, std::uint64_t> FsLogic::create(
     m_fuseFileHandles.emplace(fuseFileHandleId,
         std::make_shared<FuseFileHandle>(flags, created.handleId(),
             openFileToken, *m_helpersCache, m_forceProxyIOCache,
-            m_providerTimeout));
+            m_helperHandleRegistry, m_providerTimeout));
 
     LOG_DBG(1) << "Created file " << name << " in " << parentUuid
                << " with uuid " << uuid;
@@ -598,17 +1638,30 @@ void FsLogic::unlink(
 {
     LOG_FCALL() << LOG_FARG(parentUuid) << LOG_FARG(name);
 
-    // TODO: directly order provider to delete {parentUuid, name}
-    auto attr = m_metadataCache.getAttr(parentUuid, name);
-    communicate(messages::fuse::DeleteFile{attr->uuid().toStdString()},
-        m_providerTimeout);
+    folly::fbstring uuid;
+    if (m_compoundFileRequests) {
+        auto attr = communicate<FileAttr>(
+            messages::fuse::DeleteChild{
+                parentUuid.toStdString(), name.toStdString()},
+            m_providerTimeout);
+        uuid = attr.uuid();
+    }
+    else {
+        uuid = m_metadataCache.getAttr(parentUuid, name)->uuid();
+        communicate(
+            messages::fuse::DeleteFile{uuid.toStdString()}, m_providerTimeout);
+    }
+
+    // Files which are not cached may still be known to upper layers
+    if (!m_metadataCache.markDeleted(uuid))
+        m_onMarkDeleted(uuid);
 
-    m_metadataCache.markDeleted(attr->uuid());
+    takePendingTimes(uuid);
 
     m_readdirCache->invalidate(parentUuid);
 
     LOG_DBG(1) << "Deleted file " << name << " in " << parentUuid
-               << " with uuid " << attr->uuid();
+               << " with uuid " << uuid;
 }
 
 void FsLogic::rename(const folly::fbstring &parentUuid,
@@ -618,16 +1671,57 @@ void FsLogic::rename(const folly::fbstring &parentUuid,
     LOG_FCALL() << LOG_FARG(parentUuid) << LOG_FARG(name)
                 << LOG_FARG(newParentUuid) << LOG_FARG(newName);
 
-    // TODO: directly order provider to rename {parentUuid, name}
-    auto attr = m_metadataCache.getAttr(parentUuid, name);
-    auto oldUuid = attr->uuid();
+    folly::fbstring oldUuid;
+    auto renamed = [&] {
+        if (m_compoundFileRequests) {
+            auto result = communicate<messages::fuse::FileRenamed>(
+                messages::fuse::RenameChild{parentUuid.toStdString(),
+                    name.toStdString(), newParentUuid.toStdString(),
+                    newName.toStdString()},
+                m_providerTimeout);
+            oldUuid = result.oldUuid();
+            return result;
+        }
 
-    auto renamed = communicate<messages::fuse::FileRenamed>(
-        messages::fuse::Rename{oldUuid.toStdString(),
-            newParentUuid.toStdString(), newName.toStdString()},
-        m_providerTimeout);
+        oldUuid = m_metadataCache.getAttr(parentUuid, name)->uuid();
+        flushTimes(oldUuid);
+
+        return communicate<messages::fuse::FileRenamed>(
+            messages::fuse::Rename{oldUuid.toStdString(),
+                newParentUuid.toStdString(), newName.toStdString()},
+            m_providerTimeout);
+    }();
 
-    m_metadataCache.rename(oldUuid, newParentUuid, newName, renamed.newUuid());
+    const folly::fbstring newUuid{renamed.newUuid()};
+
+    if (oldUuid.empty()) {
+        // Without the old uuid the renamed file can't be followed in the
+        // caches, so only the directory listings are refreshed
+        LOG(WARNING) << "Provider did not return old uuid of file " << name
+                     << " renamed in " << parentUuid;
+        m_readdirCache->invalidate(parentUuid);
+        m_readdirCache->invalidate(newParentUuid);
+    }
+    // Files which are not cached may still be known to upper layers
+    else if (!m_metadataCache.rename(
+                 oldUuid, newParentUuid, newName, newUuid) &&
+        oldUuid != newUuid)
+        m_onRename(oldUuid, newUuid);
+
+    // Times queued for write-back follow the file to its new uuid
+    auto pendingTimes = !oldUuid.empty() && oldUuid != newUuid
+        ? takePendingTimes(oldUuid)
+        : folly::none;
+    if (pendingTimes) {
+        messages::fuse::UpdateTimes updateTimes{newUuid.toStdString()};
+        if (pendingTimes->atime())
+            updateTimes.atime(*pendingTimes->atime());
+        if (pendingTimes->mtime())
+            updateTimes.mtime(*pendingTimes->mtime());
+        if (pendingTimes->ctime())
+            updateTimes.ctime(*pendingTimes->ctime());
+        queueTimesUpdate(newUuid, updateTimes);
+    }
 
     LOG_DBG(1) << "Renamed file " << name << " in " << parentUuid << " to "
                << newName << " in " << newParentUuid;
@@ -642,8 +1736,7 @@ FileAttrPtr FsLogic::setattr(
 {
     LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(toSet);
 
-    // TODO: this operation can be optimized with a single message to the
-    // provider
+    flushWriteBuffers(uuid);
 
     if (toSet & FUSE_SET_ATTR_UID || toSet & FUSE_SET_ATTR_GID) {
         LOG_DBG(1) << "Attempting to modify uid or gid attempted for " << uuid
@@ -651,34 +1744,6 @@ FileAttrPtr FsLogic::setattr(
         throw std::errc::operation_not_supported;
     }
 
-    if (toSet & FUSE_SET_ATTR_MODE) {
-        // ALLPERMS is a macro of sys/stat.h
-        const mode_t normalizedMode = attr.st_mode & ALLPERMS;
-
-        communicate(
-            messages::fuse::ChangeMode{uuid.toStdString(), normalizedMode},
-            m_providerTimeout);
-
-        m_metadataCache.changeMode(uuid, normalizedMode);
-
-        LOG_DBG(1) << "Changed mode of " << uuid << " to "
-                   << LOG_OCT(normalizedMode);
-    }
-
-    if (toSet & FUSE_SET_ATTR_SIZE) {
-        communicate(messages::fuse::Truncate{uuid.toStdString(), attr.st_size},
-            m_providerTimeout);
-        m_metadataCache.truncate(uuid, attr.st_size);
-        m_eventManager.emit<events::FileTruncated>(
-            uuid.toStdString(), attr.st_size);
-
-        LOG_DBG(1) << "Truncated file " << uuid << " to size " << attr.st_size
-                   << " via setattr";
-
-        ONE_METRIC_COUNTER_INC(
-            "comp.oneclient.mod.events.submod.emitted.truncate");
-    }
-
     messages::fuse::UpdateTimes updateTimes{uuid.toStdString()};
 
     const auto now = std::chrono::system_clock::now();
@@ -686,32 +1751,130 @@ FileAttrPtr FsLogic::setattr(
     if (toSet & FUSE_SET_ATTR_ATIME) {
         updateTimes.atime(
             std::chrono::system_clock::from_time_t(attr.st_atime));
-        LOG_DBG(1) << "Changed atime of " << uuid << " to " << attr.st_atime;
+        LOG_DBG(1) << "Changing atime of " << uuid << " to " << attr.st_atime;
     }
     if (toSet & FUSE_SET_ATTR_MTIME) {
         updateTimes.mtime(
             std::chrono::system_clock::from_time_t(attr.st_mtime));
-        LOG_DBG(1) << "Changed mtime of " << uuid << " to " << attr.st_atime;
+        LOG_DBG(1) << "Changing mtime of " << uuid << " to " << attr.st_mtime;
     }
 #if defined(FUSE_SET_ATTR_ATIME_NOW)
     if (toSet & FUSE_SET_ATTR_ATIME_NOW) {
         updateTimes.atime(now);
-        LOG_DBG(1) << "Changed atime of " << uuid << " to now";
+        LOG_DBG(1) << "Changing atime of " << uuid << " to now";
     }
 #endif
 #if defined(FUSE_SET_ATTR_MTIME_NOW)
     if (toSet & FUSE_SET_ATTR_MTIME_NOW) {
         updateTimes.mtime(now);
-        LOG_DBG(1) << "Changed mtime of " << uuid << " to now";
+        LOG_DBG(1) << "Changing mtime of " << uuid << " to now";
     }
 #endif
 
-    communicate(updateTimes, m_providerTimeout);
-    m_metadataCache.updateTimes(uuid, updateTimes);
+    const bool timesOnly =
+        !(toSet & FUSE_SET_ATTR_MODE) && !(toSet & FUSE_SET_ATTR_SIZE);
+
+    if (timesOnly && m_timesWriteBackDelay.count() > 0) {
+        // Make sure the attributes are cached, so that the local update is
+        // not lost before the provider is notified
+        auto cachedAttr = m_metadataCache.getAttr(uuid);
+        m_metadataCache.updateTimes(uuid, updateTimes);
+        queueTimesUpdate(uuid, updateTimes);
+        return cachedAttr;
+    }
+
+    // Times queued for write-back are sent along with this request, unless
+    // they are overridden by it
+    auto pendingTimes = takePendingTimes(uuid);
+    if (pendingTimes && pendingTimes->atime() && !updateTimes.atime())
+        updateTimes.atime(*pendingTimes->atime());
+    if (pendingTimes && pendingTimes->mtime() && !updateTimes.mtime())
+        updateTimes.mtime(*pendingTimes->mtime());
+
+    if (m_compoundFileRequests)
+        setAttrCompound(uuid, attr, toSet, updateTimes);
+    else
+        setAttrSeparately(uuid, attr, toSet, updateTimes);
+
+    if (toSet & FUSE_SET_ATTR_SIZE) {
+        // Writes accounted before the truncate must be aggregated before it
+        flushIOEvents(uuid);
+        m_eventManager.emit<events::FileTruncated>(
+            uuid.toStdString(), attr.st_size);
+
+        ONE_METRIC_COUNTER_INC(
+            "comp.oneclient.mod.events.submod.emitted.truncate");
+    }
 
     return m_metadataCache.getAttr(uuid);
 }
 
+void FsLogic::setAttrCompound(const folly::fbstring &uuid,
+    const struct stat &attr, const int toSet,
+    const messages::fuse::UpdateTimes &updateTimes)
+{
+    messages::fuse::SetAttr setAttr{uuid.toStdString()};
+
+    if (toSet & FUSE_SET_ATTR_MODE) {
+        // ALLPERMS is a macro of sys/stat.h
+        const mode_t normalizedMode = attr.st_mode & ALLPERMS;
+        setAttr.mode(normalizedMode);
+        LOG_DBG(1) << "Changing mode of " << uuid << " to "
+                   << LOG_OCT(normalizedMode);
+    }
+
+    if (toSet & FUSE_SET_ATTR_SIZE) {
+        setAttr.size(attr.st_size);
+        LOG_DBG(1) << "Truncating file " << uuid << " to size "
+                   << attr.st_size << " via setattr";
+    }
+
+    if (updateTimes.atime())
+        setAttr.atime(*updateTimes.atime());
+    if (updateTimes.mtime())
+        setAttr.mtime(*updateTimes.mtime());
+    if (updateTimes.ctime())
+        setAttr.ctime(*updateTimes.ctime());
+
+    // All requested changes are applied by the provider in a single round
+    // trip, which replies with the resulting attributes of the file.
+    auto newAttr = communicate<messages::fuse::FileAttr>(
+        std::move(setAttr), m_providerTimeout);
+
+    m_metadataCache.updateAttr(newAttr, true);
+}
+
+void FsLogic::setAttrSeparately(const folly::fbstring &uuid,
+    const struct stat &attr, const int toSet,
+    const messages::fuse::UpdateTimes &updateTimes)
+{
+    if (toSet & FUSE_SET_ATTR_MODE) {
+        // ALLPERMS is a macro of sys/stat.h
+        const mode_t normalizedMode = attr.st_mode & ALLPERMS;
+
+        communicate(
+            messages::fuse::ChangeMode{uuid.toStdString(), normalizedMode},
+            m_providerTimeout);
+
+        m_metadataCache.changeMode(uuid, normalizedMode);
+
+        LOG_DBG(1) << "Changed mode of " << uuid << " to "
+                   << LOG_OCT(normalizedMode);
+    }
+
+    if (toSet & FUSE_SET_ATTR_SIZE) {
+        communicate(messages::fuse::Truncate{uuid.toStdString(), attr.st_size},
+            m_providerTimeout);
+        m_metadataCache.truncate(uuid, attr.st_size);
+
+        LOG_DBG(1) << "Truncated file " << uuid << " to size " << attr.st_size
+                   << " via setattr";
+    }
+
+    communicate(updateTimes, m_providerTimeout);
+    m_metadataCache.updateTimes(uuid, updateTimes);
+}
+
 folly::fbstring FsLogic::getxattr(
     const folly::fbstring &uuid, const folly::fbstring &name)
 {
@@ -732,7 +1895,7 @@ folly::fbstring FsLogic::getxattr(
         return "\"" + m_metadataCache.getSpaceId(uuid) + "\"";
     }
     else if (name == ONE_XATTR("access_type")) {
-        auto accessType = m_helpersCache->getAccessType(
+        auto accessType = m_helpersCache->getSelectedAccessType(
             m_metadataCache.getDefaultBlock(uuid).storageId());
         if (accessType == cache::HelpersCache::AccessType::DIRECT)
             return "\"direct\"";
@@ -831,8 +1994,9 @@ folly::fbvector<folly::fbstring> FsLogic::listxattr(const folly::fbstring &uuid)
 template <typename SrvMsg, typename CliMsg>
 SrvMsg FsLogic::communicate(CliMsg &&msg, const std::chrono::seconds timeout)
 {
-    return communication::wait(m_context->communicator()->communicate<SrvMsg>(
-                                   std::forward<CliMsg>(msg)),
+    return communication::wait(
+        m_resilientCommunicator->communicate<SrvMsg>(
+            std::forward<CliMsg>(msg), timeout),
         timeout);
 }
 
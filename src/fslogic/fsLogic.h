@@ -8,25 +8,34 @@
 
 #pragma once
 
+#include "directIOReprober.h"
 #include "fuseFileHandle.h"
 
 #include "attrs.h"
 #include "cache/forceProxyIOCache.h"
+#include "cache/helperHandleRegistry.h"
 #include "cache/helpersCache.h"
 #include "cache/lruMetadataCache.h"
 #include "cache/readdirCache.h"
+#include "cache/smallFileCache.h"
 #include "events/events.h"
 #include "fsSubscriptions.h"
+#include "messages/fuse/fileOpened.h"
+#include "messages/fuse/updateTimes.h"
 
 #include <asio/buffer.hpp>
 #include <boost/icl/discrete_interval.hpp>
 #include <folly/FBString.h>
 #include <folly/FBVector.h>
 #include <folly/Function.h>
+#include <folly/futures/Future.h>
 #include <folly/io/IOBufQueue.h>
 
+#include <chrono>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -228,6 +237,34 @@ public:
      */
     bool isFullBlockReadForced() const { return m_forceFullblockRead; }
 
+    /**
+     * Sets a callback to be called when prefetched file data should be pushed
+     * into the kernel page cache.
+     * @param cb The callback function that takes file's uuid, offset and the
+     * data as parameters.
+     */
+    void onPageCacheStore(std::function<void(const folly::fbstring &,
+            const off_t, folly::IOBufQueue)>
+            cb)
+    {
+        m_onPageCacheStore = std::move(cb);
+    }
+
+    /**
+     * Sets a callback to be called when file data cached in the kernel page
+     * cache may be stale after a remote change of the file.
+     * @param cb The callback function that takes file's uuid as parameter.
+     */
+    void onPageCacheInvalidate(std::function<void(const folly::fbstring &)> cb)
+    {
+        m_onPageCacheInvalidate = std::move(cb);
+    }
+
+    /**
+     * Returns true if prefetched data is pushed into the kernel page cache.
+     */
+    bool isPageCacheEnabled() const { return m_pageCachePrefetchSize > 0; }
+
 private:
     template <typename SrvMsg = messages::fuse::FuseResponse, typename CliMsg>
     SrvMsg communicate(CliMsg &&msg, const std::chrono::seconds timeout);
@@ -245,6 +282,13 @@ private:
 
     folly::fbstring computeHash(const folly::IOBufQueue &buf);
 
+    void setAttrCompound(const folly::fbstring &uuid, const struct stat &attr,
+        const int toSet, const messages::fuse::UpdateTimes &updateTimes);
+
+    void setAttrSeparately(const folly::fbstring &uuid,
+        const struct stat &attr, const int toSet,
+        const messages::fuse::UpdateTimes &updateTimes);
+
     FileAttrPtr makeFile(const folly::fbstring &parentUuid,
         const folly::fbstring &name, const mode_t mode,
         const helpers::Flag flag);
@@ -258,29 +302,180 @@ private:
         const boost::icl::discrete_interval<off_t> possibleRange,
         const boost::icl::discrete_interval<off_t> availableRange);
 
+    std::size_t writeToStorage(const folly::fbstring &uuid,
+        std::shared_ptr<FuseFileHandle> fuseFileHandle, const off_t offset,
+        folly::IOBufQueue buf);
+
+    std::size_t writeStripes(helpers::FileHandlePtr helperHandle,
+        const off_t offset, const folly::IOBufQueue &buf);
+
+    void flushWriteBuffer(const std::uint64_t fuseFileHandleId,
+        std::shared_ptr<FuseFileHandle> fuseFileHandle);
+
+    void restoreWriteBuffer(const std::uint64_t fuseFileHandleId,
+        FuseFileHandle &fuseFileHandle, WriteBuffer buffer);
+
+    void waitForWriteBufferFlush(FuseFileHandle &fuseFileHandle);
+
+    void flushWriteBuffers(const folly::fbstring &uuid,
+        const boost::icl::discrete_interval<off_t> &range =
+            boost::icl::discrete_interval<off_t>::right_open(
+                0, std::numeric_limits<off_t>::max()));
+
+    void waitForAll(folly::fbvector<folly::Future<folly::Unit>> futures,
+        const std::chrono::milliseconds timeout);
+
+    void releaseInBackground(const folly::fbstring &uuid,
+        std::shared_ptr<FuseFileHandle> fuseFileHandle);
+
+    void deferReleaseError(
+        const folly::fbstring &uuid, std::exception_ptr releaseException);
+
+    void rethrowDeferredReleaseError(const folly::fbstring &uuid);
+
+    void openDefaultHelperHandle(const folly::fbstring &uuid,
+        std::shared_ptr<FuseFileHandle> fuseFileHandle);
+
+    bool cacheInlineData(
+        const folly::fbstring &uuid, const messages::fuse::FileOpened &opened);
+
+    bool poolHandle(const folly::fbstring &uuid,
+        std::shared_ptr<FuseFileHandle> fuseFileHandle);
+
+    std::shared_ptr<FuseFileHandle> takePooledHandle(
+        const folly::fbstring &uuid, const int flags);
+
+    void evictPooledHandles(const folly::fbstring &uuid);
+
+    void forceProxyIO(const folly::fbstring &uuid, const int flags);
+
+    bool reprobeDirectIO(const folly::fbstring &uuid, const int flags);
+
+    void queueTimesUpdate(const folly::fbstring &uuid,
+        const messages::fuse::UpdateTimes &updateTimes);
+
+    folly::Optional<messages::fuse::UpdateTimes> takePendingTimes(
+        const folly::fbstring &uuid);
+
+    void flushTimes(const folly::fbstring &uuid);
+
+    IOEvents &accountedIO(const folly::fbstring &uuid,
+        const std::shared_ptr<FuseFileHandle> &fuseFileHandle);
+
+    void flushIOEventsIfFull(
+        const std::shared_ptr<FuseFileHandle> &fuseFileHandle);
+
+    void flushIOEvents(const std::shared_ptr<FuseFileHandle> &fuseFileHandle);
+
+    void flushIOEvents(const folly::fbstring &uuid);
+
+    void storeInPageCache(std::shared_ptr<FuseFileHandle> fuseFileHandle,
+        helpers::FileHandlePtr helperHandle, const off_t offset,
+        const std::size_t size, const folly::fbstring &uuid,
+        const boost::icl::discrete_interval<off_t> availableRange);
+
     std::shared_ptr<Context> m_context;
     events::Manager m_eventManager{m_context};
     cache::LRUMetadataCache m_metadataCache;
     cache::ForceProxyIOCache m_forceProxyIOCache;
+    cache::HelperHandleRegistry m_helperHandleRegistry;
     std::unique_ptr<cache::HelpersCache> m_helpersCache;
     std::shared_ptr<cache::ReaddirCache> m_readdirCache;
+    std::shared_ptr<ResilientCommunicator> m_resilientCommunicator;
     bool m_readEventsDisabled = false;
 
     // Determines whether the read requests should return full requested
     // size, or can return partial byte range if it is immediately
     // available
     bool m_forceFullblockRead;
+
+    // Determines whether requests missing from older providers, applying
+    // a number of changes in a single round trip, are sent
+    const bool m_compoundFileRequests;
+
+    // Maximum number of bytes pushed into the kernel page cache ahead of
+    // a reader, and the number of bytes currently being read for that purpose
+    const std::size_t m_pageCachePrefetchSize;
+    std::size_t m_pageCacheStoreInFlight = 0;
+
+    // Maximum size of writes coalesced in a single handle and the maximum
+    // period for which they're kept there
+    const std::size_t m_writeBehindBufferSize;
+    const std::chrono::seconds m_writeBehindFlushDelay;
+
+    // Size of stripes into which large writes are cut and the maximum number
+    // of stripes written to storage in parallel
+    const std::size_t m_writeStripeSize;
+    const std::size_t m_writeStripeCount;
+
+    // Times updated locally and not yet sent to the provider, together with
+    // a function cancelling their scheduled write-back
+    struct PendingTimes {
+        PendingTimes(const folly::fbstring &uuid)
+            : updateTimes{uuid.toStdString()}
+        {
+        }
+
+        messages::fuse::UpdateTimes updateTimes;
+        std::function<void()> cancelFlush;
+    };
+
+    // Maximum period for which updated times are kept locally before they
+    // are sent to the provider (0 sends them synchronously)
+    const std::chrono::seconds m_timesWriteBackDelay;
+
+    // Determines whether release completes in background without an implicit
+    // fsync, in which case its errors are reported by a later fsync or flush
+    const bool m_fastRelease;
+
+    // Released handles kept open for reuse by a subsequent open of the same
+    // file with the same flags, until they stay idle for too long
+    struct PooledHandle {
+        std::shared_ptr<FuseFileHandle> handle;
+        std::uint64_t sequence = 0;
+        std::function<void()> cancelExpiry = [] {};
+    };
+
+    const std::size_t m_handlePoolSize;
+    const std::chrono::seconds m_handlePoolIdleTimeout;
+
+    // Maximum size of a file read-only opened whose contents are requested
+    // inline with the response to open and served from memory
+    const std::size_t m_smallFileInlineSize;
+    cache::SmallFileCache m_smallFileCache;
+
+    DirectIOReprober m_directIOReprober;
+
     FsSubscriptions m_fsSubscriptions;
     std::unordered_set<folly::fbstring> m_disabledSpaces;
 
     std::unordered_map<std::uint64_t, std::shared_ptr<FuseFileHandle>>
         m_fuseFileHandles;
     std::unordered_map<std::uint64_t, folly::fbstring> m_fuseDirectoryHandles;
+    std::unordered_set<std::uint64_t> m_writeBufferedHandles;
+    std::unordered_map<folly::fbstring, PendingTimes> m_pendingTimes;
+
+    // Errors of background releases, returned by the next flush or fsync of
+    // the file unless they expire or are evicted first
+    struct DeferredReleaseError {
+        std::exception_ptr exception;
+        std::chrono::steady_clock::time_point expiresAt;
+    };
+
+    std::unordered_map<folly::fbstring, DeferredReleaseError>
+        m_deferredReleaseErrors;
+    std::unordered_map<std::tuple<folly::fbstring, int>, PooledHandle>
+        m_handlePool;
+    std::uint64_t m_nextPooledHandleSequence = 0;
     std::uint64_t m_nextFuseHandleId = 0;
 
     std::function<void(const folly::fbstring &)> m_onMarkDeleted = [](auto) {};
     std::function<void(const folly::fbstring &, const folly::fbstring &)>
         m_onRename = [](auto, auto) {};
+    std::function<void(const folly::fbstring &, const off_t, folly::IOBufQueue)>
+        m_onPageCacheStore = [](auto, auto, auto) {};
+    std::function<void(const folly::fbstring &)> m_onPageCacheInvalidate =
+        [](auto) {};
 
     const std::chrono::seconds m_providerTimeout;
     std::function<void(folly::Function<void()>)> m_runInFiber;
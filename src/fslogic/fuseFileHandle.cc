@@ -9,9 +9,12 @@
 #include "fuseFileHandle.h"
 
 #include "cache/forceProxyIOCache.h"
+#include "cache/helperHandleRegistry.h"
 #include "cache/helpersCache.h"
 #include "logging.h"
 
+#include <mutex>
+
 namespace one {
 namespace client {
 namespace fslogic {
@@ -20,12 +23,14 @@ FuseFileHandle::FuseFileHandle(const int flags_, folly::fbstring handleId,
     std::shared_ptr<cache::LRUMetadataCache::OpenFileToken> openFileToken,
     cache::HelpersCache &helpersCache,
     cache::ForceProxyIOCache &forceProxyIOCache,
+    cache::HelperHandleRegistry &helperHandleRegistry,
     const std::chrono::seconds providerTimeout)
     : m_flags{flags_}
     , m_handleId{std::move(handleId)}
     , m_openFileToken{std::move(openFileToken)}
     , m_helpersCache{helpersCache}
     , m_forceProxyIOCache{forceProxyIOCache}
+    , m_helperHandleRegistry{helperHandleRegistry}
     , m_providerTimeout{std::move(providerTimeout)}
 {
 }
@@ -36,22 +41,67 @@ helpers::FileHandlePtr FuseFileHandle::getHelperHandle(
 {
     LOG_FCALL() << LOG_FARG(uuid) << LOG_FARG(storageId) << LOG_FARG(fileId);
 
-    const bool forceProxyIO = m_forceProxyIOCache.contains(uuid);
+    // The IO path chosen by adaptive selection is kept for the lifetime of
+    // this handle, so that it never reads and writes through both paths
+    const auto pathKey = std::make_tuple(storageId, fileId);
+    auto selectedIt = m_selectedProxyIO.find(pathKey);
+    if (selectedIt == m_selectedProxyIO.end()) {
+        selectedIt = m_selectedProxyIO
+                         .emplace(pathKey,
+                             m_helpersCache.selectProxyIO(storageId))
+                         .first;
+    }
+
+    const bool forceProxyIO =
+        m_forceProxyIOCache.contains(uuid) || selectedIt->second;
     const auto key = std::make_tuple(storageId, fileId, forceProxyIO);
 
     auto it = m_handles.find(key);
     if (it != m_handles.end())
         return it->second;
 
-    auto helper = m_helpersCache.get(uuid, spaceId, storageId, forceProxyIO);
-    const auto filteredFlags = m_flags & (~O_CREAT) & (~O_APPEND);
-
-    auto handle = communication::wait(
-        helper->open(fileId, filteredFlags, makeParameters(uuid)),
-        m_providerTimeout);
+    // Join an open of the same helper handle which is already in progress
+    // instead of opening the file on storage twice
+    auto pendingIt = m_pendingHandles.find(key);
+    if (pendingIt != m_pendingHandles.end()) {
+        auto pending = pendingIt->second;
+        return communication::wait(pending->getFuture(), m_providerTimeout);
+    }
 
-    m_handles[key] = handle;
-    return handle;
+    auto pending =
+        std::make_shared<folly::SharedPromise<helpers::FileHandlePtr>>();
+    m_pendingHandles.emplace(key, pending);
+
+    try {
+        // Until the storage is detected a proxy helper is returned even if
+        // proxy IO is not forced, so the helper has to be checked itself
+        auto helper =
+            m_helpersCache.get(uuid, spaceId, storageId, forceProxyIO);
+        const bool direct =
+            !forceProxyIO && m_helpersCache.isDirectHelper(storageId, helper);
+
+        auto open = [=] {
+            return helper->open(fileId, helperFlags(), makeParameters(uuid));
+        };
+
+        auto handle = shared(direct)
+            ? acquireSharedHandle(registryKey(storageId, fileId, direct), open)
+            : communication::wait(open(), m_providerTimeout);
+
+        if (direct)
+            m_directHandles.emplace(handle);
+
+        m_handles[key] = handle;
+        m_pendingHandles.erase(key);
+        pending->setValue(handle);
+        return handle;
+    }
+    catch (...) {
+        m_pendingHandles.erase(key);
+        pending->setException(
+            folly::exception_wrapper{std::current_exception()});
+        throw;
+    }
 }
 
 void FuseFileHandle::releaseHelperHandle(const folly::fbstring &uuid,
@@ -63,12 +113,118 @@ void FuseFileHandle::releaseHelperHandle(const folly::fbstring &uuid,
         const auto key = std::make_tuple(storageId, fileId, forceProxyIO);
         auto it = m_handles.find(key);
         if (it != m_handles.end()) {
-            communication::wait(it->second->release(), m_providerTimeout);
+            // Other file handles sharing the helper handle keep using it,
+            // but it's no longer handed out to new opens
+            const bool direct = m_directHandles.count(it->second) > 0;
+            if (shared(direct))
+                m_helperHandleRegistry.invalidate(
+                    registryKey(storageId, fileId, direct), it->second);
+
+            communication::wait(
+                releaseHelperHandle(key, it->second), m_providerTimeout);
             m_handles.erase(key);
         }
     }
 }
 
+folly::fbvector<folly::Future<folly::Unit>>
+FuseFileHandle::releaseHelperHandles()
+{
+    folly::fbvector<folly::Future<folly::Unit>> releaseFutures;
+    for (auto &elem : m_handles)
+        releaseFutures.emplace_back(
+            releaseHelperHandle(elem.first, elem.second));
+
+    m_handles.clear();
+    m_directHandles.clear();
+    return releaseFutures;
+}
+
+folly::Future<folly::Unit> FuseFileHandle::releaseHelperHandle(
+    const std::tuple<folly::fbstring, folly::fbstring, bool> &key,
+    const helpers::FileHandlePtr &helperHandle)
+{
+    const auto &storageId = std::get<0>(key);
+    const auto &fileId = std::get<1>(key);
+    const bool direct = m_directHandles.erase(helperHandle) > 0;
+
+    // A helper handle still shared with other file handles is only flushed,
+    // so that data written through this handle reaches the storage on close
+    if (shared(direct) &&
+        !m_helperHandleRegistry.release(
+            registryKey(storageId, fileId, direct), helperHandle))
+        return helperHandle->flush();
+
+    return helperHandle->release();
+}
+
+helpers::FileHandlePtr FuseFileHandle::acquireSharedHandle(
+    const std::tuple<folly::fbstring, folly::fbstring, int, bool> &key,
+    std::function<folly::Future<helpers::FileHandlePtr>()> open)
+{
+    struct Acquisition {
+        std::mutex mutex;
+        bool abandoned = false;
+        helpers::FileHandlePtr handle;
+    };
+
+    // The registry counts the reference as soon as the handle is requested,
+    // so if waiting for it times out, the reference is dropped here or once
+    // the handle arrives
+    auto acquisition = std::make_shared<Acquisition>();
+    auto &registry = m_helperHandleRegistry;
+
+    auto onAcquired = [&registry, key, acquisition](
+                          helpers::FileHandlePtr handle) {
+        std::lock_guard<std::mutex> guard{acquisition->mutex};
+        if (!acquisition->abandoned)
+            acquisition->handle = handle;
+        else if (registry.release(key, handle))
+            handle->release();
+
+        return handle;
+    };
+
+    auto acquired = registry.acquire(key, std::move(open)).then(onAcquired);
+
+    try {
+        return communication::wait(std::move(acquired), m_providerTimeout);
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> guard{acquisition->mutex};
+        acquisition->abandoned = true;
+        if (acquisition->handle &&
+            registry.release(key, acquisition->handle))
+            acquisition->handle->release();
+
+        throw;
+    }
+}
+
+std::tuple<folly::fbstring, folly::fbstring, int, bool>
+FuseFileHandle::registryKey(const folly::fbstring &storageId,
+    const folly::fbstring &fileId, const bool direct) const
+{
+    return std::make_tuple(storageId, fileId, helperFlags(), !direct);
+}
+
+int FuseFileHandle::helperFlags() const
+{
+    return m_flags & (~O_CREAT) & (~O_APPEND);
+}
+
+bool FuseFileHandle::shared(const bool direct) const
+{
+    // Proxy IO handles are bound to the provider handle of the file handle
+    // which opened them, and truncating opens must reach the storage
+    return direct && !(helperFlags() & O_TRUNC);
+}
+
+bool FuseFileHandle::proxyIO(const helpers::FileHandlePtr &helperHandle) const
+{
+    return m_directHandles.count(helperHandle) == 0;
+}
+
 folly::fbvector<helpers::FileHandlePtr> FuseFileHandle::helperHandles() const
 {
     folly::fbvector<helpers::FileHandlePtr> result;
@@ -17,8 +17,17 @@
 #include <folly/Hash.h>
 #include <folly/Optional.h>
 #include <folly/futures/Future.h>
+#include <folly/futures/SharedPromise.h>
+#include <folly/io/IOBufQueue.h>
 
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 namespace one {
 namespace client {
@@ -26,10 +35,75 @@ namespace client {
 namespace cache {
 class HelpersCache;
 class ForceProxyIOCache;
+class HelperHandleRegistry;
 } // namespace cache
 
 namespace fslogic {
 
+/**
+ * Adjacent writes coalesced in a file handle which have not yet been passed to
+ * a storage helper.
+ */
+struct WriteBuffer {
+    folly::fbstring uuid;
+    off_t offset = 0;
+    folly::IOBufQueue data{folly::IOBufQueue::cacheChainLength()};
+    std::function<void()> cancelFlush = [] {};
+
+    off_t end() const { return offset + data.chainLength(); }
+};
+
+/**
+ * Ranges of a file read or written through a file handle, accumulated as
+ * a list of extents before being passed to the events manager as a single
+ * event. Sequential operations extend the last extent instead of adding
+ * new ones.
+ */
+struct IOExtents {
+    struct Extent {
+        off_t offset;
+        off_t end;
+        std::string storageId;
+        std::string fileId;
+    };
+
+    void add(const off_t offset, const std::size_t size,
+        const std::string &storageId = {}, const std::string &fileId = {})
+    {
+        ++counter;
+        bytes += size;
+
+        if (!extents.empty()) {
+            auto &last = extents.back();
+            if (last.end == offset && last.storageId == storageId &&
+                last.fileId == fileId) {
+                last.end += size;
+                return;
+            }
+        }
+
+        extents.push_back(Extent{
+            offset, static_cast<off_t>(offset + size), storageId, fileId});
+    }
+
+    bool empty() const { return counter == 0; }
+
+    std::size_t counter = 0;
+    std::size_t bytes = 0;
+    folly::fbvector<Extent> extents;
+};
+
+/**
+ * Read and write operations on a file handle which have not yet been
+ * passed to the events manager.
+ */
+struct IOEvents {
+    folly::fbstring uuid;
+    IOExtents read;
+    IOExtents written;
+    std::function<void()> cancelFlush = [] {};
+};
+
 /**
  * @c FuseFileHandle is responsible for storing information about open files.
  */
@@ -43,12 +117,15 @@ public:
      * @param helpersCache Cache from which helper objects can be fetched.
      * @param forceProxyIOCache Cache for determining whether ProxyIO is forced
      * for a file.
+     * @param helperHandleRegistry Registry of helper handles shared between
+     * file handles.
      * @param providerTimeout Timeout for provider connections.
      */
     FuseFileHandle(const int flags, folly::fbstring handleId,
         std::shared_ptr<cache::LRUMetadataCache::OpenFileToken> openFileToken,
         cache::HelpersCache &helpersCache,
         cache::ForceProxyIOCache &forceProxyIOCache,
+        cache::HelperHandleRegistry &helperHandleRegistry,
         std::chrono::seconds providerTimeout);
 
     /**
@@ -74,6 +151,19 @@ public:
     void releaseHelperHandle(const folly::fbstring &uuid,
         const folly::fbstring &storageId, const folly::fbstring &fileId);
 
+    /**
+     * Releases all helper handles open in this handle. Helper handles shared
+     * with other file handles are only flushed.
+     * @returns Futures of the release of each helper handle.
+     */
+    folly::fbvector<folly::Future<folly::Unit>> releaseHelperHandles();
+
+    /**
+     * @param helperHandle A helper handle open in this handle.
+     * @returns true if the helper handle was opened using proxy IO.
+     */
+    bool proxyIO(const helpers::FileHandlePtr &helperHandle) const;
+
     /**
      * @returns Open flags with which the handle was created.
      */
@@ -84,6 +174,17 @@ public:
      */
     folly::fbvector<helpers::FileHandlePtr> helperHandles() const;
 
+    /**
+     * Marks the handle as released, after which no new helper handles
+     * should be kept open in it.
+     */
+    void setReleased() { m_released = true; }
+
+    /**
+     * @returns true if the handle has been released.
+     */
+    bool released() const { return m_released; }
+
     /**
      * @returns A handleID representing the handle on the server.
      */
@@ -99,7 +200,74 @@ public:
         return m_lastPrefetch;
     };
 
+    void setPageCacheStoredUpTo(const off_t offset)
+    {
+        m_pageCacheStoredUpTo = offset;
+    }
+
+    /**
+     * @returns Offset up to which prefetched data has been pushed into the
+     * kernel page cache for this handle.
+     */
+    off_t pageCacheStoredUpTo() const { return m_pageCacheStoredUpTo; }
+
+    /**
+     * @returns Writes coalesced in this handle, if any.
+     */
+    folly::Optional<WriteBuffer> &writeBuffer() { return m_writeBuffer; }
+
+    /**
+     * @returns Promise fulfilled when the flush of coalesced writes which is
+     * in progress in this handle completes, if there is one.
+     */
+    std::shared_ptr<folly::SharedPromise<folly::Unit>> &writeBufferFlush()
+    {
+        return m_writeBufferFlush;
+    }
+
+    /**
+     * @returns Read and write operations accounted in this handle and not
+     * yet emitted, if any.
+     */
+    folly::Optional<IOEvents> &ioEvents() { return m_ioEvents; }
+
+    /**
+     * Stores an error of a write which has already been acknowledged, so that
+     * it can be reported on the next flush of the handle.
+     * @param error The error.
+     */
+    void setWriteBufferError(std::exception_ptr error)
+    {
+        if (!m_writeBufferError)
+            m_writeBufferError = std::move(error);
+    }
+
+    /**
+     * Rethrows and clears an error stored by @c setWriteBufferError .
+     */
+    void rethrowWriteBufferError()
+    {
+        if (m_writeBufferError)
+            std::rethrow_exception(std::exchange(m_writeBufferError, nullptr));
+    }
+
 private:
+    folly::Future<folly::Unit> releaseHelperHandle(
+        const std::tuple<folly::fbstring, folly::fbstring, bool> &key,
+        const helpers::FileHandlePtr &helperHandle);
+
+    helpers::FileHandlePtr acquireSharedHandle(
+        const std::tuple<folly::fbstring, folly::fbstring, int, bool> &key,
+        std::function<folly::Future<helpers::FileHandlePtr>()> open);
+
+    std::tuple<folly::fbstring, folly::fbstring, int, bool> registryKey(
+        const folly::fbstring &storageId, const folly::fbstring &fileId,
+        const bool direct) const;
+
+    int helperFlags() const;
+
+    bool shared(const bool direct) const;
+
     std::unordered_map<folly::fbstring, folly::fbstring> makeParameters(
         const folly::fbstring &uuid);
 
@@ -108,11 +276,25 @@ private:
     std::shared_ptr<cache::LRUMetadataCache::OpenFileToken> m_openFileToken;
     cache::HelpersCache &m_helpersCache;
     cache::ForceProxyIOCache &m_forceProxyIOCache;
+    cache::HelperHandleRegistry &m_helperHandleRegistry;
     std::unordered_map<std::tuple<folly::fbstring, folly::fbstring, bool>,
         helpers::FileHandlePtr>
         m_handles;
+    std::unordered_map<std::tuple<folly::fbstring, folly::fbstring, bool>,
+        std::shared_ptr<folly::SharedPromise<helpers::FileHandlePtr>>>
+        m_pendingHandles;
+    // Helper handles opened by a direct helper, as opposed to proxy IO
+    std::unordered_set<helpers::FileHandlePtr> m_directHandles;
+    std::unordered_map<std::tuple<folly::fbstring, folly::fbstring>, bool>
+        m_selectedProxyIO;
     const std::chrono::seconds m_providerTimeout;
     boost::icl::discrete_interval<off_t> m_lastPrefetch;
+    off_t m_pageCacheStoredUpTo = 0;
+    folly::Optional<WriteBuffer> m_writeBuffer;
+    std::shared_ptr<folly::SharedPromise<folly::Unit>> m_writeBufferFlush;
+    folly::Optional<IOEvents> m_ioEvents;
+    std::exception_ptr m_writeBufferError;
+    bool m_released = false;
 };
 
 } // namespace fslogic
@@ -117,6 +117,8 @@ public:
         return m_fsLogic.isFullBlockReadForced();
     }
 
+    bool isPageCacheEnabled() const { return m_fsLogic.isPageCacheEnabled(); }
+
     FsLogicT &fsLogic() { return m_fsLogic; }
 
 private:
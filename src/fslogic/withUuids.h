@@ -224,6 +224,33 @@ public:
         return m_fsLogic.isFullBlockReadForced();
     }
 
+    bool isPageCacheEnabled() const { return m_fsLogic.isPageCacheEnabled(); }
+
+    void onPageCacheStore(
+        std::function<void(const fuse_ino_t, const off_t, folly::IOBufQueue)>
+            cb)
+    {
+        m_fsLogic.onPageCacheStore([ this, cb = std::move(cb) ](
+            const folly::fbstring &uuid, const off_t offset,
+            folly::IOBufQueue buf) {
+            // Pages of inodes unknown to the kernel cannot be populated
+            auto ino = m_inodeCache.find(uuid);
+            if (ino)
+                cb(*ino, offset, std::move(buf));
+        });
+    }
+
+    void onPageCacheInvalidate(std::function<void(const fuse_ino_t)> cb)
+    {
+        m_fsLogic.onPageCacheInvalidate(
+            [ this, cb = std::move(cb) ](const folly::fbstring &uuid) {
+                // Inodes unknown to the kernel have no pages cached
+                auto ino = m_inodeCache.find(uuid);
+                if (ino)
+                    cb(*ino);
+            });
+    }
+
 private:
     template <typename Ret, typename... FunArgs, typename... Args>
     inline constexpr Ret wrap(
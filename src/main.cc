@@ -447,12 +447,48 @@ int main(int argc, char *argv[])
     auto helpersCache = std::make_unique<cache::HelpersCache>(
         *communicator, *context->scheduler(), *options);
 
+    auto scheduler = context->scheduler();
     const auto &rootUuid = configuration->rootUuid();
     fsLogic = std::make_unique<fslogic::Composite>(rootUuid, std::move(context),
         std::move(configuration), std::move(helpersCache),
         options->getMetadataCacheSize(), options->areFileReadEventsDisabled(),
         options->isFullblockReadForced(), options->getProviderTimeout());
 
+    if (fsLogic->isPageCacheEnabled()) {
+        fsLogic->fsLogic().onPageCacheStore([ch, scheduler](
+            const fuse_ino_t ino, const off_t offset, folly::IOBufQueue buf) {
+            // Storing data may block on pages locked by a pending FUSE read,
+            // so it must not be done on a thread that replies to requests
+            scheduler->post(
+                [ ch, ino, offset, buf = std::move(buf) ]() mutable {
+                    auto data = buf.move();
+                    data->coalesce();
+
+                    struct fuse_bufvec bufv = FUSE_BUFVEC_INIT(data->length());
+                    bufv.buf[0].mem = data->writableData();
+
+                    const auto res = fuse_lowlevel_notify_store(
+                        ch, ino, offset, &bufv, fuse_buf_copy_flags{});
+                    if (res != 0)
+                        LOG_DBG(1) << "Failed to store " << data->length()
+                                   << " bytes of inode " << ino
+                                   << " in page cache: " << res;
+                });
+        });
+
+        fsLogic->fsLogic().onPageCacheInvalidate(
+            [ch, scheduler](const fuse_ino_t ino) {
+                // Invalidation waits for locked pages just like storing
+                scheduler->post([ch, ino] {
+                    const auto res =
+                        fuse_lowlevel_notify_inval_inode(ch, ino, 0, 0);
+                    if (res != 0)
+                        LOG_DBG(1) << "Failed to invalidate page cache of "
+                                   << "inode " << ino << ": " << res;
+                });
+            });
+    }
+
     res = multithreaded ? fuse_session_loop_mt(fuse) : fuse_session_loop(fuse);
 
     communicator->stop();
@@ -0,0 +1,54 @@
+/**
+ * @file deleteChild.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "deleteChild.h"
+
+#include "messages.pb.h"
+
+#include <sstream>
+#include <system_error>
+
+namespace one {
+namespace messages {
+namespace fuse {
+
+DeleteChild::DeleteChild(std::string parentUuid, std::string name)
+    : FileRequest{std::move(parentUuid)}
+    , m_name{std::move(name)}
+    , m_silent{false}
+{
+}
+
+std::string DeleteChild::toString() const
+{
+    std::stringstream stream;
+    stream << "type: 'DeleteChild', uuid: " << m_contextGuid
+           << ", name: " << m_name << ", silent: " << m_silent;
+    return stream.str();
+}
+
+std::unique_ptr<ProtocolClientMessage> DeleteChild::serializeAndDestroy()
+{
+#if WITH_COMPOUND_FILE_REQUESTS
+    auto msg = FileRequest::serializeAndDestroy();
+    auto dc = msg->mutable_fuse_request()
+                  ->mutable_file_request()
+                  ->mutable_delete_child();
+
+    dc->mutable_name()->swap(m_name);
+    dc->set_silent(m_silent);
+
+    return msg;
+#else
+    throw std::errc::operation_not_supported;
+#endif
+}
+
+} // namespace fuse
+} // namespace messages
+} // namespace one
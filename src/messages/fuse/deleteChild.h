@@ -0,0 +1,49 @@
+/**
+ * @file deleteChild.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_MESSAGES_FUSE_DELETE_CHILD_H
+#define ONECLIENT_MESSAGES_FUSE_DELETE_CHILD_H
+
+#include "fileRequest.h"
+
+#include <string>
+
+namespace one {
+namespace messages {
+namespace fuse {
+
+/**
+ * The DeleteChild class represents a FUSE request for deletion of
+ * a directory's child identified by its name. The provider replies with
+ * attributes of the deleted file. The request can be serialized only when
+ * built with WITH_COMPOUND_FILE_REQUESTS, as it's missing from older clproto
+ * versions.
+ */
+class DeleteChild : public FileRequest {
+public:
+    /**
+     * Constructor.
+     * @param parentUuid UUID of the parent directory.
+     * @param name Name of the file to be deleted.
+     */
+    DeleteChild(std::string parentUuid, std::string name);
+
+    std::string toString() const override;
+
+private:
+    std::unique_ptr<ProtocolClientMessage> serializeAndDestroy() override;
+
+    std::string m_name;
+    bool m_silent;
+};
+
+} // namespace fuse
+} // namespace messages
+} // namespace one
+
+#endif // ONECLIENT_MESSAGES_FUSE_DELETE_CHILD_H
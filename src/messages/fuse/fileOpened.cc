@@ -28,15 +28,28 @@ FileOpened::FileOpened(std::unique_ptr<ProtocolServerMessage> serverMessage)
         serverMessage->mutable_fuse_response()->mutable_file_opened();
 
     fileOpened->mutable_handle_id()->swap(m_handleId);
+
+#if WITH_INLINE_FILE_DATA
+    if (fileOpened->has_inline_data())
+        m_inlineData = folly::fbstring{fileOpened->inline_data()};
+#endif
 }
 
 const std::string &FileOpened::handleId() const { return m_handleId; }
 
+const folly::Optional<folly::fbstring> &FileOpened::inlineData() const
+{
+    return m_inlineData;
+}
+
 std::string FileOpened::toString() const
 {
     std::stringstream stream;
     stream << "type: 'FileOpened', handleId: '" << m_handleId << "'";
 
+    if (m_inlineData)
+        stream << ", inlineData size: " << m_inlineData->size();
+
     return stream.str();
 }
 
@@ -11,6 +11,9 @@
 
 #include "fuseResponse.h"
 
+#include <folly/FBString.h>
+#include <folly/Optional.h>
+
 namespace one {
 namespace messages {
 namespace fuse {
@@ -33,10 +36,18 @@ public:
      */
     const std::string &handleId() const;
 
+    /**
+     * @return Whole contents of the file, if they were small enough to be
+     * sent inline with the response; always empty unless oneclient is built
+     * with WITH_INLINE_FILE_DATA.
+     */
+    const folly::Optional<folly::fbstring> &inlineData() const;
+
     std::string toString() const override;
 
 private:
     std::string m_handleId;
+    folly::Optional<folly::fbstring> m_inlineData;
 };
 
 } // namespace fuse
@@ -27,6 +27,11 @@ FileRenamed::FileRenamed(std::unique_ptr<ProtocolServerMessage> serverMessage)
     auto fileRenamed =
         serverMessage->mutable_fuse_response()->mutable_file_renamed();
 
+#if WITH_COMPOUND_FILE_REQUESTS
+    if (fileRenamed->has_old_uuid())
+        fileRenamed->mutable_old_uuid()->swap(m_oldUuid);
+#endif
+
     fileRenamed->mutable_new_uuid()->swap(m_newUuid);
 
     for (auto &childEntry : *fileRenamed->mutable_child_entries()) {
@@ -34,6 +39,8 @@ FileRenamed::FileRenamed(std::unique_ptr<ProtocolServerMessage> serverMessage)
     }
 }
 
+const std::string &FileRenamed::oldUuid() const { return m_oldUuid; }
+
 const std::string &FileRenamed::newUuid() const { return m_newUuid; }
 
 const std::vector<FileRenamedEntry> &FileRenamed::childEntries() const
@@ -44,7 +51,8 @@ const std::vector<FileRenamedEntry> &FileRenamed::childEntries() const
 std::string FileRenamed::toString() const
 {
     std::stringstream stream;
-    stream << "type: 'FileRenamed', new uuid: " << m_newUuid
+    stream << "type: 'FileRenamed', old uuid: " << m_oldUuid
+           << ", new uuid: " << m_newUuid
            << ", child entries: [";
 
     for (const auto &childEntry : m_childEntries)
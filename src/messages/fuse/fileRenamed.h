@@ -29,6 +29,12 @@ public:
      */
     FileRenamed(std::unique_ptr<ProtocolServerMessage> serverMessage);
 
+    /**
+     * @return UUID of renamed file before the rename. Empty if the rename was
+     * requested by file's UUID or the provider did not send it.
+     */
+    const std::string &oldUuid() const;
+
     /**
      * @return New UUID of renamed file.
      */
@@ -42,6 +48,7 @@ public:
     std::string toString() const override;
 
 private:
+    std::string m_oldUuid;
     std::string m_newUuid;
     std::vector<FileRenamedEntry> m_childEntries;
 };
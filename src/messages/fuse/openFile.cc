@@ -17,9 +17,11 @@ namespace one {
 namespace messages {
 namespace fuse {
 
-OpenFile::OpenFile(std::string uuid, const one::helpers::Flag flag)
+OpenFile::OpenFile(std::string uuid, const one::helpers::Flag flag,
+    const std::size_t inlineDataSizeLimit)
     : FileRequest{std::move(uuid)}
     , m_flag{flag}
+    , m_inlineDataSizeLimit{inlineDataSizeLimit}
 {
 }
 
@@ -36,6 +38,9 @@ std::string OpenFile::toString() const
     else
         stream << "rdwr";
 
+    if (m_inlineDataSizeLimit > 0)
+        stream << ", inlineDataSizeLimit: " << m_inlineDataSizeLimit;
+
     return stream.str();
 }
 
@@ -53,6 +58,11 @@ std::unique_ptr<ProtocolClientMessage> OpenFile::serializeAndDestroy()
     else
         of->set_flag(clproto::OpenFlag::READ_WRITE);
 
+#if WITH_INLINE_FILE_DATA
+    if (m_inlineDataSizeLimit > 0)
+        of->set_inline_data_size_limit(m_inlineDataSizeLimit);
+#endif
+
     return msg;
 }
 
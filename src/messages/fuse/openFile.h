@@ -30,8 +30,13 @@ public:
      * Constructor.
      * @param uuid UUID of the file to be opened.
      * @param flag Open flag.
+     * @param inlineDataSizeLimit Maximum size of a file whose contents should
+     * be sent inline with the response (0 if they should never be sent). It's
+     * only sent by oneclient built with WITH_INLINE_FILE_DATA, as it's missing
+     * from older clproto versions.
      */
-    OpenFile(std::string uuid, const one::helpers::Flag flag);
+    OpenFile(std::string uuid, const one::helpers::Flag flag,
+        const std::size_t inlineDataSizeLimit = 0);
 
     std::string toString() const override;
 
@@ -39,6 +44,7 @@ private:
     std::unique_ptr<ProtocolClientMessage> serializeAndDestroy() override;
 
     one::helpers::Flag m_flag;
+    std::size_t m_inlineDataSizeLimit;
 };
 
 } // namespace fuse
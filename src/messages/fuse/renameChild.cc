@@ -0,0 +1,59 @@
+/**
+ * @file renameChild.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "renameChild.h"
+
+#include "messages.pb.h"
+
+#include <sstream>
+#include <system_error>
+
+namespace one {
+namespace messages {
+namespace fuse {
+
+RenameChild::RenameChild(std::string parentUuid, std::string name,
+    std::string targetParentUuid, std::string targetName)
+    : FileRequest{std::move(parentUuid)}
+    , m_name{std::move(name)}
+    , m_targetParentUuid{std::move(targetParentUuid)}
+    , m_targetName{std::move(targetName)}
+{
+}
+
+std::string RenameChild::toString() const
+{
+    std::stringstream stream;
+    stream << "type: 'RenameChild', uuid: " << m_contextGuid
+           << ", name: " << m_name
+           << ", target parent uuid: " << m_targetParentUuid
+           << ", target name: " << m_targetName;
+    return stream.str();
+}
+
+std::unique_ptr<ProtocolClientMessage> RenameChild::serializeAndDestroy()
+{
+#if WITH_COMPOUND_FILE_REQUESTS
+    auto msg = FileRequest::serializeAndDestroy();
+    auto rnm = msg->mutable_fuse_request()
+                   ->mutable_file_request()
+                   ->mutable_rename_child();
+
+    rnm->mutable_name()->swap(m_name);
+    rnm->mutable_target_parent_uuid()->swap(m_targetParentUuid);
+    rnm->mutable_target_name()->swap(m_targetName);
+
+    return msg;
+#else
+    throw std::errc::operation_not_supported;
+#endif
+}
+
+} // namespace fuse
+} // namespace messages
+} // namespace one
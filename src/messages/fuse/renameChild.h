@@ -0,0 +1,52 @@
+/**
+ * @file renameChild.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_MESSAGES_FUSE_RENAME_CHILD_H
+#define ONECLIENT_MESSAGES_FUSE_RENAME_CHILD_H
+
+#include "fileRequest.h"
+
+#include <string>
+
+namespace one {
+namespace messages {
+namespace fuse {
+
+/**
+ * The RenameChild class represents a FUSE request for rename of a directory's
+ * child identified by its name. The request can be serialized only when built
+ * with WITH_COMPOUND_FILE_REQUESTS, as it's missing from older clproto
+ * versions.
+ */
+class RenameChild : public FileRequest {
+public:
+    /**
+     * Constructor.
+     * @param parentUuid UUID of the parent directory.
+     * @param name Name of the file to rename.
+     * @param targetParentUuid Uuid of the new parent.
+     * @param targetName New name of the file.
+     */
+    RenameChild(std::string parentUuid, std::string name,
+        std::string targetParentUuid, std::string targetName);
+
+    std::string toString() const override;
+
+private:
+    std::unique_ptr<ProtocolClientMessage> serializeAndDestroy() override;
+
+    std::string m_name;
+    std::string m_targetParentUuid;
+    std::string m_targetName;
+};
+
+} // namespace fuse
+} // namespace messages
+} // namespace one
+
+#endif // ONECLIENT_MESSAGES_FUSE_RENAME_CHILD_H
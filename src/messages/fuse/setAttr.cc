@@ -0,0 +1,70 @@
+/**
+ * @file setAttr.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "setAttr.h"
+
+#include "messages.pb.h"
+
+#include <sstream>
+#include <system_error>
+
+namespace one {
+namespace messages {
+namespace fuse {
+
+SetAttr::SetAttr(std::string uuid)
+    : FileRequest{std::move(uuid)}
+{
+}
+
+std::string SetAttr::toString() const
+{
+    std::stringstream stream;
+
+    stream << "type: 'SetAttr', uuid: " << m_contextGuid;
+    if (m_mode)
+        stream << ", mode: " << std::oct << *m_mode << std::dec;
+    if (m_size)
+        stream << ", size: " << *m_size;
+    if (m_atime)
+        stream << ", atime: " << std::chrono::system_clock::to_time_t(*m_atime);
+    if (m_mtime)
+        stream << ", mtime: " << std::chrono::system_clock::to_time_t(*m_mtime);
+    if (m_ctime)
+        stream << ", ctime: " << std::chrono::system_clock::to_time_t(*m_ctime);
+
+    return stream.str();
+}
+
+std::unique_ptr<ProtocolClientMessage> SetAttr::serializeAndDestroy()
+{
+#if WITH_COMPOUND_FILE_REQUESTS
+    auto msg = FileRequest::serializeAndDestroy();
+    auto sa =
+        msg->mutable_fuse_request()->mutable_file_request()->mutable_set_attr();
+
+    if (m_mode)
+        sa->set_mode(*m_mode);
+    if (m_size)
+        sa->set_size(*m_size);
+    if (m_atime)
+        sa->set_atime(std::chrono::system_clock::to_time_t(*m_atime));
+    if (m_mtime)
+        sa->set_mtime(std::chrono::system_clock::to_time_t(*m_mtime));
+    if (m_ctime)
+        sa->set_ctime(std::chrono::system_clock::to_time_t(*m_ctime));
+
+    return msg;
+#else
+    throw std::errc::operation_not_supported;
+#endif
+}
+
+} // namespace fuse
+} // namespace messages
+} // namespace one
@@ -0,0 +1,118 @@
+/**
+ * @file setAttr.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#ifndef ONECLIENT_MESSAGES_FUSE_SET_ATTR_H
+#define ONECLIENT_MESSAGES_FUSE_SET_ATTR_H
+
+#include "fileRequest.h"
+
+#include <folly/Optional.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <string>
+
+namespace one {
+namespace messages {
+namespace fuse {
+
+/**
+ * The SetAttr class represents a FUSE request for atomically changing
+ * a number of file attributes with a single round trip to the provider.
+ * The request can be serialized only when built with
+ * WITH_COMPOUND_FILE_REQUESTS, as it's missing from older clproto versions.
+ */
+class SetAttr : public FileRequest {
+public:
+    /**
+     * Constructor.
+     * @param uuid UUID of the file of which attributes are changed.
+     */
+    SetAttr(std::string uuid);
+
+    /**
+     * @return File's mode set.
+     */
+    folly::Optional<mode_t> mode() const { return m_mode; }
+
+    /**
+     * Requests changing the file's mode.
+     * @param mode The mode to set.
+     */
+    void mode(const mode_t mode) { m_mode = mode; }
+
+    /**
+     * @return File's size set.
+     */
+    folly::Optional<off_t> size() const { return m_size; }
+
+    /**
+     * Requests truncating the file.
+     * @param size The size to truncate to.
+     */
+    void size(const off_t size) { m_size = size; }
+
+    /**
+     * @return File's access time set.
+     */
+    folly::Optional<std::chrono::system_clock::time_point> atime() const
+    {
+        return m_atime;
+    }
+
+    /**
+     * Requests setting the file's access time.
+     * @param t The access time to set.
+     */
+    void atime(std::chrono::system_clock::time_point t) { m_atime = t; }
+
+    /**
+     * @return File's modification time set.
+     */
+    folly::Optional<std::chrono::system_clock::time_point> mtime() const
+    {
+        return m_mtime;
+    }
+
+    /**
+     * Requests setting the file's modification time.
+     * @param t The modification time to set.
+     */
+    void mtime(std::chrono::system_clock::time_point t) { m_mtime = t; }
+
+    /**
+     * @return File's change time set.
+     */
+    folly::Optional<std::chrono::system_clock::time_point> ctime() const
+    {
+        return m_ctime;
+    }
+
+    /**
+     * Requests setting the file's change time.
+     * @param t The change time to set.
+     */
+    void ctime(std::chrono::system_clock::time_point t) { m_ctime = t; }
+
+    std::string toString() const override;
+
+private:
+    std::unique_ptr<ProtocolClientMessage> serializeAndDestroy() override;
+
+    folly::Optional<mode_t> m_mode;
+    folly::Optional<off_t> m_size;
+    folly::Optional<std::chrono::system_clock::time_point> m_atime;
+    folly::Optional<std::chrono::system_clock::time_point> m_mtime;
+    folly::Optional<std::chrono::system_clock::time_point> m_ctime;
+};
+
+} // namespace fuse
+} // namespace messages
+} // namespace one
+
+#endif // ONECLIENT_MESSAGES_FUSE_SET_ATTR_H
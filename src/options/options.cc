@@ -182,6 +182,31 @@ Options::Options()
         .withGroup(OptionGroup::ADVANCED)
         .withDescription("Specify number of parallel storage helper threads.");
 
+    add<unsigned int>()
+        ->withLongName("storage-executor-thread-count")
+        .withConfigName("storage_executor_thread_count")
+        .withValueName("<threads>")
+        .withDefaultValue(DEFAULT_STORAGE_EXECUTOR_THREAD_COUNT,
+            std::to_string(DEFAULT_STORAGE_EXECUTOR_THREAD_COUNT))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify number of storage helper threads dedicated "
+                         "to each storage, so that a slow storage does not "
+                         "delay access to other storages (0 shares storage "
+                         "helper threads between all storages).");
+
+    add<unsigned int>()
+        ->withLongName("storage-executor-queue-depth")
+        .withConfigName("storage_executor_queue_depth")
+        .withValueName("<depth>")
+        .withDefaultValue(DEFAULT_STORAGE_EXECUTOR_QUEUE_DEPTH,
+            std::to_string(DEFAULT_STORAGE_EXECUTOR_QUEUE_DEPTH))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum number of reads and writes queued "
+                         "on storage helper threads dedicated to a storage "
+                         "at once, or on the shared storage helper threads "
+                         "if there are no dedicated ones (0 disables the "
+                         "limit).");
+
     add<bool>()
         ->asSwitch()
         .withLongName("no-buffer")
@@ -201,6 +226,58 @@ Options::Options()
         .withGroup(OptionGroup::ADVANCED)
         .withDescription("Specify Oneprovider connection timeout in seconds.");
 
+    add<unsigned int>()
+        ->withLongName("hedge-percentile")
+        .withConfigName("hedge_percentile")
+        .withValueName("<percentile>")
+        .withDefaultValue(
+            DEFAULT_HEDGE_PERCENTILE, std::to_string(DEFAULT_HEDGE_PERCENTILE))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify percentile of recent Oneprovider response "
+                         "times of each request type after which file "
+                         "attribute and location requests are sent again "
+                         "over another connection (0 disables resending).");
+
+    add<unsigned int>()
+        ->withLongName("circuit-breaker-failure-threshold")
+        .withConfigName("circuit_breaker_failure_threshold")
+        .withValueName("<count>")
+        .withDefaultValue(DEFAULT_CIRCUIT_BREAKER_FAILURE_THRESHOLD,
+            std::to_string(DEFAULT_CIRCUIT_BREAKER_FAILURE_THRESHOLD))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify number of consecutive Oneprovider request "
+                         "timeouts after which requests fail immediately "
+                         "until Oneprovider responds again (0 disables "
+                         "failing immediately).");
+
+    add<unsigned int>()
+        ->withLongName("circuit-breaker-reset-timeout")
+        .withConfigName("circuit_breaker_reset_timeout")
+        .withValueName("<timeout>")
+        .withDefaultValue(DEFAULT_CIRCUIT_BREAKER_RESET_TIMEOUT,
+            std::to_string(DEFAULT_CIRCUIT_BREAKER_RESET_TIMEOUT))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify time in seconds after which a Oneprovider "
+                         "request is tried again once requests started "
+                         "failing immediately.");
+
+    add<unsigned int>()
+        ->withLongName("subscription-batch-delay")
+        .withConfigName("subscription_batch_delay")
+        .withValueName("<delay>")
+        .withDefaultValue(DEFAULT_SUBSCRIPTION_BATCH_DELAY,
+            std::to_string(DEFAULT_SUBSCRIPTION_BATCH_DELAY))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify time in milliseconds for which changes of "
+                         "file event subscriptions are delayed before being "
+                         "sent to Oneprovider; a subscription cancelled "
+                         "within this time is never sent. Remote changes of "
+                         "a file made before its subscription is sent are "
+                         "not noticed, so its cached metadata can stay stale "
+                         "until evicted. Each subscription is still sent in "
+                         "a separate message, so a tree walk such as find "
+                         "barely benefits (0 sends changes immediately).");
+
     add<bool>()
         ->asSwitch()
         .withLongName("disable-read-events")
@@ -222,6 +299,19 @@ Options::Options()
             "data than request in case it is immediately available and "
             "consecutive blocks need to be prefetched from remote storage.");
 
+    add<bool>()
+        ->asSwitch()
+        .withLongName("compound-file-requests")
+        .withConfigName("compound_file_requests")
+        .withImplicitValue(true)
+        .withDefaultValue(false, "false")
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Apply all attribute changes of a setattr in a single "
+                         "Oneprovider request and address mkdir, unlink and "
+                         "rename by parent and name; requires a Oneprovider "
+                         "supporting it and oneclient built with "
+                         "WITH_COMPOUND_FILE_REQUESTS.");
+
     add<unsigned int>()
         ->withLongName("read-buffer-min-size")
         .withConfigName("read_buffer_min_size")
@@ -302,6 +392,162 @@ Options::Options()
         .withDescription("Specify the size of requests made during readdir "
                          "prefetch (in number of dir entries).");
 
+    add<unsigned int>()
+        ->withLongName("page-cache-prefetch-size")
+        .withConfigName("page_cache_prefetch_size")
+        .withValueName("<size>")
+        .withDefaultValue(DEFAULT_PAGE_CACHE_PREFETCH_SIZE,
+            std::to_string(DEFAULT_PAGE_CACHE_PREFETCH_SIZE))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum size in bytes of prefetched data "
+                         "pushed into kernel page cache ahead of a reader "
+                         "(0 disables page cache).");
+
+    add<unsigned int>()
+        ->withLongName("write-behind-buffer-size")
+        .withConfigName("write_behind_buffer_size")
+        .withValueName("<size>")
+        .withDefaultValue(DEFAULT_WRITE_BEHIND_BUFFER_SIZE,
+            std::to_string(DEFAULT_WRITE_BEHIND_BUFFER_SIZE))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum size in bytes of adjacent writes "
+                         "coalesced in a file handle before they are written "
+                         "to storage; a failed write of coalesced data is "
+                         "reported by the next write, flush or fsync of the "
+                         "handle, which retries it (0 disables "
+                         "write-behind).");
+
+    add<unsigned int>()
+        ->withLongName("write-behind-flush-delay")
+        .withConfigName("write_behind_flush_delay")
+        .withValueName("<delay>")
+        .withDefaultValue(DEFAULT_WRITE_BEHIND_FLUSH_DELAY,
+            std::to_string(DEFAULT_WRITE_BEHIND_FLUSH_DELAY))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify period in seconds after which coalesced "
+                         "writes are written to storage.");
+
+    add<unsigned int>()
+        ->withLongName("write-stripe-size")
+        .withConfigName("write_stripe_size")
+        .withValueName("<size>")
+        .withDefaultValue(DEFAULT_WRITE_STRIPE_SIZE,
+            std::to_string(DEFAULT_WRITE_STRIPE_SIZE))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify size in bytes of stripes into which large "
+                         "writes are cut and written to storage in parallel "
+                         "(0 disables striping).");
+
+    add<unsigned int>()
+        ->withLongName("write-stripe-count")
+        .withConfigName("write_stripe_count")
+        .withValueName("<count>")
+        .withDefaultValue(DEFAULT_WRITE_STRIPE_COUNT,
+            std::to_string(DEFAULT_WRITE_STRIPE_COUNT))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum number of stripes written to "
+                         "storage in parallel.");
+
+    add<unsigned int>()
+        ->withLongName("times-write-back-delay")
+        .withConfigName("times_write_back_delay")
+        .withValueName("<delay>")
+        .withDefaultValue(DEFAULT_TIMES_WRITE_BACK_DELAY,
+            std::to_string(DEFAULT_TIMES_WRITE_BACK_DELAY))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum period in seconds for which file "
+                         "times updates are coalesced before they are sent to "
+                         "the provider (0 sends them synchronously).");
+
+    add<bool>()
+        ->asSwitch()
+        .withLongName("fast-release")
+        .withConfigName("fast_release")
+        .withImplicitValue(true)
+        .withDefaultValue(false, "false")
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Complete file release in background without "
+                         "implicit fsync, reporting its errors on a fsync or "
+                         "flush within 5 minutes.");
+
+    add<unsigned int>()
+        ->withLongName("handle-pool-size")
+        .withConfigName("handle_pool_size")
+        .withValueName("<size>")
+        .withDefaultValue(
+            DEFAULT_HANDLE_POOL_SIZE, std::to_string(DEFAULT_HANDLE_POOL_SIZE))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum number of released file handles "
+                         "kept open for reuse by a subsequent open of the "
+                         "same file (0 disables the pool).");
+
+    add<unsigned int>()
+        ->withLongName("handle-pool-idle-timeout")
+        .withConfigName("handle_pool_idle_timeout")
+        .withValueName("<timeout>")
+        .withDefaultValue(DEFAULT_HANDLE_POOL_IDLE_TIMEOUT,
+            std::to_string(DEFAULT_HANDLE_POOL_IDLE_TIMEOUT))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify time in seconds after which an unused "
+                         "pooled file handle is released.");
+
+    add<unsigned int>()
+        ->withLongName("small-file-inline-size")
+        .withConfigName("small_file_inline_size")
+        .withValueName("<size>")
+        .withDefaultValue(DEFAULT_SMALL_FILE_INLINE_SIZE,
+            std::to_string(DEFAULT_SMALL_FILE_INLINE_SIZE))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum size in bytes of a file opened for "
+                         "reading whose contents are sent inline with the "
+                         "response to open and read from memory (0 disables "
+                         "inline contents); requires a Oneprovider supporting "
+                         "it and oneclient built with WITH_INLINE_FILE_DATA.");
+
+    add<unsigned int>()
+        ->withLongName("small-file-cache-size")
+        .withConfigName("small_file_cache_size")
+        .withValueName("<size>")
+        .withDefaultValue(DEFAULT_SMALL_FILE_CACHE_SIZE,
+            std::to_string(DEFAULT_SMALL_FILE_CACHE_SIZE))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify maximum total size in bytes of small file "
+                         "contents cached in memory.");
+
+    add<boost::filesystem::path>()
+        ->withLongName("storage-state-file")
+        .withConfigName("storage_state_file")
+        .withValueName("<path>")
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify path to a file in which mount points of "
+                         "POSIX storages detected as directly accessible are "
+                         "remembered for each provider, so that direct IO is "
+                         "used right after a remount as long as the same "
+                         "filesystems are mounted there.");
+
+    add<bool>()
+        ->asSwitch()
+        .withLongName("adaptive-io-path")
+        .withConfigName("adaptive_io_path")
+        .withImplicitValue(true)
+        .withDefaultValue(false, "false")
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Switch new file handles on directly accessible "
+                         "storages between direct and proxy IO based on "
+                         "measured throughput.");
+
+    add<unsigned int>()
+        ->withLongName("direct-io-reprobe-delay")
+        .withConfigName("direct_io_reprobe_delay")
+        .withValueName("<delay>")
+        .withDefaultValue(DEFAULT_DIRECT_IO_REPROBE_DELAY,
+            std::to_string(DEFAULT_DIRECT_IO_REPROBE_DELAY))
+        .withGroup(OptionGroup::ADVANCED)
+        .withDescription("Specify initial delay in seconds after which direct "
+                         "IO is retried for a file switched to proxy IO due "
+                         "to a permission error, doubled after each failed "
+                         "retry (0 disables retries).");
+
     add<bool>()
         ->asSwitch()
         .withShortName("f")
@@ -645,6 +891,20 @@ unsigned int Options::getStorageHelperThreadCount() const
         .get_value_or(DEFAULT_STORAGE_HELPER_THREAD_COUNT);
 }
 
+unsigned int Options::getStorageExecutorThreadCount() const
+{
+    return get<unsigned int>(
+        {"storage-executor-thread-count", "storage_executor_thread_count"})
+        .get_value_or(DEFAULT_STORAGE_EXECUTOR_THREAD_COUNT);
+}
+
+unsigned int Options::getStorageExecutorQueueDepth() const
+{
+    return get<unsigned int>(
+        {"storage-executor-queue-depth", "storage_executor_queue_depth"})
+        .get_value_or(DEFAULT_STORAGE_EXECUTOR_QUEUE_DEPTH);
+}
+
 bool Options::areFileReadEventsDisabled() const
 {
     return get<bool>({"disable-read-events", "disable_read_events"})
@@ -657,6 +917,12 @@ bool Options::isFullblockReadForced() const
         .get_value_or(false);
 }
 
+bool Options::areCompoundFileRequestsEnabled() const
+{
+    return get<bool>({"compound-file-requests", "compound_file_requests"})
+        .get_value_or(false);
+}
+
 bool Options::isIOBuffered() const
 {
     return !get<bool>({"no-buffer", "no_buffer"}).get_value_or(false);
@@ -669,6 +935,35 @@ std::chrono::seconds Options::getProviderTimeout() const
             .get_value_or(DEFAULT_PROVIDER_TIMEOUT)};
 }
 
+unsigned int Options::getHedgePercentile() const
+{
+    return get<unsigned int>({"hedge-percentile", "hedge_percentile"})
+        .get_value_or(DEFAULT_HEDGE_PERCENTILE);
+}
+
+unsigned int Options::getCircuitBreakerFailureThreshold() const
+{
+    return get<unsigned int>({"circuit-breaker-failure-threshold",
+                                 "circuit_breaker_failure_threshold"})
+        .get_value_or(DEFAULT_CIRCUIT_BREAKER_FAILURE_THRESHOLD);
+}
+
+std::chrono::seconds Options::getCircuitBreakerResetTimeout() const
+{
+    return std::chrono::seconds{
+        get<unsigned int>({"circuit-breaker-reset-timeout",
+                              "circuit_breaker_reset_timeout"})
+            .get_value_or(DEFAULT_CIRCUIT_BREAKER_RESET_TIMEOUT)};
+}
+
+std::chrono::milliseconds Options::getSubscriptionBatchDelay() const
+{
+    return std::chrono::milliseconds{
+        get<unsigned int>(
+            {"subscription-batch-delay", "subscription_batch_delay"})
+            .get_value_or(DEFAULT_SUBSCRIPTION_BATCH_DELAY)};
+}
+
 unsigned int Options::getReadBufferMinSize() const
 {
     return get<unsigned int>({"read-buffer-min-size", "read_buffer_min_size"})
@@ -721,6 +1016,100 @@ unsigned int Options::getReaddirPrefetchSize() const
         .get_value_or(DEFAULT_READDIR_PREFETCH_SIZE);
 }
 
+unsigned int Options::getPageCachePrefetchSize() const
+{
+    return get<unsigned int>(
+        {"page-cache-prefetch-size", "page_cache_prefetch_size"})
+        .get_value_or(DEFAULT_PAGE_CACHE_PREFETCH_SIZE);
+}
+
+unsigned int Options::getWriteBehindBufferSize() const
+{
+    return get<unsigned int>(
+        {"write-behind-buffer-size", "write_behind_buffer_size"})
+        .get_value_or(DEFAULT_WRITE_BEHIND_BUFFER_SIZE);
+}
+
+std::chrono::seconds Options::getWriteBehindFlushDelay() const
+{
+    return std::chrono::seconds{
+        get<unsigned int>(
+            {"write-behind-flush-delay", "write_behind_flush_delay"})
+            .get_value_or(DEFAULT_WRITE_BEHIND_FLUSH_DELAY)};
+}
+
+unsigned int Options::getWriteStripeSize() const
+{
+    return get<unsigned int>({"write-stripe-size", "write_stripe_size"})
+        .get_value_or(DEFAULT_WRITE_STRIPE_SIZE);
+}
+
+unsigned int Options::getWriteStripeCount() const
+{
+    return get<unsigned int>({"write-stripe-count", "write_stripe_count"})
+        .get_value_or(DEFAULT_WRITE_STRIPE_COUNT);
+}
+
+std::chrono::seconds Options::getTimesWriteBackDelay() const
+{
+    return std::chrono::seconds{
+        get<unsigned int>({"times-write-back-delay", "times_write_back_delay"})
+            .get_value_or(DEFAULT_TIMES_WRITE_BACK_DELAY)};
+}
+
+bool Options::isFastReleaseEnabled() const
+{
+    return get<bool>({"fast-release", "fast_release"}).get_value_or(false);
+}
+
+unsigned int Options::getSmallFileInlineSize() const
+{
+    return get<unsigned int>(
+        {"small-file-inline-size", "small_file_inline_size"})
+        .get_value_or(DEFAULT_SMALL_FILE_INLINE_SIZE);
+}
+
+unsigned int Options::getSmallFileCacheSize() const
+{
+    return get<unsigned int>({"small-file-cache-size", "small_file_cache_size"})
+        .get_value_or(DEFAULT_SMALL_FILE_CACHE_SIZE);
+}
+
+boost::optional<boost::filesystem::path>
+Options::getStorageStateFilePath() const
+{
+    return get<boost::filesystem::path>(
+        {"storage-state-file", "storage_state_file"});
+}
+
+bool Options::isAdaptiveIOPathEnabled() const
+{
+    return get<bool>({"adaptive-io-path", "adaptive_io_path"})
+        .get_value_or(false);
+}
+
+std::chrono::seconds Options::getDirectIOReprobeDelay() const
+{
+    return std::chrono::seconds{get<unsigned int>(
+        {"direct-io-reprobe-delay", "direct_io_reprobe_delay"})
+                                    .get_value_or(
+                                        DEFAULT_DIRECT_IO_REPROBE_DELAY)};
+}
+
+unsigned int Options::getHandlePoolSize() const
+{
+    return get<unsigned int>({"handle-pool-size", "handle_pool_size"})
+        .get_value_or(DEFAULT_HANDLE_POOL_SIZE);
+}
+
+std::chrono::seconds Options::getHandlePoolIdleTimeout() const
+{
+    return std::chrono::seconds{get<unsigned int>(
+        {"handle-pool-idle-timeout", "handle_pool_idle_timeout"})
+                                    .get_value_or(
+                                        DEFAULT_HANDLE_POOL_IDLE_TIMEOUT)};
+}
+
 bool Options::isMonitoringEnabled() const
 {
     return get<std::string>({"monitoring-type", "monitoring_type"})
@@ -38,7 +38,24 @@ static constexpr auto DEFAULT_WRITE_BUFFER_MAX_SIZE = 50 * 1024 * 1024;
 static constexpr auto DEFAULT_WRITE_BUFFER_FLUSH_DELAY = 5;
 static constexpr auto DEFAULT_METADATA_CACHE_SIZE = 100000;
 static constexpr auto DEFAULT_READDIR_PREFETCH_SIZE = 2500;
+static constexpr auto DEFAULT_PAGE_CACHE_PREFETCH_SIZE = 0;
+static constexpr auto DEFAULT_WRITE_BEHIND_BUFFER_SIZE = 0;
+static constexpr auto DEFAULT_WRITE_BEHIND_FLUSH_DELAY = 1;
+static constexpr auto DEFAULT_WRITE_STRIPE_SIZE = 0;
+static constexpr auto DEFAULT_WRITE_STRIPE_COUNT = 4;
+static constexpr auto DEFAULT_TIMES_WRITE_BACK_DELAY = 0;
+static constexpr auto DEFAULT_HANDLE_POOL_SIZE = 0;
+static constexpr auto DEFAULT_HANDLE_POOL_IDLE_TIMEOUT = 5;
+static constexpr auto DEFAULT_SMALL_FILE_INLINE_SIZE = 0;
+static constexpr auto DEFAULT_SMALL_FILE_CACHE_SIZE = 16 * 1024 * 1024;
+static constexpr auto DEFAULT_DIRECT_IO_REPROBE_DELAY = 60;
+static constexpr auto DEFAULT_STORAGE_EXECUTOR_THREAD_COUNT = 0;
+static constexpr auto DEFAULT_STORAGE_EXECUTOR_QUEUE_DEPTH = 0;
 static constexpr auto DEFAULT_PROVIDER_TIMEOUT = 2 * 60;
+static constexpr auto DEFAULT_HEDGE_PERCENTILE = 0;
+static constexpr auto DEFAULT_CIRCUIT_BREAKER_FAILURE_THRESHOLD = 0;
+static constexpr auto DEFAULT_CIRCUIT_BREAKER_RESET_TIMEOUT = 10;
+static constexpr auto DEFAULT_SUBSCRIPTION_BATCH_DELAY = 0;
 }
 
 class Option;
@@ -196,6 +213,18 @@ public:
      */
     unsigned int getStorageHelperThreadCount() const;
 
+    /*
+     * @return Number of storage helper threads of each storage's own
+     * executor, or 0 if all storages share the storage helper threads.
+     */
+    unsigned int getStorageExecutorThreadCount() const;
+
+    /*
+     * @return Maximum number of IO operations queued on a storage's own
+     * executor at once, or 0 for no limit.
+     */
+    unsigned int getStorageExecutorQueueDepth() const;
+
     /*
      * @return true if 'disable-read-events' is specified.
      */
@@ -206,6 +235,11 @@ public:
      */
     bool isFullblockReadForced() const;
 
+    /*
+     * @return true if 'compound-file-requests' is specified.
+     */
+    bool areCompoundFileRequestsEnabled() const;
+
     /*
      * @return false if 'no-buffer' option has been provided, otherwise true.
      */
@@ -216,6 +250,30 @@ public:
      */
     std::chrono::seconds getProviderTimeout() const;
 
+    /*
+     * @return Percentile of recent provider response times after which
+     * idempotent metadata requests are sent again, or 0 if they're not.
+     */
+    unsigned int getHedgePercentile() const;
+
+    /*
+     * @return Number of consecutive provider request timeouts after which
+     * requests fail immediately, or 0 if they never do.
+     */
+    unsigned int getCircuitBreakerFailureThreshold() const;
+
+    /*
+     * @return Time after which a provider request is tried again once
+     * requests started failing immediately.
+     */
+    std::chrono::seconds getCircuitBreakerResetTimeout() const;
+
+    /*
+     * @return Time for which remote subscription changes are collected
+     * before being sent together, or 0 if they're sent immediately.
+     */
+    std::chrono::milliseconds getSubscriptionBatchDelay() const;
+
     /*
      * @return Minimum size in bytes of in-memory cache for input data blocks.
      */
@@ -258,6 +316,85 @@ public:
      */
     unsigned int getReaddirPrefetchSize() const;
 
+    /*
+     * @return Maximum number of prefetched bytes pushed into the kernel page
+     * cache ahead of a reader.
+     */
+    unsigned int getPageCachePrefetchSize() const;
+
+    /*
+     * @return Maximum size in bytes of data coalesced in a file handle before
+     * it is written to storage.
+     */
+    unsigned int getWriteBehindBufferSize() const;
+
+    /*
+     * @return Maximum period in seconds for which coalesced data is kept in
+     * a file handle before it is written to storage.
+     */
+    std::chrono::seconds getWriteBehindFlushDelay() const;
+
+    /*
+     * @return Size in bytes of stripes into which large writes are cut.
+     */
+    unsigned int getWriteStripeSize() const;
+
+    /*
+     * @return Maximum number of stripes written to storage in parallel.
+     */
+    unsigned int getWriteStripeCount() const;
+
+    /*
+     * @return Maximum period in seconds for which file times updated locally
+     * are kept before they are sent to the provider.
+     */
+    std::chrono::seconds getTimesWriteBackDelay() const;
+
+    /*
+     * @return true if 'fast-release' option has been provided, otherwise
+     * false.
+     */
+    bool isFastReleaseEnabled() const;
+
+    /*
+     * @return Maximum number of released file handles kept open for reuse.
+     */
+    unsigned int getHandlePoolSize() const;
+
+    /*
+     * @return Period after which an unused pooled file handle is released.
+     */
+    std::chrono::seconds getHandlePoolIdleTimeout() const;
+
+    /*
+     * @return Maximum size of a file whose contents are requested inline with
+     * the response to open.
+     */
+    unsigned int getSmallFileInlineSize() const;
+
+    /*
+     * @return Maximum total size of small file contents cached in memory.
+     */
+    unsigned int getSmallFileCacheSize() const;
+
+    /*
+     * @return Path to the file in which detected direct storage access is
+     * persisted between mounts, if provided.
+     */
+    boost::optional<boost::filesystem::path> getStorageStateFilePath() const;
+
+    /*
+     * @return true if 'adaptive-io-path' option has been provided, otherwise
+     * false.
+     */
+    bool isAdaptiveIOPathEnabled() const;
+
+    /*
+     * @return Initial delay before direct IO is retried for a file forced to
+     * proxy IO after a permission error.
+     */
+    std::chrono::seconds getDirectIOReprobeDelay() const;
+
     /*
      * @return Is monitoring enabled.
      */
@@ -0,0 +1,384 @@
+/**
+ * @file resilientCommunicator.h
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#pragma once
+
+#include "communication/communicator.h"
+#include "logging.h"
+#include "monitoring/monitoring.h"
+#include "scheduler.h"
+
+#include <folly/Optional.h>
+#include <folly/futures/Future.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace one {
+namespace client {
+
+/**
+ * @c ResilientCommunicator sends requests to the provider through
+ * @c communication::Communicator, guarding them with a circuit breaker and
+ * optionally hedging idempotent requests.
+ *
+ * After a configured number of consecutive requests time out, the circuit
+ * breaker opens and requests fail right away with ETIMEDOUT, until a single
+ * trial request sent after the reset timeout gets a response. Hedged
+ * requests which don't get a response within a configured percentile of
+ * recent response times of requests of the same type are sent again, most
+ * likely over another connection of the communicator's pool, and the first
+ * response is used. Storage helper operations are not guarded, as each
+ * storage's helpers run isolated on their own executor with their own
+ * timeouts. The communicator and scheduler are template parameters so that
+ * they can be replaced in unit tests.
+ */
+template <class CommunicatorT, class SchedulerT>
+class BasicResilientCommunicator {
+public:
+    /**
+     * Constructor.
+     * @param communicator Communicator used to send the requests.
+     * @param scheduler Scheduler used to send hedged requests.
+     * @param hedgePercentile Percentile of recent response times after
+     * which hedged requests are sent again (0 disables hedging).
+     * @param failureThreshold Number of consecutive timeouts after which
+     * the circuit breaker opens (0 disables the circuit breaker).
+     * @param resetTimeout Time after which a trial request is let through
+     * the open circuit breaker.
+     */
+    BasicResilientCommunicator(CommunicatorT &communicator,
+        SchedulerT &scheduler, const unsigned int hedgePercentile,
+        const unsigned int failureThreshold,
+        const std::chrono::seconds resetTimeout);
+
+    /**
+     * Sends a request to the provider.
+     * @param msg The request.
+     * @param timeout Time after which the request fails with ETIMEDOUT.
+     * @returns Future of the response.
+     */
+    template <typename SrvMsg, typename CliMsg>
+    folly::Future<SrvMsg> communicate(
+        CliMsg &&msg, const std::chrono::milliseconds timeout);
+
+    /**
+     * Sends an idempotent request to the provider, sending it again if
+     * there's no response in time.
+     * @param makeMsg Function creating the request.
+     * @param timeout Time after which each copy of the request fails with
+     * ETIMEDOUT.
+     * @returns Future of the first response.
+     */
+    template <typename SrvMsg, typename CliMsg>
+    folly::Future<SrvMsg> communicateHedged(std::function<CliMsg()> makeMsg,
+        const std::chrono::milliseconds timeout);
+
+private:
+    // Number of recent response times of a request type from which the
+    // hedging delay is computed, and the number of them needed before
+    // requests of that type are hedged
+    static constexpr std::size_t LATENCY_WINDOW_SIZE = 256;
+    static constexpr std::size_t LATENCY_MIN_SAMPLES = 32;
+
+    // Ring buffer of recent response times of a single request type
+    struct Latencies {
+        std::vector<std::chrono::steady_clock::duration> samples;
+        std::size_t next = 0;
+    };
+
+    template <typename SrvMsg>
+    folly::Future<SrvMsg> guard(folly::Future<SrvMsg> future,
+        const std::chrono::milliseconds timeout,
+        const std::type_index requestType);
+
+    bool admit();
+    void recordResponse(const std::type_index requestType,
+        const std::chrono::steady_clock::duration latency);
+    void recordError();
+    void recordTimeout();
+    void close();
+    folly::Optional<std::chrono::milliseconds> hedgeDelay(
+        const std::type_index requestType);
+
+    CommunicatorT &m_communicator;
+    SchedulerT &m_scheduler;
+
+    const unsigned int m_hedgePercentile;
+    const unsigned int m_failureThreshold;
+    const std::chrono::seconds m_resetTimeout;
+
+    std::mutex m_mutex;
+    // Requests of different types take different time to serve, e.g. file
+    // location fetches are slower than attribute fetches
+    std::unordered_map<std::type_index, Latencies> m_latencies;
+    std::size_t m_consecutiveTimeouts = 0;
+    bool m_open = false;
+    bool m_trialInProgress = false;
+    std::chrono::steady_clock::time_point m_openUntil;
+};
+
+using ResilientCommunicator =
+    BasicResilientCommunicator<communication::Communicator, Scheduler>;
+
+template <class CommunicatorT, class SchedulerT>
+BasicResilientCommunicator<CommunicatorT, SchedulerT>::
+    BasicResilientCommunicator(CommunicatorT &communicator,
+        SchedulerT &scheduler, const unsigned int hedgePercentile,
+        const unsigned int failureThreshold,
+        const std::chrono::seconds resetTimeout)
+    : m_communicator{communicator}
+    , m_scheduler{scheduler}
+    , m_hedgePercentile{std::min(hedgePercentile, 100u)}
+    , m_failureThreshold{failureThreshold}
+    , m_resetTimeout{resetTimeout}
+{
+}
+
+template <class CommunicatorT, class SchedulerT>
+template <typename SrvMsg, typename CliMsg>
+folly::Future<SrvMsg>
+BasicResilientCommunicator<CommunicatorT, SchedulerT>::communicate(
+    CliMsg &&msg, const std::chrono::milliseconds timeout)
+{
+    if (!admit())
+        return folly::makeFuture<SrvMsg>(
+            std::system_error{std::make_error_code(std::errc::timed_out)});
+
+    return guard(
+        m_communicator.template communicate<SrvMsg>(std::forward<CliMsg>(msg)),
+        timeout, typeid(CliMsg));
+}
+
+template <class CommunicatorT, class SchedulerT>
+template <typename SrvMsg, typename CliMsg>
+folly::Future<SrvMsg>
+BasicResilientCommunicator<CommunicatorT, SchedulerT>::communicateHedged(
+    std::function<CliMsg()> makeMsg, const std::chrono::milliseconds timeout)
+{
+    auto delay = hedgeDelay(typeid(CliMsg));
+    if (!delay)
+        return communicate<SrvMsg>(makeMsg(), timeout);
+
+    if (!admit())
+        return folly::makeFuture<SrvMsg>(
+            std::system_error{std::make_error_code(std::errc::timed_out)});
+
+    struct State {
+        std::mutex mutex;
+        folly::Promise<SrvMsg> promise;
+        std::size_t pending = 0;
+        bool done = false;
+        std::function<void()> cancelHedge = [] {};
+    };
+
+    auto state = std::make_shared<State>();
+    auto future = state->promise.getFuture();
+
+    auto send = [this, state, makeMsg, timeout](const bool hedge) {
+        {
+            std::lock_guard<std::mutex> lock{state->mutex};
+            if (state->done)
+                return;
+            ++state->pending;
+        }
+
+        if (hedge)
+            ONE_METRIC_COUNTER_INC(
+                "comp.oneclient.mod.communicator.hedged_requests");
+
+        guard(m_communicator.template communicate<SrvMsg>(makeMsg()), timeout,
+            typeid(CliMsg))
+            .then([state, hedge](folly::Try<SrvMsg> &&response) {
+                std::unique_lock<std::mutex> lock{state->mutex};
+                --state->pending;
+
+                // An error is reported only if no other copy of the request
+                // is still waiting for a response
+                if (state->done ||
+                    (response.hasException() && state->pending > 0))
+                    return;
+
+                state->done = true;
+                auto cancelHedge = std::move(state->cancelHedge);
+                lock.unlock();
+
+                cancelHedge();
+                if (hedge && response.hasValue())
+                    ONE_METRIC_COUNTER_INC(
+                        "comp.oneclient.mod.communicator.hedged_wins");
+
+                state->promise.setTry(std::move(response));
+            });
+    };
+
+    send(false);
+
+    std::lock_guard<std::mutex> lock{state->mutex};
+    if (!state->done)
+        state->cancelHedge =
+            m_scheduler.schedule(*delay, [send] { send(true); });
+
+    return future;
+}
+
+template <class CommunicatorT, class SchedulerT>
+template <typename SrvMsg>
+folly::Future<SrvMsg>
+BasicResilientCommunicator<CommunicatorT, SchedulerT>::guard(
+    folly::Future<SrvMsg> future, const std::chrono::milliseconds timeout,
+    const std::type_index requestType)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    return std::move(future)
+        .within(timeout)
+        .then([this, start, requestType](SrvMsg response) {
+            recordResponse(
+                requestType, std::chrono::steady_clock::now() - start);
+            return response;
+        })
+        .onError([this](folly::exception_wrapper ew) {
+            if (ew.is_compatible_with<folly::FutureTimeout>()) {
+                recordTimeout();
+                return folly::makeFuture<SrvMsg>(std::system_error{
+                    std::make_error_code(std::errc::timed_out)});
+            }
+
+            recordError();
+            return folly::makeFuture<SrvMsg>(std::move(ew));
+        });
+}
+
+template <class CommunicatorT, class SchedulerT>
+bool BasicResilientCommunicator<CommunicatorT, SchedulerT>::admit()
+{
+    if (m_failureThreshold == 0)
+        return true;
+
+    std::lock_guard<std::mutex> guard{m_mutex};
+
+    if (!m_open)
+        return true;
+
+    // After the reset timeout a single trial request is let through to
+    // check whether the provider responds again
+    if (std::chrono::steady_clock::now() < m_openUntil || m_trialInProgress) {
+        ONE_METRIC_COUNTER_INC(
+            "comp.oneclient.mod.communicator.circuit_breaker_rejections");
+        return false;
+    }
+
+    m_trialInProgress = true;
+    return true;
+}
+
+template <class CommunicatorT, class SchedulerT>
+void BasicResilientCommunicator<CommunicatorT, SchedulerT>::recordResponse(
+    const std::type_index requestType,
+    const std::chrono::steady_clock::duration latency)
+{
+    std::lock_guard<std::mutex> guard{m_mutex};
+
+    auto &latencies = m_latencies[requestType];
+    if (latencies.samples.size() < LATENCY_WINDOW_SIZE)
+        latencies.samples.emplace_back(latency);
+    else
+        latencies.samples[latencies.next] = latency;
+
+    latencies.next = (latencies.next + 1) % LATENCY_WINDOW_SIZE;
+
+    close();
+}
+
+template <class CommunicatorT, class SchedulerT>
+void BasicResilientCommunicator<CommunicatorT, SchedulerT>::recordError()
+{
+    // An error response still means that the provider is reachable
+    std::lock_guard<std::mutex> guard{m_mutex};
+    close();
+}
+
+template <class CommunicatorT, class SchedulerT>
+void BasicResilientCommunicator<CommunicatorT, SchedulerT>::close()
+{
+    m_consecutiveTimeouts = 0;
+    m_trialInProgress = false;
+    if (m_open) {
+        LOG(INFO) << "Provider responds again - closing circuit breaker";
+        m_open = false;
+    }
+}
+
+template <class CommunicatorT, class SchedulerT>
+void BasicResilientCommunicator<CommunicatorT, SchedulerT>::recordTimeout()
+{
+    ONE_METRIC_COUNTER_INC("comp.oneclient.mod.communicator.timeouts");
+
+    if (m_failureThreshold == 0)
+        return;
+
+    std::lock_guard<std::mutex> guard{m_mutex};
+
+    m_trialInProgress = false;
+    if (!m_open && ++m_consecutiveTimeouts < m_failureThreshold)
+        return;
+
+    if (!m_open) {
+        LOG(WARNING) << m_consecutiveTimeouts
+                     << " consecutive provider requests timed out - opening "
+                        "circuit breaker for "
+                     << m_resetTimeout.count() << "s";
+
+        ONE_METRIC_COUNTER_INC(
+            "comp.oneclient.mod.communicator.circuit_breaker_opened");
+    }
+
+    m_open = true;
+    m_openUntil = std::chrono::steady_clock::now() + m_resetTimeout;
+}
+
+template <class CommunicatorT, class SchedulerT>
+folly::Optional<std::chrono::milliseconds>
+BasicResilientCommunicator<CommunicatorT, SchedulerT>::hedgeDelay(
+    const std::type_index requestType)
+{
+    if (m_hedgePercentile == 0)
+        return {};
+
+    std::vector<std::chrono::steady_clock::duration> latencies;
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        auto it = m_latencies.find(requestType);
+        if (it == m_latencies.end() ||
+            it->second.samples.size() < LATENCY_MIN_SAMPLES)
+            return {};
+
+        latencies = it->second.samples;
+    }
+
+    const auto index = std::min(
+        latencies.size() - 1, latencies.size() * m_hedgePercentile / 100);
+    std::nth_element(
+        latencies.begin(), latencies.begin() + index, latencies.end());
+
+    return std::max(std::chrono::milliseconds{1},
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            latencies[index]));
+}
+
+} // namespace client
+} // namespace one
@@ -15,9 +15,15 @@
 #include "messages/fuse/verifyStorageTestFile.h"
 #include "posixHelper.h"
 
+#include <folly/FileUtil.h>
+#include <folly/dynamic.h>
+#include <folly/futures/Future.h>
 #include <folly/io/IOBuf.h>
+#include <folly/json.h>
 
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #ifdef __APPLE__
 #include <sys/mount.h>
 #else
@@ -31,16 +37,49 @@ namespace one {
 namespace client {
 
 namespace {
+
 #ifdef __APPLE__
 
-std::vector<boost::filesystem::path> getMountPoints()
+bool isStorageMountPoint(const MountedFilesystem &filesystem)
 {
-    std::vector<boost::filesystem::path> mountPoints;
+    const auto &type = filesystem.type;
+    const auto path = filesystem.mountPoint.string();
+    return type.compare(0, strlen("osxfuse"), "osxfuse") != 0 &&
+        type.compare(0, strlen("autofs"), "autofs") != 0 &&
+        type.compare(0, strlen("mtmfs"), "mtmfs") != 0 &&
+        type.compare(0, strlen("devfs"), "devfs") != 0 &&
+        path.compare(0, strlen("/proc"), "/proc") != 0 &&
+        path.compare(0, strlen("/dev"), "/dev") != 0 &&
+        path.compare(0, strlen("/sys"), "/sys") != 0 &&
+        path.compare(0, strlen("/etc"), "/etc") != 0 && path != "/";
+}
+
+#else
+
+bool isStorageMountPoint(const MountedFilesystem &filesystem)
+{
+    const auto &type = filesystem.type;
+    const auto path = filesystem.mountPoint.string();
+    return type.compare(0, 4, "fuse") != 0 &&
+        path.compare(0, 5, "/proc") != 0 && path.compare(0, 4, "/dev") != 0 &&
+        path.compare(0, 4, "/sys") != 0 && path.compare(0, 4, "/etc") != 0 &&
+        path != "/";
+}
+
+#endif
+
+} // namespace
+
+#ifdef __APPLE__
+
+std::vector<MountedFilesystem> getMountedFilesystems()
+{
+    std::vector<MountedFilesystem> filesystems;
 
     int mounted_filesystem_count = getfsstat(NULL, 0, MNT_NOWAIT);
     if (mounted_filesystem_count <= 0) {
         LOG(ERROR) << "Cannot count mounted filesystems.";
-        return mountPoints;
+        return filesystems;
     }
 
     std::vector<struct statfs> stats(mounted_filesystem_count);
@@ -50,96 +89,386 @@ std::vector<boost::filesystem::path> getMountPoints()
 
     if (mounted_filesystem_count <= 0) {
         LOG(ERROR) << "Cannot get fsstat data.";
-        return mountPoints;
-    }
-
-    for (const auto &stat : stats) {
-        std::string type(stat.f_fstypename);
-        std::string path(stat.f_mntonname);
-        if (type.compare(0, strlen("osxfuse"), "osxfuse") != 0 &&
-            type.compare(0, strlen("autofs"), "autofs") != 0 &&
-            type.compare(0, strlen("mtmfs"), "mtmfs") != 0 &&
-            type.compare(0, strlen("devfs"), "devfs") != 0 &&
-            path.compare(0, strlen("/proc"), "/proc") != 0 &&
-            path.compare(0, strlen("/dev"), "/dev") != 0 &&
-            path.compare(0, strlen("/sys"), "/sys") != 0 &&
-            path.compare(0, strlen("/etc"), "/etc") != 0 && path != "/") {
-            mountPoints.push_back(stat.f_mntonname);
-        }
+        return filesystems;
     }
 
-    return mountPoints;
+    for (const auto &stat : stats)
+        filesystems.push_back(MountedFilesystem{
+            stat.f_mntonname, stat.f_mntfromname, stat.f_fstypename});
+
+    return filesystems;
 }
 
 #else
 
-std::vector<boost::filesystem::path> getMountPoints()
+std::vector<MountedFilesystem> getMountedFilesystems()
 {
-    std::vector<boost::filesystem::path> mountPoints;
+    std::vector<MountedFilesystem> filesystems;
 
     FILE *file = setmntent("/proc/mounts", "r");
     if (file == nullptr) {
         LOG(ERROR) << "Cannot parse /proc/mounts file.";
-        return mountPoints;
+        return filesystems;
     }
 
     struct mntent *ent;
-    while ((ent = getmntent(file)) != nullptr) {
-        std::string type(ent->mnt_type);
-        std::string path(ent->mnt_dir);
-        if (type.compare(0, 4, "fuse") != 0 &&
-            path.compare(0, 5, "/proc") != 0 &&
-            path.compare(0, 4, "/dev") != 0 &&
-            path.compare(0, 4, "/sys") != 0 &&
-            path.compare(0, 4, "/etc") != 0 && path != "/") {
-            mountPoints.emplace_back(ent->mnt_dir);
-        }
-    }
+    while ((ent = getmntent(file)) != nullptr)
+        filesystems.push_back(
+            MountedFilesystem{ent->mnt_dir, ent->mnt_fsname, ent->mnt_type});
 
     endmntent(file);
 
-    return mountPoints;
+    return filesystems;
 }
 
 #endif
-}
+
+constexpr std::chrono::seconds StorageAccessManager::MOUNT_POINT_PROBE_TIMEOUT;
 
 StorageAccessManager::StorageAccessManager(
     helpers::StorageHelperCreator &helperFactory,
-    const options::Options &options)
+    helpers::StorageHelperCreator &probeHelperFactory,
+    const options::Options &options,
+    std::function<std::vector<MountedFilesystem>()> mountedFilesystems,
+    const std::chrono::seconds probeTimeout)
     : m_helperFactory{helperFactory}
+    , m_probeHelperFactory{probeHelperFactory}
     , m_options{options}
+    , m_providerHost{options.getProviderHost().get_value_or("")}
+    , m_mountedFilesystems{std::move(mountedFilesystems)}
+    , m_probeTimeout{probeTimeout}
     , m_mountPoints{getMountPoints()}
 {
 }
 
-std::shared_ptr<helpers::StorageHelper>
+std::vector<boost::filesystem::path> StorageAccessManager::getMountPoints()
+{
+    std::vector<boost::filesystem::path> mountPoints;
+    for (const auto &filesystem : m_mountedFilesystems())
+        if (isStorageMountPoint(filesystem))
+            mountPoints.emplace_back(filesystem.mountPoint);
+
+    return mountPoints;
+}
+
+folly::Optional<MountedFilesystem> StorageAccessManager::getMountedFilesystem(
+    const boost::filesystem::path &mountPoint)
+{
+    // The filesystem currently mounted at a mount point is the last one
+    // mounted there
+    folly::Optional<MountedFilesystem> result;
+    for (auto &filesystem : m_mountedFilesystems())
+        if (filesystem.mountPoint == mountPoint)
+            result = std::move(filesystem);
+
+    return result;
+}
+
+std::vector<boost::filesystem::path> StorageAccessManager::refreshMountPoints()
+{
+    auto mountPoints = getMountPoints();
+
+    std::lock_guard<std::mutex> guard{m_mountPointsMutex};
+
+    if (mountPoints != m_mountPoints) {
+        LOG_DBG(1) << "Mount table changed - probing " << mountPoints.size()
+                   << " mount points";
+
+        m_mountPoints = std::move(mountPoints);
+        m_hungMountPoints.clear();
+    }
+
+    std::vector<boost::filesystem::path> result;
+    std::copy_if(m_mountPoints.begin(), m_mountPoints.end(),
+        std::back_inserter(result), [this](const auto &mountPoint) {
+            return m_hungMountPoints.count(mountPoint.string()) == 0;
+        });
+
+    return result;
+}
+
+folly::Future<folly::Optional<DetectedStorageAccess>>
+StorageAccessManager::verifyPosixStorageTestFile(
+    const messages::fuse::StorageTestFile &testFile)
+{
+    const auto mountPoints = refreshMountPoints();
+
+    std::vector<folly::Future<bool>> probes;
+
+    for (const auto &mountPoint : mountPoints) {
+        auto helper = m_probeHelperFactory.getStorageHelper(
+            helpers::POSIX_HELPER_NAME,
+            {{helpers::POSIX_HELPER_MOUNT_POINT_ARG, mountPoint.string()}},
+            m_options.isIOBuffered());
+
+        probes.emplace_back(probeStorageTestFile(helper, testFile)
+                                .ensure([helper] {})
+                                .within(m_probeTimeout));
+    }
+
+    return folly::collectAll(probes).then([this, mountPoints](
+        const std::vector<folly::Try<bool>> &results) {
+        folly::exception_wrapper error;
+        folly::Optional<DetectedStorageAccess> found;
+
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            if (results[i].hasValue()) {
+                if (results[i].value() && !found) {
+                    DetectedStorageAccess access;
+                    access.helperName = helpers::POSIX_HELPER_NAME;
+                    access.helperArgs = {{helpers::POSIX_HELPER_MOUNT_POINT_ARG,
+                        mountPoints[i].string()}};
+                    // The found storage is accessed through a helper on
+                    // regular worker threads, not on the probe threads
+                    access.helper = m_helperFactory.getStorageHelper(
+                        access.helperName, access.helperArgs,
+                        m_options.isIOBuffered());
+                    found = std::move(access);
+                }
+                continue;
+            }
+
+            auto &ew = results[i].exception();
+            if (ew.is_compatible_with<folly::FutureTimeout>()) {
+                LOG(WARNING) << "Mount point " << mountPoints[i]
+                             << " didn't respond within "
+                             << m_probeTimeout.count()
+                             << "s - skipping it in storage detection";
+
+                std::lock_guard<std::mutex> guard{m_mountPointsMutex};
+                m_hungMountPoints.emplace(mountPoints[i].string());
+            }
+            else if (!error) {
+                error = ew;
+            }
+        }
+
+        if (!found && error)
+            error.throw_exception();
+
+        return found;
+    });
+}
+
+folly::Future<folly::Optional<DetectedStorageAccess>>
 StorageAccessManager::verifyStorageTestFile(
     const messages::fuse::StorageTestFile &testFile)
 {
     const auto &helperParams = testFile.helperParams();
     if (helperParams.name() == helpers::POSIX_HELPER_NAME) {
-        for (const auto &mountPoint : m_mountPoints) {
-            auto helper = m_helperFactory.getStorageHelper(
-                helpers::POSIX_HELPER_NAME,
-                {{helpers::POSIX_HELPER_MOUNT_POINT_ARG, mountPoint.string()}},
-                m_options.isIOBuffered());
-            if (verifyStorageTestFile(helper, testFile))
-                return helper;
-        }
+        return verifyPosixStorageTestFile(testFile);
     }
     else if (helperParams.name() == helpers::NULL_DEVICE_HELPER_NAME) {
-        return m_helperFactory.getStorageHelper(
-            helperParams.name(), helperParams.args(), m_options.isIOBuffered());
+        return folly::Optional<DetectedStorageAccess>{DetectedStorageAccess{
+            m_helperFactory.getStorageHelper(helperParams.name(),
+                helperParams.args(), m_options.isIOBuffered()),
+            helperParams.name(), helperParams.args()}};
     }
     else {
         auto helper = m_helperFactory.getStorageHelper(
             helperParams.name(), helperParams.args(), m_options.isIOBuffered());
         if (verifyStorageTestFile(helper, testFile))
-            return helper;
+            return folly::Optional<DetectedStorageAccess>{
+                DetectedStorageAccess{
+                    helper, helperParams.name(), helperParams.args()}};
+    }
+
+    return folly::Optional<DetectedStorageAccess>{};
+}
+
+std::vector<std::pair<folly::fbstring, DetectedStorageAccess>>
+StorageAccessManager::loadDetectedStorages()
+{
+    std::vector<std::pair<folly::fbstring, DetectedStorageAccess>> result;
+
+    if (!m_options.getStorageStateFilePath())
+        return result;
+
+    std::lock_guard<std::mutex> guard{m_stateMutex};
+
+    const auto storages =
+        readStateFile()
+            .getDefault("providers", folly::dynamic::object)
+            .getDefault(m_providerHost, folly::dynamic::object);
+
+    for (const auto &storage : storages.items()) {
+        try {
+            const folly::fbstring storageId = storage.first.asString();
+            const boost::filesystem::path mountPoint{
+                storage.second["mountPoint"].asString()};
+
+            // Only a cheap check of the mount table is done here, as the
+            // mount point may hang - if the filesystem mounted there is
+            // still the one on which the storage was detected, a storage
+            // which stopped being accessible falls back to proxy IO on the
+            // first error
+            auto filesystem = getMountedFilesystem(mountPoint);
+            if (!filesystem ||
+                filesystem->source != storage.second["source"].asString() ||
+                filesystem->type != storage.second["type"].asString()) {
+                LOG(INFO) << "Filesystem on which storage '" << storageId
+                          << "' was detected is no longer mounted at "
+                          << mountPoint << " - detecting its access again";
+                continue;
+            }
+
+            DetectedStorageAccess access;
+            access.helperName = helpers::POSIX_HELPER_NAME;
+            access.helperArgs = {
+                {helpers::POSIX_HELPER_MOUNT_POINT_ARG, mountPoint.string()}};
+
+            access.helper = m_helperFactory.getStorageHelper(
+                access.helperName, access.helperArgs, m_options.isIOBuffered());
+
+            LOG(INFO) << "Restored direct access to storage '" << storageId
+                      << "' from storage state file";
+
+            m_detected.emplace(storageId, access);
+            result.emplace_back(storageId, std::move(access));
+        }
+        catch (const std::exception &e) {
+            LOG(WARNING) << "Ignoring invalid storage state file entry for "
+                         << storage.first.asString() << ": " << e.what();
+        }
+    }
+
+    writeStateFile();
+
+    return result;
+}
+
+void StorageAccessManager::persistDetectedStorage(
+    const folly::fbstring &storageId, const DetectedStorageAccess &access)
+{
+    if (!m_options.getStorageStateFilePath())
+        return;
+
+    if (access.helperName != helpers::POSIX_HELPER_NAME)
+        return;
+
+    std::lock_guard<std::mutex> guard{m_stateMutex};
+    m_detected[storageId] = access;
+    writeStateFile();
+}
+
+void StorageAccessManager::forgetDetectedStorage(
+    const folly::fbstring &storageId)
+{
+    if (!m_options.getStorageStateFilePath())
+        return;
+
+    std::lock_guard<std::mutex> guard{m_stateMutex};
+    if (m_detected.erase(storageId))
+        writeStateFile();
+}
+
+folly::dynamic StorageAccessManager::readStateFile()
+{
+    const auto stateFilePath = *m_options.getStorageStateFilePath();
+    if (!boost::filesystem::exists(stateFilePath))
+        return folly::dynamic::object;
+
+    try {
+        std::string stateJson;
+        if (!folly::readFile(stateFilePath.c_str(), stateJson))
+            throw std::system_error{errno, std::system_category()};
+
+        auto state = folly::parseJson(stateJson);
+        if (state.isObject() &&
+            state.getDefault("providers", folly::dynamic::object).isObject())
+            return state;
+
+        LOG(WARNING) << "Ignoring storage state file " << stateFilePath
+                     << " of unknown format";
+    }
+    catch (const std::exception &e) {
+        LOG(WARNING) << "Cannot read storage state file " << stateFilePath
+                     << ": " << e.what();
     }
 
-    return {};
+    return folly::dynamic::object;
+}
+
+void StorageAccessManager::writeStateFile()
+{
+    const auto stateFilePath = *m_options.getStorageStateFilePath();
+
+    folly::dynamic storages = folly::dynamic::object;
+    for (const auto &detected : m_detected) {
+        const auto mountPoint = detected.second.helperArgs.find(
+            helpers::POSIX_HELPER_MOUNT_POINT_ARG);
+        if (mountPoint == detected.second.helperArgs.end())
+            continue;
+
+        // The filesystem is remembered along with its mount point, so that
+        // a different filesystem mounted there later is not used directly
+        auto filesystem =
+            getMountedFilesystem(mountPoint->second.toStdString());
+        if (!filesystem)
+            continue;
+
+        folly::dynamic storage = folly::dynamic::object;
+        storage["mountPoint"] = mountPoint->second.toStdString();
+        storage["source"] = filesystem->source;
+        storage["type"] = filesystem->type;
+        storages[detected.first.toStdString()] = std::move(storage);
+    }
+
+    // Entries of other providers, written by clients connected to them, are
+    // kept intact
+    auto providers =
+        readStateFile().getDefault("providers", folly::dynamic::object);
+    providers[m_providerHost] = std::move(storages);
+
+    // The state is written to a temporary file first, so that a crash never
+    // leaves a truncated state file behind
+    const auto tmpPath = stateFilePath.string() + ".tmp";
+
+    try {
+        boost::filesystem::create_directories(stateFilePath.parent_path());
+
+        const auto stateJson = folly::toPrettyJson(
+            folly::dynamic::object("providers", std::move(providers)));
+
+        // The file is only readable by its owner, as it reveals which
+        // storages the user can access directly
+        boost::filesystem::remove(tmpPath);
+        if (!folly::writeFile(stateJson, tmpPath.c_str(),
+                O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR))
+            throw std::system_error{errno, std::system_category()};
+
+        boost::filesystem::rename(tmpPath, stateFilePath);
+    }
+    catch (const std::exception &e) {
+        LOG(WARNING) << "Cannot write storage state file " << stateFilePath
+                     << ": " << e.what();
+    }
+}
+
+folly::Future<bool> StorageAccessManager::probeStorageTestFile(
+    std::shared_ptr<helpers::StorageHelper> helper,
+    const messages::fuse::StorageTestFile &testFile)
+{
+    const auto size = testFile.fileContent().size();
+
+    return helper->open(testFile.fileId(), O_RDONLY, {})
+        .then([size](helpers::FileHandlePtr handle) {
+            return handle->read(0, size).ensure([handle] {});
+        })
+        .then([expected = testFile.fileContent()](folly::IOBufQueue buf) {
+            std::string content;
+            buf.appendToString(content);
+            return content == expected;
+        })
+        .onError([](const std::system_error &e) {
+            auto code = e.code().value();
+            if (code != ENOENT && code != ENOTDIR && code != EPERM) {
+                LOG(WARNING) << "Storage test file validation failed!";
+                return folly::makeFuture<bool>(e);
+            }
+
+            return folly::makeFuture(false);
+        });
 }
 
 bool StorageAccessManager::verifyStorageTestFile(
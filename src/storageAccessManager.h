@@ -14,7 +14,17 @@
 
 #include <boost/filesystem.hpp>
 #include <folly/FBString.h>
+#include <folly/Optional.h>
+#include <folly/dynamic.h>
+#include <folly/futures/Future.h>
 
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace one {
@@ -29,28 +39,98 @@ class StorageTestFile;
 }
 namespace client {
 
+/**
+ * Storage helper through which a storage has been found to be directly
+ * accessible, along with the parameters it has been created with.
+ */
+struct DetectedStorageAccess {
+    std::shared_ptr<helpers::StorageHelper> helper;
+    folly::fbstring helperName;
+    std::unordered_map<folly::fbstring, folly::fbstring> helperArgs;
+};
+
+/**
+ * Filesystem mounted in the system, identified by its source and type.
+ */
+struct MountedFilesystem {
+    boost::filesystem::path mountPoint;
+    std::string source;
+    std::string type;
+};
+
+/**
+ * @returns Filesystems listed in the system's mount table.
+ */
+std::vector<MountedFilesystem> getMountedFilesystems();
+
 /**
  * The StorageAccessManager class is responsible for detecting storages that are
  * directly accessible to the client.
  */
 class StorageAccessManager {
 public:
+    /**
+     * Maximum time a single mount point may take to serve the storage test
+     * file, after which it's considered hung and skipped until the mount
+     * table changes.
+     */
+    static constexpr std::chrono::seconds MOUNT_POINT_PROBE_TIMEOUT{5};
+
     /**
      * Constructor.
      * @param helperFactory Instance of @c helpers::StorageHelperCreator.
+     * @param probeHelperFactory Instance of @c helpers::StorageHelperCreator
+     * running on dedicated threads, used to probe mount points, so that
+     * a hung mount point cannot block other storage operations.
+     * @param mountedFilesystems Function listing mounted filesystems.
+     * @param probeTimeout Maximum time of a single mount point probe.
      */
     StorageAccessManager(helpers::StorageHelperCreator &helperFactory,
-        const options::Options &options);
+        helpers::StorageHelperCreator &probeHelperFactory,
+        const options::Options &options,
+        std::function<std::vector<MountedFilesystem>()> mountedFilesystems =
+            getMountedFilesystems,
+        const std::chrono::seconds probeTimeout = MOUNT_POINT_PROBE_TIMEOUT);
 
     /**
      * Verifies the test file by reading it from the storage and checking its
-     * content with the one sent by the server.
+     * content with the one sent by the server. For POSIX storages the test
+     * file is looked up under all mount points concurrently, skipping mount
+     * points which didn't respond in time since the mount table last changed.
+     * Verification of other storages is done in the calling thread.
      * @param testFile Instance of @c messages::fuse::StorageTestFile.
-     * @return Storage helper object used to access the test file or nullptr if
-     * verification fails.
+     * @return Future of storage helper object used to access the test file
+     * and its parameters, or none if verification fails.
      */
-    std::shared_ptr<helpers::StorageHelper> verifyStorageTestFile(
-        const messages::fuse::StorageTestFile &testFile);
+    folly::Future<folly::Optional<DetectedStorageAccess>>
+    verifyStorageTestFile(const messages::fuse::StorageTestFile &testFile);
+
+    /**
+     * Loads POSIX storages detected as directly accessible during previous
+     * mounts from the same provider from the storage state file, if one is
+     * configured. Entries whose mount point no longer has the same filesystem
+     * mounted are dropped.
+     * @return Pairs of storage id and helper for the storage.
+     */
+    std::vector<std::pair<folly::fbstring, DetectedStorageAccess>>
+    loadDetectedStorages();
+
+    /**
+     * Remembers a storage as directly accessible in the storage state file.
+     * Only the mount points of POSIX storages, along with the source and type
+     * of the filesystems mounted there, are remembered, as parameters of
+     * other helpers may contain credentials.
+     * @param storageId Id of the storage.
+     * @param access Helper through which the storage is accessible.
+     */
+    void persistDetectedStorage(
+        const folly::fbstring &storageId, const DetectedStorageAccess &access);
+
+    /**
+     * Removes a storage from the storage state file.
+     * @param storageId Id of the storage.
+     */
+    void forgetDetectedStorage(const folly::fbstring &storageId);
 
     /**
      * Modifies the test file by writing random sequence of characters.
@@ -66,9 +146,39 @@ private:
     bool verifyStorageTestFile(std::shared_ptr<helpers::StorageHelper> helper,
         const messages::fuse::StorageTestFile &testFile);
 
+    folly::Future<folly::Optional<DetectedStorageAccess>>
+    verifyPosixStorageTestFile(const messages::fuse::StorageTestFile &testFile);
+
+    folly::Future<bool> probeStorageTestFile(
+        std::shared_ptr<helpers::StorageHelper> helper,
+        const messages::fuse::StorageTestFile &testFile);
+
+    std::vector<boost::filesystem::path> getMountPoints();
+
+    folly::Optional<MountedFilesystem> getMountedFilesystem(
+        const boost::filesystem::path &mountPoint);
+
+    std::vector<boost::filesystem::path> refreshMountPoints();
+
+    folly::dynamic readStateFile();
+
+    void writeStateFile();
+
     helpers::StorageHelperCreator &m_helperFactory;
+    helpers::StorageHelperCreator &m_probeHelperFactory;
     const options::Options &m_options;
+    // Storage state is kept separately for each provider, as storage ids
+    // are only unique within a provider's deployment
+    const std::string m_providerHost;
+    std::function<std::vector<MountedFilesystem>()> m_mountedFilesystems;
+    const std::chrono::seconds m_probeTimeout;
+
+    std::mutex m_mountPointsMutex;
     std::vector<boost::filesystem::path> m_mountPoints;
+    std::unordered_set<std::string> m_hungMountPoints;
+
+    std::mutex m_stateMutex;
+    std::unordered_map<folly::fbstring, DetectedStorageAccess> m_detected;
 };
 
 } // namespace client
@@ -528,6 +528,38 @@ def test_aggregate_events(result, endpoint, manager, evt_num, key_num):
         EvtParam.evtps(evt_num, emit_time),
     ])
 
+@pytest.mark.performance(
+    repeats=10,
+    parameters=[EvtParam.evt_num(1000)],
+    configs={
+        'emit': {
+            'description': 'Events emitted in a loop in the client.',
+            'parameters': [EvtParam.evt_num(1000000)]
+        }
+    })
+def test_emit_events(result, endpoint, manager, uuid, evt_num):
+    manager.subscribeFileRead(evt_num, -1)
+    evt_size = 10
+
+    emit_time = Duration()
+    with receive(endpoint) as queue:
+        with measure(emit_time):
+            manager.emitFileReads(uuid, evt_num, evt_size)
+        client_message = queue.get()
+
+    assert client_message.HasField('events')
+    assert len(client_message.events.events) == 1
+
+    evt = client_message.events.events[0]
+    assert evt.HasField('file_read')
+    assert evt.file_read.counter == evt_num
+    assert evt.file_read.size == evt_num * evt_size
+
+    result.set([
+        EvtParam.emit_time(emit_time),
+        EvtParam.evtps(evt_num, emit_time),
+    ])
+
 # -----------------------------------------------------------------------------
 
 def _test_emit_file_read(endpoint, manager, uuid, offset, size):
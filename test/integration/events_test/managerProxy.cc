@@ -49,6 +49,12 @@ public:
         m_manager.emit<FileWritten>(std::move(fileUuid), offset, size);
     }
 
+    void emitFileReads(std::string fileUuid, std::size_t evtNum, size_t size)
+    {
+        for (std::size_t i = 0; i < evtNum; ++i)
+            m_manager.emit<FileRead>(fileUuid, i * size, size);
+    }
+
     void emitFileTruncated(std::string fileUuid, off_t fileSize)
     {
         m_manager.emit<FileTruncated>(std::move(fileUuid), fileSize);
@@ -191,6 +197,7 @@ BOOST_PYTHON_MODULE(events)
     class_<ManagerProxy, boost::noncopyable>("Manager", no_init)
         .def("__init__", make_constructor(create))
         .def("emitFileRead", &ManagerProxy::emitFileRead)
+        .def("emitFileReads", &ManagerProxy::emitFileReads)
         .def("emitFileWritten", &ManagerProxy::emitFileWritten)
         .def("emitFileTruncated", &ManagerProxy::emitFileTruncated)
         .def("subscribeFileRead", &ManagerProxy::subscribeFileRead)
@@ -106,6 +106,20 @@ public:
             std::make_error_code(std::errc::owner_dead));
     }
 
+    void failHelperWrites(bool fail)
+    {
+        m_helpersCache->m_helper->set_write_ec(fail
+                ? std::make_error_code(std::errc::owner_dead)
+                : std::error_code{});
+    }
+
+    void failHelperFsyncs(bool fail)
+    {
+        m_helpersCache->m_helper->set_fsync_ec(fail
+                ? std::make_error_code(std::errc::owner_dead)
+                : std::error_code{});
+    }
+
     Stat getattr(std::string uuid)
     {
         ReleaseGIL guard;
@@ -227,6 +241,18 @@ public:
         return m_fsLogic.write(uuid, fuseHandleId, offset, std::move(buf));
     }
 
+    void flush(std::string uuid, int fuseHandleId)
+    {
+        ReleaseGIL guard;
+        m_fsLogic.flush(uuid, fuseHandleId);
+    }
+
+    void fsync(std::string uuid, int fuseHandleId, bool dataOnly)
+    {
+        ReleaseGIL guard;
+        m_fsLogic.fsync(uuid, fuseHandleId, dataOnly);
+    }
+
     void release(std::string uuid, int fuseHandleId)
     {
         ReleaseGIL guard;
@@ -294,6 +320,25 @@ public:
         return m_helpersCache->m_helper->verify_and_clear_expectations();
     }
 
+    int sh_write_count() { return m_helpersCache->m_helper->write_count(); }
+
+    int sh_written_bytes()
+    {
+        return m_helpersCache->m_helper->written_bytes();
+    }
+
+    boost::python::list sh_write_ranges()
+    {
+        boost::python::list ranges;
+        for (const auto &range : m_helpersCache->m_helper->write_ranges())
+            ranges.append(boost::python::make_tuple(
+                static_cast<long>(range.first), range.second));
+
+        return ranges;
+    }
+
+    int sh_fsync_count() { return m_helpersCache->m_helper->fsync_count(); }
+
 private:
     HelpersCacheProxy *m_helpersCache;
     fslogic::FsLogic m_fsLogic;
@@ -301,7 +346,8 @@ private:
 };
 
 namespace {
-boost::shared_ptr<FsLogicProxy> create(std::string ip, int port)
+boost::shared_ptr<FsLogicProxy> createWithOptions(
+    std::string ip, int port, boost::python::list optionsList)
 {
     FLAGS_minloglevel = 1;
 
@@ -313,7 +359,21 @@ boost::shared_ptr<FsLogicProxy> create(std::string ip, int port)
     context->setScheduler(std::make_shared<Scheduler>(1));
     context->setCommunicator(communicator);
     const auto globalConfigPath = boost::filesystem::unique_path();
-    context->setOptions(std::make_shared<options::Options>());
+
+    auto options = std::make_shared<options::Options>();
+    if (len(optionsList) > 0) {
+        std::vector<std::string> args{"oneclient"};
+        for (int i = 0; i < len(optionsList); ++i)
+            args.emplace_back(extract<std::string>(optionsList[i]));
+        args.emplace_back("mountpoint");
+
+        std::vector<const char *> cmdArgs;
+        for (const auto &arg : args)
+            cmdArgs.emplace_back(arg.c_str());
+
+        options->parse(cmdArgs.size(), cmdArgs.data());
+    }
+    context->setOptions(std::move(options));
 
     communicator->setScheduler(context->scheduler());
     communicator->connect();
@@ -321,8 +381,17 @@ boost::shared_ptr<FsLogicProxy> create(std::string ip, int port)
     return boost::make_shared<FsLogicProxy>(context);
 }
 
+boost::shared_ptr<FsLogicProxy> create(std::string ip, int port)
+{
+    return createWithOptions(std::move(ip), port, boost::python::list{});
+}
+
 int regularMode() { return S_IFREG; }
 
+bool withInlineFileData() { return WITH_INLINE_FILE_DATA; }
+
+bool withCompoundFileRequests() { return WITH_COMPOUND_FILE_REQUESTS; }
+
 void translate(const std::errc &err)
 {
     PyErr_SetString(
@@ -358,7 +427,10 @@ BOOST_PYTHON_MODULE(fslogic)
 
     class_<FsLogicProxy, boost::noncopyable>("FsLogicProxy", no_init)
         .def("__init__", make_constructor(create))
+        .def("__init__", make_constructor(createWithOptions))
         .def("failHelper", &FsLogicProxy::failHelper)
+        .def("failHelperWrites", &FsLogicProxy::failHelperWrites)
+        .def("failHelperFsyncs", &FsLogicProxy::failHelperFsyncs)
         .def("getattr", &FsLogicProxy::getattr)
         .def("mkdir", &FsLogicProxy::mkdir)
         .def("unlink", &FsLogicProxy::unlink)
@@ -372,6 +444,8 @@ BOOST_PYTHON_MODULE(fslogic)
         .def("open", &FsLogicProxy::open)
         .def("read", &FsLogicProxy::read)
         .def("write", &FsLogicProxy::write)
+        .def("flush", &FsLogicProxy::flush)
+        .def("fsync", &FsLogicProxy::fsync)
         .def("release", &FsLogicProxy::release)
         .def("truncate", &FsLogicProxy::truncate)
         .def("listxattr", &FsLogicProxy::listxattr)
@@ -381,7 +455,13 @@ BOOST_PYTHON_MODULE(fslogic)
         .def("expect_call_sh_open", &FsLogicProxy::expect_call_sh_open)
         .def("expect_call_sh_release", &FsLogicProxy::expect_call_sh_release)
         .def("verify_and_clear_expectations",
-            &FsLogicProxy::verify_and_clear_expectations);
+            &FsLogicProxy::verify_and_clear_expectations)
+        .def("sh_write_count", &FsLogicProxy::sh_write_count)
+        .def("sh_written_bytes", &FsLogicProxy::sh_written_bytes)
+        .def("sh_write_ranges", &FsLogicProxy::sh_write_ranges)
+        .def("sh_fsync_count", &FsLogicProxy::sh_fsync_count);
 
     def("regularMode", &regularMode);
+    def("withInlineFileData", &withInlineFileData);
+    def("withCompoundFileRequests", &withCompoundFileRequests);
 }
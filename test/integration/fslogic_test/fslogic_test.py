@@ -24,6 +24,15 @@ import fslogic
 from proto import messages_pb2, fuse_messages_pb2, event_messages_pb2, \
     common_messages_pb2, stream_messages_pb2
 
+# Tests of messages missing from the pinned clproto run only against
+# a oneclient built with them
+requires_inline_file_data = pytest.mark.skipif(
+    not fslogic.withInlineFileData(),
+    reason='requires oneclient built with WITH_INLINE_FILE_DATA')
+requires_compound_file_requests = pytest.mark.skipif(
+    not fslogic.withCompoundFileRequests(),
+    reason='requires oneclient built with WITH_COMPOUND_FILE_REQUESTS')
+
 
 @pytest.fixture
 def endpoint(appmock_client):
@@ -158,9 +167,16 @@ def prepare_location_response(uuid, blocks=[]):
     return server_response
 
 
-def prepare_rename_response(new_uuid):
+def compound_fslogic(endpoint):
+    return fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                                ['--compound-file-requests'])
+
+
+def prepare_rename_response(new_uuid, old_uuid=None):
     repl = fuse_messages_pb2.FileRenamed()
     repl.new_uuid = new_uuid
+    if old_uuid is not None:
+        repl.old_uuid = old_uuid
 
     server_response = messages_pb2.ServerMessage()
     server_response.fuse_response.file_renamed.CopyFrom(repl)
@@ -169,6 +185,36 @@ def prepare_rename_response(new_uuid):
     return server_response
 
 
+def prepare_file_written_subscription(counter_thr):
+    write_sub = event_messages_pb2.FileWrittenSubscription()
+    write_sub.counter_threshold = counter_thr
+
+    sub = event_messages_pb2.Subscription()
+    sub.id = random_int()
+    sub.file_written.CopyFrom(write_sub)
+
+    msg = messages_pb2.ServerMessage()
+    msg.subscription.CopyFrom(sub)
+
+    return msg
+
+
+def prepare_file_attr_changed_event(uuid):
+    attr = prepare_attr_response(uuid, fuse_messages_pb2.REG).fuse_response \
+        .file_attr
+
+    attr_evt = event_messages_pb2.FileAttrChangedEvent()
+    attr_evt.file_attr.CopyFrom(attr)
+
+    evts = event_messages_pb2.Events()
+    evts.events.add().file_attr_changed.CopyFrom(attr_evt)
+
+    msg = messages_pb2.ServerMessage()
+    msg.events.CopyFrom(evts)
+
+    return msg
+
+
 def prepare_processing_status_response(status):
     repl = messages_pb2.ProcessingStatus()
     repl.code = status
@@ -179,9 +225,11 @@ def prepare_processing_status_response(status):
     return server_response
 
 
-def prepare_open_response(handle_id='handle_id'):
+def prepare_open_response(handle_id='handle_id', inline_data=None):
     repl = fuse_messages_pb2.FileOpened()
     repl.handle_id = handle_id
+    if inline_data is not None:
+        repl.inline_data = inline_data
 
     server_response = messages_pb2.ServerMessage()
     server_response.fuse_response.file_opened.CopyFrom(repl)
@@ -211,7 +259,7 @@ def do_open(endpoint, fl, uuid, size=None, blocks=[], handle_id='handle_id'):
     location_response = prepare_location_response(uuid, blocks)
     open_response = prepare_open_response(handle_id)
 
-    with reply(endpoint, [attr_response, location_response, open_response]):
+    with reply(endpoint, [open_response, attr_response, location_response]):
         handle = fl.open(uuid, 0)
         assert handle >= 0
         return handle
@@ -406,6 +454,90 @@ def test_rename_should_pass_rename_errors(endpoint, fl, uuid):
     assert 'Operation not permitted' in str(excinfo.value)
 
 
+@requires_compound_file_requests
+def test_mkdir_should_cache_created_directory(endpoint, uuid):
+    fl = compound_fslogic(endpoint)
+    mkdir_response = prepare_attr_response(uuid, fuse_messages_pb2.DIR)
+
+    with reply(endpoint, mkdir_response) as queue:
+        fl.mkdir('parentUuid', 'name', 0123)
+        client_message = queue.get()
+
+    file_request = client_message.fuse_request.file_request
+    assert file_request.context_guid == 'parentUuid'
+    assert file_request.HasField('create_dir')
+    assert file_request.create_dir.name == 'name'
+
+    stat = fl.getattr(uuid)
+    assert stat.size == mkdir_response.fuse_response.file_attr.size
+
+
+@requires_compound_file_requests
+def test_unlink_should_send_delete_child(endpoint, uuid):
+    fl = compound_fslogic(endpoint)
+    delete_response = prepare_attr_response(uuid, fuse_messages_pb2.REG)
+
+    with reply(endpoint, delete_response) as queue:
+        fl.unlink('parentUuid', 'name')
+        client_message = queue.get()
+
+    file_request = client_message.fuse_request.file_request
+    assert file_request.context_guid == 'parentUuid'
+    assert file_request.HasField('delete_child')
+    assert file_request.delete_child.name == 'name'
+
+
+@requires_compound_file_requests
+def test_unlink_should_pass_delete_child_errors(endpoint):
+    fl = compound_fslogic(endpoint)
+    response = messages_pb2.ServerMessage()
+    response.fuse_response.status.code = common_messages_pb2.Status.eperm
+
+    with pytest.raises(RuntimeError) as excinfo:
+        with reply(endpoint, response):
+            fl.unlink('parentUuid', 'name')
+
+    assert 'Operation not permitted' in str(excinfo.value)
+
+
+@requires_compound_file_requests
+def test_rename_should_send_rename_child(endpoint, uuid):
+    fl = compound_fslogic(endpoint)
+    rename_response = prepare_rename_response('newUuid', old_uuid=uuid)
+
+    with reply(endpoint, rename_response) as queue:
+        fl.rename('parentUuid', 'name', 'newParentUuid', 'newName')
+        client_message = queue.get()
+
+    file_request = client_message.fuse_request.file_request
+    assert file_request.context_guid == 'parentUuid'
+    assert file_request.HasField('rename_child')
+
+    rename_child = file_request.rename_child
+    assert rename_child.name == 'name'
+    assert rename_child.target_parent_uuid == 'newParentUuid'
+    assert rename_child.target_name == 'newName'
+
+
+@requires_compound_file_requests
+def test_rename_child_should_follow_old_uuid_in_caches(endpoint, uuid):
+    fl = compound_fslogic(endpoint)
+    getattr_response = prepare_attr_response(uuid, fuse_messages_pb2.REG)
+
+    with reply(endpoint, getattr_response):
+        fl.getattr(uuid)
+
+    rename_response = prepare_rename_response('newUuid', old_uuid=uuid)
+
+    with reply(endpoint, rename_response):
+        fl.rename('parentUuid', 'name', 'newParentUuid', 'newName')
+
+    # No reply is prepared, so the attributes must come from the cache
+    stat = fl.getattr('newUuid')
+
+    assert stat.size == getattr_response.fuse_response.file_attr.size
+
+
 def test_chmod_should_change_mode(endpoint, fl, uuid):
     getattr_response = prepare_attr_response(uuid, fuse_messages_pb2.DIR)
     response = messages_pb2.ServerMessage()
@@ -459,6 +591,73 @@ def test_chmod_should_pass_chmod_errors(endpoint, fl, uuid):
     assert 'No such file or directory' in str(excinfo.value)
 
 
+@requires_compound_file_requests
+def test_chmod_should_send_set_attr(endpoint, uuid):
+    fl = compound_fslogic(endpoint)
+    getattr_response = prepare_attr_response(uuid, fuse_messages_pb2.REG)
+
+    with reply(endpoint, getattr_response):
+        fl.getattr(uuid)
+
+    setattr_response = prepare_attr_response(uuid, fuse_messages_pb2.REG)
+    setattr_response.fuse_response.file_attr.mode = 0123
+
+    with reply(endpoint, setattr_response) as queue:
+        fl.chmod(uuid, 0123)
+        client_message = queue.get()
+
+    file_request = client_message.fuse_request.file_request
+    assert file_request.context_guid == uuid
+    assert file_request.HasField('set_attr')
+
+    set_attr = file_request.set_attr
+    assert set_attr.mode == 0123
+    assert set_attr.HasField('ctime')
+    assert not set_attr.HasField('size')
+
+    assert fl.getattr(uuid).mode == 0123 | fslogic.regularMode()
+
+
+@requires_compound_file_requests
+def test_truncate_should_send_set_attr(endpoint, uuid):
+    fl = compound_fslogic(endpoint)
+    getattr_response = prepare_attr_response(uuid, fuse_messages_pb2.REG,
+                                             size=10)
+
+    with reply(endpoint, getattr_response):
+        fl.getattr(uuid)
+
+    setattr_response = prepare_attr_response(uuid, fuse_messages_pb2.REG,
+                                             size=4)
+
+    with reply(endpoint, setattr_response) as queue:
+        fl.truncate(uuid, 4)
+        client_message = queue.get()
+
+    file_request = client_message.fuse_request.file_request
+    assert file_request.context_guid == uuid
+    assert file_request.HasField('set_attr')
+
+    set_attr = file_request.set_attr
+    assert set_attr.size == 4
+    assert not set_attr.HasField('mode')
+
+    assert 4 == fl.getattr(uuid).size
+
+
+@requires_compound_file_requests
+def test_setattr_should_pass_set_attr_errors(endpoint, uuid):
+    fl = compound_fslogic(endpoint)
+    response = messages_pb2.ServerMessage()
+    response.fuse_response.status.code = common_messages_pb2.Status.eperm
+
+    with pytest.raises(RuntimeError) as excinfo:
+        with reply(endpoint, response):
+            fl.chmod(uuid, 0312)
+
+    assert 'Operation not permitted' in str(excinfo.value)
+
+
 def test_utime_should_update_times(endpoint, fl, uuid, stat):
     response = messages_pb2.ServerMessage()
     response.fuse_response.status.code = common_messages_pb2.Status.ok
@@ -545,6 +744,39 @@ def test_utime_should_pass_utime_errors(endpoint, fl, uuid, stat):
     assert 'Operation not permitted' in str(excinfo.value)
 
 
+def test_utime_should_coalesce_times_updates(appmock_client, endpoint, uuid):
+    fl = fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                              ['--times-write-back-delay', '60'])
+    fh = do_open(endpoint, fl, uuid)
+    appmock_client.reset_tcp_history()
+
+    ubuf = fslogic.Ubuf()
+    for i in range(10):
+        ubuf.actime = 10000 + i
+        ubuf.modtime = 20000 + i
+        fl.utime_buf(uuid, ubuf)
+
+    assert 0 == endpoint.all_messages_count()
+
+    stat = fl.getattr(uuid)
+    assert stat.atime == ubuf.actime
+    assert stat.mtime == ubuf.modtime
+
+    response = messages_pb2.ServerMessage()
+    response.fuse_response.status.code = common_messages_pb2.Status.ok
+
+    with reply(endpoint, [response, response, response]) as queue:
+        fl.release(uuid, fh)
+        client_message = queue.get()
+
+    file_request = client_message.fuse_request.file_request
+    assert file_request.HasField('update_times')
+
+    update_times = file_request.update_times
+    assert update_times.atime == ubuf.actime
+    assert update_times.mtime == ubuf.modtime
+
+
 def test_readdir_should_read_dir(endpoint, fl, uuid, stat):
     #
     # Prepare first response with 5 files
@@ -765,6 +997,28 @@ def test_write_should_pass_helper_errors(endpoint, fl, uuid):
     assert 'Owner died' in str(excinfo.value)
 
 
+def test_write_should_write_stripes_in_parallel(endpoint, uuid):
+    stripe_size = 1024 * 1024
+    size = 64 * stripe_size
+    fl = fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                              ['--write-stripe-size', str(stripe_size),
+                               '--write-stripe-count', '8'])
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    assert size == fl.write(uuid, fh, 0, size)
+
+    assert 64 == fl.sh_write_count()
+    assert size == fl.sh_written_bytes()
+
+    # Stripes may complete in any order, but together cover the write
+    # exactly once
+    ranges = sorted(fl.sh_write_ranges())
+    assert [(i * stripe_size, stripe_size) for i in range(64)] == ranges
+
+    stat = fl.getattr(uuid)
+    assert size == stat.size
+
+
 def test_truncate_should_truncate(endpoint, fl, uuid, stat):
     response = messages_pb2.ServerMessage()
     response.fuse_response.status.code = common_messages_pb2.Status.ok
@@ -965,6 +1219,269 @@ def test_release_should_send_fsync_message(endpoint, fl, uuid):
     assert client_message.fuse_request.file_request.HasField('fsync')
 
 
+def test_release_should_not_fsync_with_fast_release(endpoint, uuid):
+    fl = fslogic.FsLogicProxy(endpoint.ip, endpoint.port, ['--fast-release'])
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    release_response = messages_pb2.ServerMessage()
+    release_response.fuse_response.status.code = common_messages_pb2.Status.ok
+
+    with reply(endpoint, release_response) as queue:
+        fl.release(uuid, fh)
+        client_message = queue.get()
+
+    assert client_message.HasField('fuse_request')
+    assert client_message.fuse_request.HasField('file_request')
+    assert client_message.fuse_request.file_request.HasField('release')
+
+
+def test_release_should_emit_buffered_writes(endpoint, uuid):
+    fl = fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                              ['--fast-release',
+                               '--write-behind-buffer-size', '1024'])
+
+    with send(endpoint, prepare_file_written_subscription(1)):
+        time.sleep(1)
+
+    fh = do_open(endpoint, fl, uuid, size=0)
+    assert 5 == fl.write(uuid, fh, 0, 5)
+    assert 5 == fl.write(uuid, fh, 5, 5)
+
+    with receive(endpoint) as queue:
+        fl.release(uuid, fh)
+        client_message = queue.get()
+        while not client_message.HasField('events'):
+            client_message = queue.get()
+
+    assert client_message.events.events[0].HasField('file_written')
+
+    evt = client_message.events.events[0].file_written
+    assert evt.file_uuid == uuid
+    assert evt.counter == 1
+    assert evt.size == 10
+
+
+def prepare_fsync_response(code=common_messages_pb2.Status.ok):
+    fsync_response = messages_pb2.ServerMessage()
+    fsync_response.fuse_response.status.code = code
+
+    return fsync_response
+
+
+def test_fsync_should_sync_provider_and_storage(endpoint, fl, uuid):
+    fh = do_open(endpoint, fl, uuid, size=10, blocks=[(0, 10)])
+    assert 5 == fl.write(uuid, fh, 0, 5)
+
+    with reply(endpoint, prepare_fsync_response()) as queue:
+        fl.fsync(uuid, fh, False)
+        client_message = queue.get()
+
+    assert client_message.fuse_request.file_request.HasField('fsync')
+    assert 1 == fl.sh_fsync_count()
+
+
+def test_fsync_should_pass_storage_fsync_errors(endpoint, fl, uuid):
+    fh = do_open(endpoint, fl, uuid, size=10, blocks=[(0, 10)])
+    assert 5 == fl.write(uuid, fh, 0, 5)
+
+    fl.failHelperFsyncs(True)
+    with pytest.raises(RuntimeError) as excinfo:
+        with reply(endpoint, prepare_fsync_response()) as queue:
+            fl.fsync(uuid, fh, False)
+
+    # The provider is synced even though the storage fsync fails
+    client_message = queue.get()
+    assert client_message.fuse_request.file_request.HasField('fsync')
+    assert 'Owner died' in str(excinfo.value)
+
+
+def test_fsync_should_pass_provider_fsync_errors(endpoint, fl, uuid):
+    fh = do_open(endpoint, fl, uuid, size=10, blocks=[(0, 10)])
+    assert 5 == fl.write(uuid, fh, 0, 5)
+
+    with pytest.raises(RuntimeError) as excinfo:
+        with reply(endpoint,
+                   prepare_fsync_response(common_messages_pb2.Status.eperm)):
+            fl.fsync(uuid, fh, False)
+
+    # The storage is synced along with the provider, not after it
+    assert 1 == fl.sh_fsync_count()
+    assert 'Operation not permitted' in str(excinfo.value)
+
+
+def write_behind_fslogic(endpoint):
+    return fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                                ['--write-behind-buffer-size', '1024',
+                                 '--write-behind-flush-delay', '60'])
+
+
+def test_write_should_coalesce_adjacent_writes(endpoint, uuid):
+    fl = write_behind_fslogic(endpoint)
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    assert 5 == fl.write(uuid, fh, 0, 5)
+    assert 5 == fl.write(uuid, fh, 5, 5)
+    assert 5 == fl.write(uuid, fh, 10, 5)
+    assert 0 == fl.sh_write_count()
+
+    fl.flush(uuid, fh)
+
+    assert 1 == fl.sh_write_count()
+    assert 15 == fl.sh_written_bytes()
+
+
+def test_write_should_flush_buffer_before_non_adjacent_write(endpoint, uuid):
+    fl = write_behind_fslogic(endpoint)
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    assert 5 == fl.write(uuid, fh, 0, 5)
+    assert 5 == fl.write(uuid, fh, 100, 5)
+    assert 1 == fl.sh_write_count()
+
+    fl.flush(uuid, fh)
+
+    assert 2 == fl.sh_write_count()
+    assert 10 == fl.sh_written_bytes()
+
+
+def test_getattr_should_flush_write_buffer(endpoint, uuid):
+    fl = write_behind_fslogic(endpoint)
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    assert 5 == fl.write(uuid, fh, 0, 5)
+
+    assert 5 == fl.getattr(uuid).size
+    assert 1 == fl.sh_write_count()
+
+
+def test_fsync_should_flush_write_buffer(endpoint, uuid):
+    fl = write_behind_fslogic(endpoint)
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    assert 5 == fl.write(uuid, fh, 0, 5)
+
+    with reply(endpoint, prepare_fsync_response()):
+        fl.fsync(uuid, fh, False)
+
+    assert 1 == fl.sh_write_count()
+    assert 5 == fl.sh_written_bytes()
+
+
+def test_release_should_flush_write_buffer(endpoint, uuid):
+    fl = write_behind_fslogic(endpoint)
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    assert 5 == fl.write(uuid, fh, 0, 5)
+
+    do_release(endpoint, fl, uuid, fh)
+
+    assert 1 == fl.sh_write_count()
+    assert 5 == fl.sh_written_bytes()
+
+
+def test_failed_write_buffer_flush_should_keep_data(endpoint, uuid):
+    fl = write_behind_fslogic(endpoint)
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    assert 5 == fl.write(uuid, fh, 0, 5)
+
+    fl.failHelperWrites(True)
+    with pytest.raises(RuntimeError) as excinfo:
+        fl.flush(uuid, fh)
+
+    assert 'Owner died' in str(excinfo.value)
+    assert 0 == fl.sh_write_count()
+
+    fl.failHelperWrites(False)
+    assert 5 == fl.write(uuid, fh, 100, 5)
+    fl.flush(uuid, fh)
+
+    assert 2 == fl.sh_write_count()
+    assert 10 == fl.sh_written_bytes()
+
+
+def test_open_should_send_open_file_before_fetching_metadata(endpoint, fl,
+                                                           uuid):
+    attr_response = prepare_attr_response(uuid, fuse_messages_pb2.REG)
+    location_response = prepare_location_response(uuid)
+    open_response = prepare_open_response()
+
+    with reply(endpoint, [open_response, attr_response, location_response]) \
+            as queue:
+        assert fl.open(uuid, 0) >= 0
+        open_request = queue.get()
+        attr_request = queue.get()
+        location_request = queue.get()
+
+    assert open_request.fuse_request.file_request.HasField('open_file')
+    assert attr_request.fuse_request.file_request.HasField('get_file_attr')
+    assert location_request.fuse_request.file_request.HasField(
+        'get_file_location')
+
+
+@requires_inline_file_data
+def test_read_should_serve_small_file_from_inline_data(appmock_client,
+                                                      endpoint, uuid):
+    fl = fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                              ['--small-file-inline-size', '1024'])
+
+    attr_response = prepare_attr_response(uuid, fuse_messages_pb2.REG, size=6)
+    location_response = prepare_location_response(uuid, [(0, 6)])
+    open_response = prepare_open_response(inline_data='abcdef')
+
+    with reply(endpoint, [open_response, attr_response, location_response]) \
+            as queue:
+        fh = fl.open(uuid, 0)
+        open_request = queue.get()
+
+    open_file = open_request.fuse_request.file_request.open_file
+    assert open_file.inline_data_size_limit == 1024
+
+    appmock_client.reset_tcp_history()
+
+    assert 'bcd' == fl.read(uuid, fh, 1, 3)
+    assert 0 == endpoint.all_messages_count()
+
+
+def test_open_should_reuse_pooled_handle(appmock_client, endpoint, uuid):
+    fl = fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                              ['--handle-pool-size', '8'])
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    fsync_response = messages_pb2.ServerMessage()
+    fsync_response.fuse_response.status.code = common_messages_pb2.Status.ok
+
+    with reply(endpoint, fsync_response):
+        fl.release(uuid, fh)
+
+    appmock_client.reset_tcp_history()
+
+    handle = fl.open(uuid, 0)
+    assert handle >= 0
+    assert handle != fh
+    assert 0 == endpoint.all_messages_count()
+
+
+def test_attr_change_should_release_pooled_handle(endpoint, uuid):
+    fl = fslogic.FsLogicProxy(endpoint.ip, endpoint.port,
+                              ['--handle-pool-size', '8'])
+    fh = do_open(endpoint, fl, uuid, size=0)
+
+    with reply(endpoint, prepare_fsync_response()):
+        fl.release(uuid, fh)
+
+    with reply(endpoint, prepare_fsync_response()) as queue:
+        with send(endpoint, prepare_file_attr_changed_event(uuid)):
+            client_message = queue.get()
+
+    assert client_message.HasField('fuse_request')
+    assert client_message.fuse_request.HasField('file_request')
+
+    file_request = client_message.fuse_request.file_request
+    assert file_request.HasField('release')
+    assert file_request.context_guid == uuid
+
+
 def test_fslogic_should_handle_processing_status_message(endpoint, fl, uuid):
     getattr_response = prepare_attr_response(uuid, fuse_messages_pb2.DIR)
     rename_response = prepare_rename_response('newUuid')
@@ -13,16 +13,35 @@
 
 #include <gmock/gmock.h>
 
+#include <mutex>
+#include <utility>
+#include <vector>
+
 using ::testing::Invoke;
 using ::testing::Mock;
 using ::testing::Return;
 using ::testing::_;
 
+/**
+ * Writes and fsyncs performed by all handles of a helper.
+ */
+struct NullHelperIO {
+    std::mutex mutex;
+    std::size_t writes = 0;
+    std::size_t writtenBytes = 0;
+    std::vector<std::pair<off_t, std::size_t>> writeRanges;
+    std::error_code writeEc;
+    std::size_t fsyncs = 0;
+    std::error_code fsyncEc;
+};
+
 class NullHelperHandle : public one::helpers::FileHandle {
 public:
-    NullHelperHandle(std::error_code ec)
+    NullHelperHandle(std::error_code ec,
+        std::shared_ptr<NullHelperIO> io = std::make_shared<NullHelperIO>())
         : one::helpers::FileHandle{{}}
         , m_ec{ec}
+        , m_io{std::move(io)}
     {
     }
 
@@ -40,11 +59,19 @@ public:
     }
 
     folly::Future<std::size_t> write(
-        const off_t, folly::IOBufQueue buf) override
+        const off_t offset, folly::IOBufQueue buf) override
     {
         if (m_ec)
             return folly::makeFuture<std::size_t>(std::system_error{m_ec});
 
+        std::lock_guard<std::mutex> guard{m_io->mutex};
+        if (m_io->writeEc)
+            return folly::makeFuture<std::size_t>(
+                std::system_error{m_io->writeEc});
+
+        ++m_io->writes;
+        m_io->writtenBytes += buf.chainLength();
+        m_io->writeRanges.emplace_back(offset, buf.chainLength());
         return buf.chainLength();
     }
 
@@ -69,19 +96,26 @@ public:
         if (m_ec)
             return folly::makeFuture<folly::Unit>(std::system_error{m_ec});
 
+        std::lock_guard<std::mutex> guard{m_io->mutex};
+        ++m_io->fsyncs;
+        if (m_io->fsyncEc)
+            return folly::makeFuture<folly::Unit>(
+                std::system_error{m_io->fsyncEc});
+
         return folly::makeFuture();
     }
 
     const one::helpers::Timeout &timeout() override { return m_timeout; }
 
     std::error_code m_ec;
+    std::shared_ptr<NullHelperIO> m_io;
     one::helpers::Timeout m_timeout{60};
 };
 
 struct NullHelperHandleMock : public NullHelperHandle {
-    NullHelperHandleMock(std::error_code ec)
-        : NullHelperHandle{ec}
-        , m_real{ec}
+    NullHelperHandleMock(std::error_code ec, std::shared_ptr<NullHelperIO> io)
+        : NullHelperHandle{ec, io}
+        , m_real{ec, io}
     {
         ON_CALL(*this, release())
             .WillByDefault(Invoke(&m_real, &one::helpers::FileHandle::release));
@@ -229,7 +263,7 @@ public:
                 std::system_error{m_ec});
 
         m_handles.insert(std::make_pair(
-            fileId, std::make_shared<NullHelperHandleMock>(m_ec)));
+            fileId, std::make_shared<NullHelperHandleMock>(m_ec, m_io)));
 
         return folly::makeFuture(
             static_cast<one::helpers::FileHandlePtr>(m_handles[fileId]));
@@ -241,6 +275,7 @@ public:
     one::helpers::Timeout m_timeout{60};
     std::unordered_map<folly::fbstring, std::shared_ptr<NullHelperHandleMock>>
         m_handles;
+    std::shared_ptr<NullHelperIO> m_io = std::make_shared<NullHelperIO>();
 };
 
 struct NullHelperMock : public NullHelper {
@@ -264,8 +299,8 @@ struct NullHelperMock : public NullHelper {
 
     void expect_call_sh_release(folly::fbstring filename, int times)
     {
-        m_real.m_handles.insert(std::make_pair(
-            filename, std::make_shared<NullHelperHandleMock>(m_ec)));
+        m_real.m_handles.insert(std::make_pair(filename,
+            std::make_shared<NullHelperHandleMock>(m_ec, m_real.m_io)));
         EXPECT_CALL(*m_real.m_handles[filename], release()).Times(times);
     }
 
@@ -285,6 +320,42 @@ struct NullHelperMock : public NullHelper {
             ha.second->m_real.m_ec = ec;
     }
 
+    void set_write_ec(std::error_code ec)
+    {
+        std::lock_guard<std::mutex> guard{m_real.m_io->mutex};
+        m_real.m_io->writeEc = ec;
+    }
+
+    std::size_t write_count()
+    {
+        std::lock_guard<std::mutex> guard{m_real.m_io->mutex};
+        return m_real.m_io->writes;
+    }
+
+    std::size_t written_bytes()
+    {
+        std::lock_guard<std::mutex> guard{m_real.m_io->mutex};
+        return m_real.m_io->writtenBytes;
+    }
+
+    std::vector<std::pair<off_t, std::size_t>> write_ranges()
+    {
+        std::lock_guard<std::mutex> guard{m_real.m_io->mutex};
+        return m_real.m_io->writeRanges;
+    }
+
+    void set_fsync_ec(std::error_code ec)
+    {
+        std::lock_guard<std::mutex> guard{m_real.m_io->mutex};
+        m_real.m_io->fsyncEc = ec;
+    }
+
+    std::size_t fsync_count()
+    {
+        std::lock_guard<std::mutex> guard{m_real.m_io->mutex};
+        return m_real.m_io->fsyncs;
+    }
+
     MOCK_METHOD3(open,
         folly::Future<one::helpers::FileHandlePtr>(
             const folly::fbstring &, const int, const one::helpers::Params &));
@@ -0,0 +1,144 @@
+/**
+ * @file helper_handle_registry_test.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "cache/helperHandleRegistry.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+
+using namespace ::testing;
+using namespace one;
+using namespace one::client::cache;
+
+namespace {
+
+class TestHandle : public helpers::FileHandle {
+public:
+    TestHandle()
+        : helpers::FileHandle{"fileId"}
+    {
+    }
+
+    folly::Future<folly::IOBufQueue> read(
+        const off_t, const std::size_t) override
+    {
+        return folly::IOBufQueue{folly::IOBufQueue::cacheChainLength()};
+    }
+
+    folly::Future<std::size_t> write(
+        const off_t, folly::IOBufQueue buf) override
+    {
+        return buf.chainLength();
+    }
+
+    folly::Future<folly::Unit> release() override
+    {
+        return folly::makeFuture();
+    }
+
+    folly::Future<folly::Unit> flush() override { return folly::makeFuture(); }
+
+    folly::Future<folly::Unit> fsync(bool) override
+    {
+        return folly::makeFuture();
+    }
+
+    const helpers::Timeout &timeout() override { return m_timeout; }
+
+private:
+    helpers::Timeout m_timeout{60};
+};
+
+} // namespace
+
+class HelperHandleRegistryTest : public ::testing::Test {
+protected:
+    folly::Future<helpers::FileHandlePtr> open()
+    {
+        ++opens;
+        return folly::makeFuture<helpers::FileHandlePtr>(
+            std::make_shared<TestHandle>());
+    }
+
+    HelperHandleRegistry::Key key{"storageId", "fileId", O_RDONLY, false};
+    int opens = 0;
+    HelperHandleRegistry registry;
+};
+
+TEST_F(HelperHandleRegistryTest, acquireShouldOpenHandleOnce)
+{
+    auto handle1 = registry.acquire(key, [this] { return open(); }).get();
+    auto handle2 = registry.acquire(key, [this] { return open(); }).get();
+
+    EXPECT_EQ(1, opens);
+    EXPECT_EQ(handle1, handle2);
+    EXPECT_EQ(1, registry.size());
+}
+
+TEST_F(HelperHandleRegistryTest, acquireShouldNotShareHandlesWithOtherFlags)
+{
+    HelperHandleRegistry::Key otherKey{"storageId", "fileId", O_RDWR, false};
+
+    auto handle1 = registry.acquire(key, [this] { return open(); }).get();
+    auto handle2 = registry.acquire(otherKey, [this] { return open(); }).get();
+
+    EXPECT_EQ(2, opens);
+    EXPECT_NE(handle1, handle2);
+}
+
+TEST_F(HelperHandleRegistryTest, releaseShouldReturnTrueOnLastReference)
+{
+    auto handle = registry.acquire(key, [this] { return open(); }).get();
+    registry.acquire(key, [this] { return open(); }).get();
+
+    EXPECT_FALSE(registry.release(key, handle));
+    EXPECT_TRUE(registry.release(key, handle));
+    EXPECT_EQ(0, registry.size());
+}
+
+TEST_F(HelperHandleRegistryTest, acquireShouldNotKeepFailedOpens)
+{
+    auto failed = registry.acquire(key, [] {
+        return folly::makeFuture<helpers::FileHandlePtr>(
+            std::system_error{std::make_error_code(std::errc::io_error)});
+    });
+
+    EXPECT_THROW(failed.get(), std::system_error);
+    EXPECT_EQ(0, registry.size());
+
+    registry.acquire(key, [this] { return open(); }).get();
+    EXPECT_EQ(1, opens);
+}
+
+TEST_F(HelperHandleRegistryTest, invalidateShouldStopSharingHandle)
+{
+    auto handle1 = registry.acquire(key, [this] { return open(); }).get();
+    registry.acquire(key, [this] { return open(); }).get();
+
+    registry.invalidate(key, handle1);
+    auto handle2 = registry.acquire(key, [this] { return open(); }).get();
+
+    EXPECT_EQ(2, opens);
+    EXPECT_NE(handle1, handle2);
+
+    EXPECT_FALSE(registry.release(key, handle1));
+    EXPECT_TRUE(registry.release(key, handle1));
+    EXPECT_TRUE(registry.release(key, handle2));
+}
+
+TEST_F(HelperHandleRegistryTest, acquireShouldNotShareHandlesOfOtherIOPath)
+{
+    HelperHandleRegistry::Key proxyKey{"storageId", "fileId", O_RDONLY, true};
+
+    auto handle1 = registry.acquire(key, [this] { return open(); }).get();
+    auto handle2 = registry.acquire(proxyKey, [this] { return open(); }).get();
+
+    EXPECT_EQ(2, opens);
+    EXPECT_NE(handle1, handle2);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file io_path_selector_test.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "cache/ioPathSelector.h"
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using namespace one::client::cache;
+using namespace std::literals;
+
+namespace {
+
+constexpr std::size_t MiB = 1024 * 1024;
+
+std::chrono::nanoseconds transferTime(
+    const std::size_t bytes, const double bytesPerSecond)
+{
+    return std::chrono::nanoseconds{
+        static_cast<std::int64_t>(bytes * 1e9 / bytesPerSecond)};
+}
+
+} // namespace
+
+struct IOPathSelectorTest : public ::testing::Test {
+    // Records operations on a path with a given throughput, returning
+    // whether any of them switched the selected path
+    bool record(const bool proxyIO, const std::size_t count,
+        const double bytesPerSecond, const std::size_t bytes = MiB)
+    {
+        bool switched = false;
+        for (std::size_t i = 0; i < count; ++i)
+            switched |= selector.recordIO(
+                proxyIO, bytes, transferTime(bytes, bytesPerSecond), now);
+
+        return switched;
+    }
+
+    IOPathSelector selector;
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+};
+
+TEST_F(IOPathSelectorTest, selectProxyIOShouldExploreEvery16thHandle)
+{
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 15; ++i)
+            EXPECT_FALSE(selector.selectProxyIO());
+
+        EXPECT_TRUE(selector.selectProxyIO());
+    }
+}
+
+TEST_F(IOPathSelectorTest, recordIOShouldRequireMinSamplesOnBothPaths)
+{
+    EXPECT_FALSE(record(true, 8, 100 * MiB));
+    EXPECT_FALSE(record(false, 7, 10 * MiB));
+    EXPECT_FALSE(selector.proxySelected());
+
+    EXPECT_TRUE(record(false, 1, 10 * MiB));
+    EXPECT_TRUE(selector.proxySelected());
+}
+
+TEST_F(IOPathSelectorTest, recordIOShouldRequireSwitchRatio)
+{
+    EXPECT_FALSE(record(false, 8, 10 * MiB));
+    EXPECT_FALSE(record(true, 8, 14 * MiB));
+    EXPECT_FALSE(selector.proxySelected());
+
+    EXPECT_TRUE(record(true, 8, 30 * MiB));
+    EXPECT_TRUE(selector.proxySelected());
+}
+
+TEST_F(IOPathSelectorTest, recordIOShouldNotSwitchAgainWithinDwellTime)
+{
+    EXPECT_FALSE(record(false, 8, 10 * MiB));
+    EXPECT_TRUE(record(true, 8, 20 * MiB));
+
+    now += 29s;
+    EXPECT_FALSE(record(false, 16, 100 * MiB));
+    EXPECT_TRUE(selector.proxySelected());
+
+    now += 1s;
+    EXPECT_TRUE(record(false, 1, 100 * MiB));
+    EXPECT_FALSE(selector.proxySelected());
+}
+
+TEST_F(IOPathSelectorTest, recordIOShouldCompareOnlySameSizeOperations)
+{
+    // Small operations are slower only due to latency, so they mustn't be
+    // compared with large operations of the other path
+    EXPECT_FALSE(record(false, 8, 1 * MiB, 4096));
+    EXPECT_FALSE(record(true, 8, 50 * MiB, 16 * MiB));
+    EXPECT_FALSE(selector.proxySelected());
+
+    EXPECT_TRUE(record(true, 8, 2 * MiB, 4096));
+    EXPECT_TRUE(selector.proxySelected());
+}
+
+TEST_F(IOPathSelectorTest, selectProxyIOShouldFollowSelectedPath)
+{
+    record(false, 8, 10 * MiB);
+    record(true, 8, 20 * MiB);
+
+    for (int i = 0; i < 15; ++i)
+        EXPECT_TRUE(selector.selectProxyIO());
+
+    EXPECT_FALSE(selector.selectProxyIO());
+}
+
+TEST_F(IOPathSelectorTest, recordIOShouldIgnoreEmptyOperations)
+{
+    EXPECT_FALSE(selector.recordIO(true, 0, 1ns, now));
+    EXPECT_EQ(0, selector.throughput(true, 0));
+}
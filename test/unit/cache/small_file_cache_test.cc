@@ -0,0 +1,84 @@
+/**
+ * @file small_file_cache_test.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "cache/smallFileCache.h"
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using namespace one::client::cache;
+
+class SmallFileCacheTest : public ::testing::Test {
+protected:
+    std::chrono::system_clock::time_point mtime{std::chrono::seconds{100}};
+    SmallFileCache smallFileCache{10};
+};
+
+TEST_F(SmallFileCacheTest, getShouldReturnNullIfFileNotCached)
+{
+    EXPECT_FALSE(smallFileCache.get("uuid", 5, mtime));
+}
+
+TEST_F(SmallFileCacheTest, getShouldReturnCachedContents)
+{
+    smallFileCache.put("uuid", "abcde", mtime);
+
+    auto data = smallFileCache.get("uuid", 5, mtime);
+    ASSERT_TRUE(data);
+    EXPECT_EQ("abcde", *data);
+    EXPECT_EQ(5, smallFileCache.size());
+}
+
+TEST_F(SmallFileCacheTest, getShouldDropContentsOnSizeMismatch)
+{
+    smallFileCache.put("uuid", "abcde", mtime);
+
+    EXPECT_FALSE(smallFileCache.get("uuid", 6, mtime));
+    EXPECT_FALSE(smallFileCache.get("uuid", 5, mtime));
+    EXPECT_EQ(0, smallFileCache.size());
+}
+
+TEST_F(SmallFileCacheTest, getShouldDropContentsOnMtimeMismatch)
+{
+    smallFileCache.put("uuid", "abcde", mtime);
+
+    EXPECT_FALSE(
+        smallFileCache.get("uuid", 5, mtime + std::chrono::seconds{1}));
+    EXPECT_EQ(0, smallFileCache.size());
+}
+
+TEST_F(SmallFileCacheTest, putShouldNotStoreContentsExceedingCapacity)
+{
+    smallFileCache.put("uuid", "abcdefghijk", mtime);
+
+    EXPECT_FALSE(smallFileCache.get("uuid", 11, mtime));
+    EXPECT_EQ(0, smallFileCache.size());
+}
+
+TEST_F(SmallFileCacheTest, putShouldEvictLeastRecentlyUsedContents)
+{
+    smallFileCache.put("uuid1", "abcd", mtime);
+    smallFileCache.put("uuid2", "efgh", mtime);
+    ASSERT_TRUE(smallFileCache.get("uuid1", 4, mtime));
+
+    smallFileCache.put("uuid3", "ijkl", mtime);
+
+    EXPECT_TRUE(smallFileCache.get("uuid1", 4, mtime));
+    EXPECT_FALSE(smallFileCache.get("uuid2", 4, mtime));
+    EXPECT_TRUE(smallFileCache.get("uuid3", 4, mtime));
+    EXPECT_EQ(8, smallFileCache.size());
+}
+
+TEST_F(SmallFileCacheTest, eraseShouldRemoveContents)
+{
+    smallFileCache.put("uuid", "abcde", mtime);
+    smallFileCache.erase("uuid");
+
+    EXPECT_FALSE(smallFileCache.get("uuid", 5, mtime));
+    EXPECT_EQ(0, smallFileCache.size());
+}
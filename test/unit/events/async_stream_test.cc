@@ -9,12 +9,19 @@
 #include "mocks/stream_mock.h"
 #include "utils.h"
 
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace one::client::events;
 
 struct AsyncStreamTest : public ::testing::Test {
     MockAsyncStream *mockStream = new MockAsyncStream();
     std::size_t threadId = mockStream->hasher(std::this_thread::get_id());
-    AsyncStream stream{std::unique_ptr<MockAsyncStream>(mockStream)};
+    StreamExecutor executor;
+    AsyncStream stream{
+        std::unique_ptr<MockAsyncStream>(mockStream), executor};
 };
 
 TEST_F(AsyncStreamTest, processShouldForwardCall)
@@ -30,3 +37,84 @@ TEST_F(AsyncStreamTest, flushShouldForwardCall)
     ASSERT_TRUE(this->mockStream->flushCalled.get_future().get());
     ASSERT_NE(this->threadId, this->mockStream->threadId.get_future().get());
 }
+
+struct RecordingStream : public Stream {
+    RecordingStream(std::shared_future<void> unblocked_)
+        : unblocked{std::move(unblocked_)}
+    {
+    }
+
+    void process(EventPtr<> event) override
+    {
+        unblocked.wait();
+        keys.emplace_back(event->aggregationKey());
+    }
+
+    void flush() override { flushed.set_value(); }
+
+    void flush(const AggregationKey &key) override {}
+
+    std::shared_future<void> unblocked;
+    std::vector<AggregationKey> keys;
+    std::promise<void> flushed;
+};
+
+struct AsyncStreamOverflowTest : public ::testing::Test {
+    std::promise<void> unblock;
+    RecordingStream *recordingStream =
+        new RecordingStream{unblock.get_future().share()};
+    StreamExecutor executor;
+    AsyncStream stream{
+        std::unique_ptr<RecordingStream>(recordingStream), executor, 2};
+
+    const std::vector<AggregationKey> &processedKeys()
+    {
+        stream.flush();
+        recordingStream->flushed.get_future().wait();
+        return recordingStream->keys;
+    }
+};
+
+TEST_F(AsyncStreamOverflowTest, spilledEventsShouldBeProcessedInOrder)
+{
+    for (int i = 0; i < 100; ++i)
+        this->stream.process(std::make_unique<TestFileRead>(std::to_string(i)));
+
+    this->unblock.set_value();
+
+    const auto &keys = this->processedKeys();
+    ASSERT_EQ(100u, keys.size());
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(std::to_string(i), keys[i]);
+}
+
+TEST_F(AsyncStreamOverflowTest, eventsOfEachProducerShouldBeProcessedInOrder)
+{
+    constexpr int producerCount = 4;
+    constexpr int eventCount = 1000;
+
+    this->unblock.set_value();
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; ++p) {
+        producers.emplace_back([this, p] {
+            for (int i = 0; i < eventCount; ++i)
+                this->stream.process(std::make_unique<TestFileRead>(
+                    std::to_string(p) + ":" + std::to_string(i)));
+        });
+    }
+
+    for (auto &producer : producers)
+        producer.join();
+
+    const auto &keys = this->processedKeys();
+    ASSERT_EQ(static_cast<std::size_t>(producerCount * eventCount),
+        keys.size());
+
+    std::vector<int> next(producerCount, 0);
+    for (const auto &key : keys) {
+        const auto separator = key.find(':');
+        const auto p = std::stoi(key.substr(0, separator));
+        EXPECT_EQ(std::to_string(next[p]++), key.substr(separator + 1));
+    }
+}
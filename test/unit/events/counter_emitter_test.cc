@@ -78,3 +78,11 @@ TYPED_TEST(CounterEmitterTest, resetShouldForwardCall)
     this->emitter.reset();
     ASSERT_TRUE(this->mockEmitter->resetCalled);
 }
+
+TEST(CounterEmitterAggregationTest, processShouldCountAggregatedOperations)
+{
+    CounterEmitter<FileRead> emitter{3};
+    emitter.process(
+        std::make_unique<FileRead>("1", 3, 30, FileRead::FileBlocksMap{}));
+    ASSERT_TRUE(emitter.ready());
+}
@@ -11,6 +11,8 @@
 #include "mocks/manager_mock.h"
 #include "utils.h"
 
+#include <future>
+
 using namespace ::testing;
 using namespace one::client;
 using namespace one::client::cache;
@@ -35,8 +37,22 @@ struct FsSubscriptionsTest : public ::testing::Test {
     MockManager mockManager{context};
     LRUMetadataCache metadataCache{*context->communicator(), 10000, 60s};
     ForceProxyIOCache forceProxyIOCache;
-    FsSubscriptions fsSubscriptions{
-        mockManager, metadataCache, forceProxyIOCache, [](auto) {}};
+    FsSubscriptions fsSubscriptions{mockManager, metadataCache,
+        forceProxyIOCache, [](auto) {}, *context->scheduler()};
+    FsSubscriptions batchedFsSubscriptions{mockManager, metadataCache,
+        forceProxyIOCache, [](auto) {}, *context->scheduler(), 1min};
+};
+
+struct FsSubscriptionsBatchTest : public FsSubscriptionsTest {
+    // Waits for a subscription change applied by the scheduled batch
+    template <typename T> void waitFor(std::future<T> applied)
+    {
+        ASSERT_EQ(std::future_status::ready, applied.wait_for(5s));
+    }
+
+    one::Scheduler scheduler{1};
+    FsSubscriptions scheduledFsSubscriptions{mockManager, metadataCache,
+        forceProxyIOCache, [](auto f) { f(); }, scheduler, 10ms};
 };
 
 TEST_F(FsSubscriptionsTest, subscribeFileAttrChangedShouldSubscribeOnce)
@@ -173,3 +189,53 @@ TEST_F(FsSubscriptionsTest, subscribeFileRenamedShouldUseProperStream)
     this->fsSubscriptions.subscribeFileRenamed("fileUuid");
     ASSERT_EQ(StreamKey::FILE_RENAMED, this->streamKey);
 }
+
+TEST_F(FsSubscriptionsTest, batchedSubscriptionShouldCancelOutWithUnsubscribe)
+{
+    EXPECT_CALL(this->mockManager, subscribe(_)).Times(0);
+    EXPECT_CALL(this->mockManager, unsubscribe(_)).Times(0);
+    this->batchedFsSubscriptions.subscribeFileAttrChanged("fileUuid");
+    ASSERT_TRUE(
+        this->batchedFsSubscriptions.unsubscribeFileAttrChanged("fileUuid"));
+    ASSERT_FALSE(
+        this->batchedFsSubscriptions.unsubscribeFileAttrChanged("fileUuid"));
+}
+
+TEST_F(FsSubscriptionsBatchTest, batchedSubscriptionShouldBeAppliedAfterDelay)
+{
+    std::promise<void> subscribed;
+    EXPECT_CALL(this->mockManager, subscribe(_))
+        .WillOnce(InvokeWithoutArgs([&] {
+            subscribed.set_value();
+            return 1;
+        }));
+
+    this->scheduledFsSubscriptions.subscribeFileAttrChanged("fileUuid");
+    this->scheduledFsSubscriptions.subscribeFileAttrChanged("fileUuid");
+    this->waitFor(subscribed.get_future());
+}
+
+TEST_F(FsSubscriptionsBatchTest, batchedUnsubscriptionShouldBeApplied)
+{
+    std::promise<void> subscribed;
+    std::promise<void> unsubscribed;
+    EXPECT_CALL(this->mockManager, subscribe(_))
+        .WillOnce(InvokeWithoutArgs([&] {
+            subscribed.set_value();
+            return 1;
+        }));
+    EXPECT_CALL(this->mockManager, unsubscribe(1))
+        .WillOnce(InvokeWithoutArgs([&] {
+            unsubscribed.set_value();
+            return true;
+        }));
+
+    this->scheduledFsSubscriptions.subscribeFileAttrChanged("fileUuid");
+    this->waitFor(subscribed.get_future());
+
+    ASSERT_TRUE(
+        this->scheduledFsSubscriptions.unsubscribeFileAttrChanged("fileUuid"));
+    ASSERT_FALSE(
+        this->scheduledFsSubscriptions.unsubscribeFileAttrChanged("fileUuid"));
+    this->waitFor(unsubscribed.get_future());
+}
@@ -30,6 +30,15 @@ TYPED_TEST(KeyAggregatorTest, processShouldNotAggregateEventsWithDifferentKeys)
     ASSERT_EQ(2, this->aggregator.flush().size());
 }
 
+TYPED_TEST(KeyAggregatorTest, flushKeyShouldReturnOnlyEventsWithTheKey)
+{
+    this->aggregator.process(std::make_unique<TypeParam>("1"));
+    this->aggregator.process(std::make_unique<TypeParam>("2"));
+    ASSERT_EQ(1, this->aggregator.flush("1").size());
+    ASSERT_TRUE(this->aggregator.flush("1").empty());
+    ASSERT_EQ(1, this->aggregator.flush().size());
+}
+
 TYPED_TEST(KeyAggregatorTest, flushShouldBeEmpty)
 {
     ASSERT_TRUE(this->aggregator.flush().empty());
@@ -53,3 +53,11 @@ TYPED_TEST(TypedStreamTest, flushShouldFlushStream)
     ASSERT_TRUE(this->mockAggregator->flushCalled);
     ASSERT_TRUE(this->mockHandler->processCalled);
 }
+
+TYPED_TEST(TypedStreamTest, flushKeyShouldNotResetEmitter)
+{
+    this->stream.flush("1");
+    ASSERT_FALSE(this->mockEmitter->resetCalled);
+    ASSERT_FALSE(this->mockAggregator->flushCalled);
+    ASSERT_TRUE(this->mockAggregator->flushKeyCalled);
+}
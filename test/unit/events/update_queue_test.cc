@@ -0,0 +1,108 @@
+/**
+ * @file update_queue_test.cc
+ * @author Krzysztof Trzepla
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "events/updateQueue.h"
+#include "utils.h"
+
+#include <deque>
+
+using namespace ::testing;
+using namespace one::client::events;
+
+struct UpdateQueueTest : public ::testing::Test {
+    // Runs queued fiber tasks one after another, as the main fiber does
+    void runFiber()
+    {
+        while (!tasks.empty()) {
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            task();
+        }
+    }
+
+    Events<FileRead> fileReads(std::vector<std::string> uuids)
+    {
+        Events<FileRead> events;
+        for (auto &uuid : uuids)
+            events.emplace_back(std::make_unique<TestFileRead>(uuid));
+        return events;
+    }
+
+    std::deque<folly::Function<void()>> tasks;
+    std::vector<std::string> applied;
+    std::vector<std::size_t> counters;
+    UpdateQueue<FileRead> queue{
+        [this](folly::Function<void()> task) {
+            tasks.emplace_back(std::move(task));
+        },
+        [this](const FileRead &event) {
+            applied.emplace_back(event.aggregationKey());
+            counters.emplace_back(event.counter());
+        },
+        2};
+};
+
+TEST_F(UpdateQueueTest, pushShouldAggregateEventsWithTheSameKey)
+{
+    this->queue.push(this->fileReads({"1", "1"}));
+    this->queue.push(this->fileReads({"1"}));
+    this->runFiber();
+
+    ASSERT_EQ(std::vector<std::string>({"1"}), this->applied);
+    ASSERT_EQ(std::vector<std::size_t>({3}), this->counters);
+}
+
+TEST_F(UpdateQueueTest, pushShouldScheduleSingleTaskForPendingEvents)
+{
+    this->queue.push(this->fileReads({"1"}));
+    this->queue.push(this->fileReads({"2"}));
+    ASSERT_EQ(1u, this->tasks.size());
+}
+
+TEST_F(UpdateQueueTest, eventsShouldBeAppliedInOrderOfTheirKeys)
+{
+    this->queue.push(this->fileReads({"3", "1"}));
+    this->queue.push(this->fileReads({"3", "2"}));
+    this->runFiber();
+
+    ASSERT_EQ(std::vector<std::string>({"3", "1", "2"}), this->applied);
+}
+
+TEST_F(UpdateQueueTest, taskShouldApplyAtMostBudgetOfEvents)
+{
+    this->queue.push(this->fileReads({"1", "2", "3", "4", "5"}));
+
+    auto task = std::move(this->tasks.front());
+    this->tasks.pop_front();
+    task();
+
+    ASSERT_EQ(std::vector<std::string>({"1", "2"}), this->applied);
+    ASSERT_EQ(1u, this->tasks.size());
+}
+
+TEST_F(UpdateQueueTest, remainingEventsShouldBeRequeuedAfterWaitingTasks)
+{
+    this->queue.push(this->fileReads({"1", "2", "3"}));
+    this->tasks.emplace_back([this] { this->applied.emplace_back("other"); });
+    this->runFiber();
+
+    ASSERT_EQ(
+        std::vector<std::string>({"1", "2", "other", "3"}), this->applied);
+    ASSERT_TRUE(this->tasks.empty());
+}
+
+TEST_F(UpdateQueueTest, pushAfterApplyShouldScheduleNewTask)
+{
+    this->queue.push(this->fileReads({"1"}));
+    this->runFiber();
+    this->queue.push(this->fileReads({"1"}));
+    this->runFiber();
+
+    ASSERT_EQ(std::vector<std::string>({"1", "1"}), this->applied);
+    ASSERT_EQ(std::vector<std::size_t>({1, 1}), this->counters);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file direct_io_reprober_test.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "fslogic/directIOReprober.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+
+#include <memory>
+#include <vector>
+
+using namespace ::testing;
+using namespace one::client::fslogic;
+using namespace std::literals;
+
+struct DirectIOReproberTest : public ::testing::Test {
+    struct ScheduledTask {
+        std::chrono::seconds delay;
+        std::function<void()> task;
+        std::shared_ptr<bool> cancelled = std::make_shared<bool>(false);
+    };
+
+    std::unique_ptr<DirectIOReprober> create(const std::chrono::seconds delay)
+    {
+        return std::make_unique<DirectIOReprober>(delay,
+            [this](auto delay, auto task) {
+                tasks.push_back(ScheduledTask{delay, std::move(task)});
+                auto cancelled = tasks.back().cancelled;
+                return [cancelled] { *cancelled = true; };
+            },
+            [](auto task) { task(); },
+            [this](const folly::fbstring &uuid, const int flags) {
+                probes.emplace_back(uuid, flags);
+                return probeResult;
+            },
+            [this](const folly::fbstring &uuid) { lifted.push_back(uuid); });
+    }
+
+    // Runs the most recently scheduled task as the scheduler would
+    void runLastTask()
+    {
+        ASSERT_FALSE(tasks.empty());
+        auto task = tasks.back().task;
+        task();
+    }
+
+    std::vector<ScheduledTask> tasks;
+    std::vector<std::pair<folly::fbstring, int>> probes;
+    std::vector<folly::fbstring> lifted;
+    bool probeResult = false;
+};
+
+TEST_F(DirectIOReproberTest, startShouldScheduleSingleRetryWithInitialDelay)
+{
+    auto reprober = create(60s);
+
+    reprober->start("uuid", O_RDWR);
+    reprober->start("uuid", O_RDWR);
+
+    ASSERT_EQ(1u, tasks.size());
+    EXPECT_EQ(60s, tasks[0].delay);
+    EXPECT_TRUE(reprober->scheduled("uuid"));
+    EXPECT_FALSE(reprober->scheduled("otherUuid"));
+}
+
+TEST_F(DirectIOReproberTest, startShouldNotScheduleWithZeroDelay)
+{
+    auto reprober = create(0s);
+
+    reprober->start("uuid", O_RDWR);
+
+    EXPECT_TRUE(tasks.empty());
+    EXPECT_FALSE(reprober->scheduled("uuid"));
+}
+
+TEST_F(DirectIOReproberTest, failedProbesShouldDoubleDelayUpToMaxDelay)
+{
+    auto reprober = create(60s);
+    reprober->start("uuid", O_RDONLY);
+
+    for (int i = 0; i < 8; ++i)
+        runLastTask();
+
+    std::vector<std::chrono::seconds> delays;
+    for (const auto &task : tasks)
+        delays.emplace_back(task.delay);
+
+    EXPECT_EQ(std::vector<std::chrono::seconds>(
+                  {60s, 120s, 240s, 480s, 960s, 1920s, 3600s, 3600s, 3600s}),
+        delays);
+    EXPECT_EQ(3600s, DirectIOReprober::MAX_DELAY);
+
+    ASSERT_EQ(8u, probes.size());
+    EXPECT_EQ("uuid", probes[0].first);
+    EXPECT_EQ(O_RDONLY, probes[0].second);
+    EXPECT_TRUE(lifted.empty());
+    EXPECT_TRUE(reprober->scheduled("uuid"));
+}
+
+TEST_F(DirectIOReproberTest, successfulProbeShouldLiftForcedProxyIO)
+{
+    auto reprober = create(60s);
+    reprober->start("uuid", O_RDWR);
+    runLastTask();
+
+    probeResult = true;
+    runLastTask();
+
+    ASSERT_EQ(1u, lifted.size());
+    EXPECT_EQ("uuid", lifted[0]);
+    EXPECT_EQ(2u, tasks.size());
+    EXPECT_FALSE(reprober->scheduled("uuid"));
+}
+
+TEST_F(DirectIOReproberTest, cancelShouldStopRetries)
+{
+    auto reprober = create(60s);
+    reprober->start("uuid", O_RDWR);
+
+    reprober->cancel("uuid");
+    EXPECT_TRUE(*tasks[0].cancelled);
+    EXPECT_FALSE(reprober->scheduled("uuid"));
+
+    // A task which already started when cancelled must not probe
+    runLastTask();
+    EXPECT_TRUE(probes.empty());
+    EXPECT_EQ(1u, tasks.size());
+}
+
+TEST_F(DirectIOReproberTest, destructorShouldCancelRetries)
+{
+    auto reprober = create(60s);
+    reprober->start("uuid1", O_RDWR);
+    reprober->start("uuid2", O_RDWR);
+
+    reprober.reset();
+
+    ASSERT_EQ(2u, tasks.size());
+    EXPECT_TRUE(*tasks[0].cancelled);
+    EXPECT_TRUE(*tasks[1].cancelled);
+}
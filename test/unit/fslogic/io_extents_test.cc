@@ -0,0 +1,73 @@
+/**
+ * @file io_extents_test.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "fslogic/fuseFileHandle.h"
+
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using namespace one::client::fslogic;
+
+TEST(IOExtentsTest, newExtentsShouldBeEmpty)
+{
+    IOExtents extents;
+    EXPECT_TRUE(extents.empty());
+    EXPECT_EQ(0u, extents.counter);
+    EXPECT_EQ(0u, extents.bytes);
+    EXPECT_TRUE(extents.extents.empty());
+}
+
+TEST(IOExtentsTest, addShouldCountEveryOperation)
+{
+    IOExtents extents;
+    extents.add(0, 5, "s1", "f1");
+    extents.add(5, 5, "s1", "f1");
+    extents.add(100, 20, "s1", "f1");
+
+    EXPECT_FALSE(extents.empty());
+    EXPECT_EQ(3u, extents.counter);
+    EXPECT_EQ(30u, extents.bytes);
+}
+
+TEST(IOExtentsTest, addShouldExtendLastExtentOnSequentialAccess)
+{
+    IOExtents extents;
+    extents.add(0, 5, "s1", "f1");
+    extents.add(5, 10, "s1", "f1");
+
+    ASSERT_EQ(1u, extents.extents.size());
+    EXPECT_EQ(0, extents.extents[0].offset);
+    EXPECT_EQ(15, extents.extents[0].end);
+}
+
+TEST(IOExtentsTest, addShouldStartNewExtentAfterGap)
+{
+    IOExtents extents;
+    extents.add(0, 5, "s1", "f1");
+    extents.add(10, 5, "s1", "f1");
+
+    ASSERT_EQ(2u, extents.extents.size());
+    EXPECT_EQ(5, extents.extents[0].end);
+    EXPECT_EQ(10, extents.extents[1].offset);
+    EXPECT_EQ(15, extents.extents[1].end);
+}
+
+TEST(IOExtentsTest, addShouldStartNewExtentOnDifferentStorageOrFile)
+{
+    IOExtents extents;
+    extents.add(0, 5, "s1", "f1");
+    extents.add(5, 5, "s2", "f1");
+    extents.add(10, 5, "s2", "f2");
+
+    ASSERT_EQ(3u, extents.extents.size());
+    EXPECT_EQ("s1", extents.extents[0].storageId);
+    EXPECT_EQ("s2", extents.extents[1].storageId);
+    EXPECT_EQ("f1", extents.extents[1].fileId);
+    EXPECT_EQ("f2", extents.extents[2].fileId);
+    EXPECT_EQ(15u, extents.bytes);
+}
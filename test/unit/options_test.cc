@@ -94,6 +94,7 @@ TEST_F(OptionsTest, getOptionShouldReturnDefaultValue)
     EXPECT_EQ(false, options.isMonitoringLevelFull());
     EXPECT_EQ(false, options.areFileReadEventsDisabled());
     EXPECT_EQ(false, options.isFullblockReadForced());
+    EXPECT_EQ(false, options.areCompoundFileRequestsEnabled());
     EXPECT_EQ(true, options.isMonitoringLevelBasic());
 #if !defined(NDEBUG)
     EXPECT_EQ(0, options.getVerboseLogLevel());
@@ -109,9 +110,20 @@ TEST_F(OptionsTest, getOptionShouldReturnDefaultValue)
         options.getSchedulerThreadCount());
     EXPECT_EQ(options::DEFAULT_STORAGE_HELPER_THREAD_COUNT,
         options.getStorageHelperThreadCount());
+    EXPECT_EQ(options::DEFAULT_STORAGE_EXECUTOR_THREAD_COUNT,
+        options.getStorageExecutorThreadCount());
+    EXPECT_EQ(options::DEFAULT_STORAGE_EXECUTOR_QUEUE_DEPTH,
+        options.getStorageExecutorQueueDepth());
     EXPECT_EQ(true, options.isIOBuffered());
     EXPECT_EQ(options::DEFAULT_PROVIDER_TIMEOUT,
         options.getProviderTimeout().count());
+    EXPECT_EQ(options::DEFAULT_HEDGE_PERCENTILE, options.getHedgePercentile());
+    EXPECT_EQ(options::DEFAULT_CIRCUIT_BREAKER_FAILURE_THRESHOLD,
+        options.getCircuitBreakerFailureThreshold());
+    EXPECT_EQ(options::DEFAULT_CIRCUIT_BREAKER_RESET_TIMEOUT,
+        options.getCircuitBreakerResetTimeout().count());
+    EXPECT_EQ(options::DEFAULT_SUBSCRIPTION_BATCH_DELAY,
+        options.getSubscriptionBatchDelay().count());
     EXPECT_EQ(
         options::DEFAULT_READ_BUFFER_MIN_SIZE, options.getReadBufferMinSize());
     EXPECT_EQ(
@@ -128,6 +140,30 @@ TEST_F(OptionsTest, getOptionShouldReturnDefaultValue)
         options::DEFAULT_METADATA_CACHE_SIZE, options.getMetadataCacheSize());
     EXPECT_EQ(options::DEFAULT_READDIR_PREFETCH_SIZE,
         options.getReaddirPrefetchSize());
+    EXPECT_EQ(options::DEFAULT_PAGE_CACHE_PREFETCH_SIZE,
+        options.getPageCachePrefetchSize());
+    EXPECT_EQ(options::DEFAULT_WRITE_BEHIND_BUFFER_SIZE,
+        options.getWriteBehindBufferSize());
+    EXPECT_EQ(options::DEFAULT_WRITE_BEHIND_FLUSH_DELAY,
+        options.getWriteBehindFlushDelay().count());
+    EXPECT_EQ(
+        options::DEFAULT_WRITE_STRIPE_SIZE, options.getWriteStripeSize());
+    EXPECT_EQ(
+        options::DEFAULT_WRITE_STRIPE_COUNT, options.getWriteStripeCount());
+    EXPECT_EQ(options::DEFAULT_TIMES_WRITE_BACK_DELAY,
+        options.getTimesWriteBackDelay().count());
+    EXPECT_FALSE(options.isFastReleaseEnabled());
+    EXPECT_EQ(options::DEFAULT_HANDLE_POOL_SIZE, options.getHandlePoolSize());
+    EXPECT_EQ(options::DEFAULT_HANDLE_POOL_IDLE_TIMEOUT,
+        options.getHandlePoolIdleTimeout().count());
+    EXPECT_EQ(options::DEFAULT_SMALL_FILE_INLINE_SIZE,
+        options.getSmallFileInlineSize());
+    EXPECT_EQ(options::DEFAULT_SMALL_FILE_CACHE_SIZE,
+        options.getSmallFileCacheSize());
+    EXPECT_FALSE(options.getStorageStateFilePath());
+    EXPECT_EQ(false, options.isAdaptiveIOPathEnabled());
+    EXPECT_EQ(options::DEFAULT_DIRECT_IO_REPROBE_DELAY,
+        options.getDirectIOReprobeDelay().count());
     EXPECT_FALSE(options.getProviderHost());
     EXPECT_FALSE(options.getAccessToken());
 }
@@ -269,6 +305,22 @@ TEST_F(OptionsTest, parseCommandLineShouldSetStorageHelperThreadCount)
     EXPECT_EQ(8, options.getStorageHelperThreadCount());
 }
 
+TEST_F(OptionsTest, parseCommandLineShouldSetStorageExecutorThreadCount)
+{
+    cmdArgs.insert(cmdArgs.end(),
+        {"--storage-executor-thread-count", "4", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(4, options.getStorageExecutorThreadCount());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetStorageExecutorQueueDepth)
+{
+    cmdArgs.insert(cmdArgs.end(),
+        {"--storage-executor-queue-depth", "64", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(64, options.getStorageExecutorQueueDepth());
+}
+
 TEST_F(OptionsTest, parseCommandLineShouldSetNoBuffer)
 {
     cmdArgs.insert(cmdArgs.end(), {"--no-buffer", "mountpoint"});
@@ -290,6 +342,13 @@ TEST_F(OptionsTest, parseCommandLineShouldSetForceFullblockRead)
     EXPECT_EQ(true, options.isFullblockReadForced());
 }
 
+TEST_F(OptionsTest, parseCommandLineShouldSetCompoundFileRequests)
+{
+    cmdArgs.insert(cmdArgs.end(), {"--compound-file-requests", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(true, options.areCompoundFileRequestsEnabled());
+}
+
 TEST_F(OptionsTest, parseCommandLineShouldSetProviderTimeout)
 {
     cmdArgs.insert(cmdArgs.end(), {"--provider-timeout", "300", "mountpoint"});
@@ -297,6 +356,37 @@ TEST_F(OptionsTest, parseCommandLineShouldSetProviderTimeout)
     EXPECT_EQ(300, options.getProviderTimeout().count());
 }
 
+TEST_F(OptionsTest, parseCommandLineShouldSetHedgePercentile)
+{
+    cmdArgs.insert(cmdArgs.end(), {"--hedge-percentile", "95", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(95, options.getHedgePercentile());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetCircuitBreakerFailureThreshold)
+{
+    cmdArgs.insert(cmdArgs.end(),
+        {"--circuit-breaker-failure-threshold", "5", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(5, options.getCircuitBreakerFailureThreshold());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetCircuitBreakerResetTimeout)
+{
+    cmdArgs.insert(cmdArgs.end(),
+        {"--circuit-breaker-reset-timeout", "30", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(30, options.getCircuitBreakerResetTimeout().count());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetSubscriptionBatchDelay)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--subscription-batch-delay", "500", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(500, options.getSubscriptionBatchDelay().count());
+}
+
 TEST_F(OptionsTest, parseCommandLineShouldSetReadBufferMinSize)
 {
     cmdArgs.insert(
@@ -361,6 +451,116 @@ TEST_F(OptionsTest, parseCommandLineShouldSetReaddirPrefetchSize)
     EXPECT_EQ(10000, options.getReaddirPrefetchSize());
 }
 
+TEST_F(OptionsTest, parseCommandLineShouldSetPageCachePrefetchSize)
+{
+    cmdArgs.insert(cmdArgs.end(),
+        {"--page-cache-prefetch-size", "1048576", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(1048576, options.getPageCachePrefetchSize());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetWriteBehindBufferSize)
+{
+    cmdArgs.insert(cmdArgs.end(),
+        {"--write-behind-buffer-size", "1048576", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(1048576, options.getWriteBehindBufferSize());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetWriteBehindFlushDelay)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--write-behind-flush-delay", "10", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(10, options.getWriteBehindFlushDelay().count());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetWriteStripeSize)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--write-stripe-size", "1048576", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(1048576, options.getWriteStripeSize());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetWriteStripeCount)
+{
+    cmdArgs.insert(cmdArgs.end(), {"--write-stripe-count", "8", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(8, options.getWriteStripeCount());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetTimesWriteBackDelay)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--times-write-back-delay", "5", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(5, options.getTimesWriteBackDelay().count());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetFastRelease)
+{
+    cmdArgs.insert(cmdArgs.end(), {"--fast-release", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(true, options.isFastReleaseEnabled());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetHandlePoolSize)
+{
+    cmdArgs.insert(cmdArgs.end(), {"--handle-pool-size", "16", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(16, options.getHandlePoolSize());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetHandlePoolIdleTimeout)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--handle-pool-idle-timeout", "30", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(30, options.getHandlePoolIdleTimeout().count());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetSmallFileInlineSize)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--small-file-inline-size", "4096", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(4096, options.getSmallFileInlineSize());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetSmallFileCacheSize)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--small-file-cache-size", "1048576", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(1048576, options.getSmallFileCacheSize());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetStorageStateFile)
+{
+    cmdArgs.insert(cmdArgs.end(),
+        {"--storage-state-file", "/var/lib/oneclient/state.json",
+            "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ("/var/lib/oneclient/state.json",
+        options.getStorageStateFilePath()->string());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetAdaptiveIOPath)
+{
+    cmdArgs.insert(cmdArgs.end(), {"--adaptive-io-path", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(true, options.isAdaptiveIOPathEnabled());
+}
+
+TEST_F(OptionsTest, parseCommandLineShouldSetDirectIOReprobeDelay)
+{
+    cmdArgs.insert(
+        cmdArgs.end(), {"--direct-io-reprobe-delay", "10", "mountpoint"});
+    options.parse(cmdArgs.size(), cmdArgs.data());
+    EXPECT_EQ(10, options.getDirectIOReprobeDelay().count());
+}
+
 TEST_F(OptionsTest, parseCommandLineShouldSetForeground)
 {
     cmdArgs.insert(cmdArgs.end(), {"--foreground", "mountpoint"});
@@ -651,6 +851,20 @@ TEST_F(OptionsTest, parseConfigFileShouldSetStorageHelperThreadCount)
     EXPECT_EQ(8, options.getStorageHelperThreadCount());
 }
 
+TEST_F(OptionsTest, parseConfigFileShouldSetStorageExecutorThreadCount)
+{
+    setInConfigFile("storage_executor_thread_count", "4");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(4, options.getStorageExecutorThreadCount());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetStorageExecutorQueueDepth)
+{
+    setInConfigFile("storage_executor_queue_depth", "64");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(64, options.getStorageExecutorQueueDepth());
+}
+
 TEST_F(OptionsTest, parseConfigFileShouldSetNoBuffer)
 {
     setInConfigFile("no_buffer", "1");
@@ -665,6 +879,34 @@ TEST_F(OptionsTest, parseConfigFileShouldSetProviderTimeout)
     EXPECT_EQ(300, options.getProviderTimeout().count());
 }
 
+TEST_F(OptionsTest, parseConfigFileShouldSetHedgePercentile)
+{
+    setInConfigFile("hedge_percentile", "95");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(95, options.getHedgePercentile());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetCircuitBreakerFailureThreshold)
+{
+    setInConfigFile("circuit_breaker_failure_threshold", "5");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(5, options.getCircuitBreakerFailureThreshold());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetCircuitBreakerResetTimeout)
+{
+    setInConfigFile("circuit_breaker_reset_timeout", "30");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(30, options.getCircuitBreakerResetTimeout().count());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetSubscriptionBatchDelay)
+{
+    setInConfigFile("subscription_batch_delay", "500");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(500, options.getSubscriptionBatchDelay().count());
+}
+
 TEST_F(OptionsTest, parseConfigFileShouldSetReadBufferMinSize)
 {
     setInConfigFile("read_buffer_min_size", "1024");
@@ -707,6 +949,105 @@ TEST_F(OptionsTest, parseConfigFileShouldSetWriteBufferFlushDelay)
     EXPECT_EQ(10, options.getWriteBufferFlushDelay().count());
 }
 
+TEST_F(OptionsTest, parseConfigFileShouldSetPageCachePrefetchSize)
+{
+    setInConfigFile("page_cache_prefetch_size", "1048576");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(1048576, options.getPageCachePrefetchSize());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetWriteBehindBufferSize)
+{
+    setInConfigFile("write_behind_buffer_size", "1048576");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(1048576, options.getWriteBehindBufferSize());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetWriteBehindFlushDelay)
+{
+    setInConfigFile("write_behind_flush_delay", "10");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(10, options.getWriteBehindFlushDelay().count());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetWriteStripeSize)
+{
+    setInConfigFile("write_stripe_size", "1048576");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(1048576, options.getWriteStripeSize());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetWriteStripeCount)
+{
+    setInConfigFile("write_stripe_count", "8");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(8, options.getWriteStripeCount());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetTimesWriteBackDelay)
+{
+    setInConfigFile("times_write_back_delay", "5");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(5, options.getTimesWriteBackDelay().count());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetFastRelease)
+{
+    setInConfigFile("fast_release", "1");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(true, options.isFastReleaseEnabled());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetHandlePoolSize)
+{
+    setInConfigFile("handle_pool_size", "16");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(16, options.getHandlePoolSize());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetHandlePoolIdleTimeout)
+{
+    setInConfigFile("handle_pool_idle_timeout", "30");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(30, options.getHandlePoolIdleTimeout().count());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetSmallFileInlineSize)
+{
+    setInConfigFile("small_file_inline_size", "4096");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(4096, options.getSmallFileInlineSize());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetSmallFileCacheSize)
+{
+    setInConfigFile("small_file_cache_size", "1048576");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(1048576, options.getSmallFileCacheSize());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetStorageStateFile)
+{
+    setInConfigFile("storage_state_file", "/var/lib/oneclient/state.json");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ("/var/lib/oneclient/state.json",
+        options.getStorageStateFilePath()->string());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetAdaptiveIOPath)
+{
+    setInConfigFile("adaptive_io_path", "1");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(true, options.isAdaptiveIOPathEnabled());
+}
+
+TEST_F(OptionsTest, parseConfigFileShouldSetDirectIOReprobeDelay)
+{
+    setInConfigFile("direct_io_reprobe_delay", "10");
+    options.parse(fileArgs.size(), fileArgs.data());
+    EXPECT_EQ(10, options.getDirectIOReprobeDelay().count());
+}
+
 TEST_F(OptionsTest, parseConfigFileShouldSetForeground)
 {
     setInConfigFile("fuse_foreground", "1");
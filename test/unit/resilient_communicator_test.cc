@@ -0,0 +1,363 @@
+/**
+ * @file resilient_communicator_test.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "resilientCommunicator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <thread>
+
+using namespace ::testing;
+using namespace one::client;
+using namespace std::literals;
+
+namespace {
+
+struct TestRequest {
+};
+
+struct OtherTestRequest {
+};
+
+struct TestResponse {
+    int id;
+};
+
+// Keeps the requests unanswered until the test responds to them
+class CommunicatorMock {
+public:
+    template <typename SrvMsg, typename CliMsg>
+    folly::Future<SrvMsg> communicate(CliMsg &&)
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        m_requests.emplace_back();
+        return m_requests.back().getFuture();
+    }
+
+    std::size_t requestCount()
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        return m_requests.size();
+    }
+
+    void respond(const std::size_t request, const int id)
+    {
+        promise(request).setValue(TestResponse{id});
+    }
+
+    void fail(const std::size_t request)
+    {
+        promise(request).setException(std::system_error{
+            std::make_error_code(std::errc::operation_not_permitted)});
+    }
+
+private:
+    folly::Promise<TestResponse> &promise(const std::size_t request)
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        return m_requests.at(request);
+    }
+
+    std::mutex m_mutex;
+    std::deque<folly::Promise<TestResponse>> m_requests;
+};
+
+class SchedulerMock {
+public:
+    MOCK_METHOD2(schedule,
+        std::function<void()>(
+            std::chrono::milliseconds, std::function<void()>));
+};
+
+std::errc errorOf(folly::Future<TestResponse> &future)
+{
+    try {
+        future.get();
+    }
+    catch (const std::system_error &e) {
+        return static_cast<std::errc>(e.code().value());
+    }
+    return {};
+}
+
+} // namespace
+
+struct ResilientCommunicatorTest : public ::testing::Test {
+    ResilientCommunicatorTest()
+    {
+        ON_CALL(scheduler, schedule(_, _))
+            .WillByDefault(DoAll(SaveArg<1>(&hedge),
+                Return(std::function<void()>{[this] { ++cancelledHedges; }})));
+    }
+
+    void create(const unsigned int hedgePercentile,
+        const unsigned int failureThreshold,
+        const std::chrono::seconds resetTimeout)
+    {
+        resilientCommunicator = std::make_unique<
+            BasicResilientCommunicator<CommunicatorMock, SchedulerMock>>(
+            communicator, scheduler, hedgePercentile, failureThreshold,
+            resetTimeout);
+    }
+
+    folly::Future<TestResponse> send(
+        const std::chrono::milliseconds timeout = 10s)
+    {
+        return resilientCommunicator->communicate<TestResponse>(
+            TestRequest{}, timeout);
+    }
+
+    folly::Future<TestResponse> sendHedged()
+    {
+        return resilientCommunicator
+            ->communicateHedged<TestResponse, TestRequest>(
+                [] { return TestRequest{}; }, 10s);
+    }
+
+    // Sends requests answered after a given time, so that their response
+    // times are used to compute the hedging delay
+    void recordResponseTimes(
+        const std::size_t count, const std::chrono::milliseconds latency)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            auto future = send();
+            std::this_thread::sleep_for(latency);
+            communicator.respond(communicator.requestCount() - 1, 0);
+            future.get();
+        }
+    }
+
+    NiceMock<SchedulerMock> scheduler;
+    std::function<void()> hedge;
+    int cancelledHedges = 0;
+    std::unique_ptr<BasicResilientCommunicator<CommunicatorMock, SchedulerMock>>
+        resilientCommunicator;
+    // Destroyed first, so that requests left pending are completed while
+    // the resilient communicator still exists
+    CommunicatorMock communicator;
+};
+
+TEST_F(ResilientCommunicatorTest, circuitBreakerShouldOpenAfterThreshold)
+{
+    create(0, 3, 60s);
+
+    for (int i = 0; i < 3; ++i) {
+        auto future = send(1ms);
+        EXPECT_EQ(std::errc::timed_out, errorOf(future));
+    }
+    EXPECT_EQ(3u, communicator.requestCount());
+
+    auto future = send();
+    ASSERT_TRUE(future.isReady());
+    EXPECT_EQ(std::errc::timed_out, errorOf(future));
+    EXPECT_EQ(3u, communicator.requestCount());
+}
+
+TEST_F(ResilientCommunicatorTest, circuitBreakerShouldCountOnlyConsecutive)
+{
+    create(0, 2, 60s);
+
+    auto timedOut = send(1ms);
+    EXPECT_EQ(std::errc::timed_out, errorOf(timedOut));
+
+    auto responded = send();
+    communicator.respond(1, 1);
+    EXPECT_EQ(1, responded.get().id);
+
+    timedOut = send(1ms);
+    EXPECT_EQ(std::errc::timed_out, errorOf(timedOut));
+
+    auto pending = send();
+    EXPECT_EQ(4u, communicator.requestCount());
+}
+
+TEST_F(ResilientCommunicatorTest, circuitBreakerShouldCountErrorsAsResponses)
+{
+    create(0, 2, 60s);
+
+    auto timedOut = send(1ms);
+    EXPECT_EQ(std::errc::timed_out, errorOf(timedOut));
+
+    auto failed = send();
+    communicator.fail(1);
+    EXPECT_EQ(std::errc::operation_not_permitted, errorOf(failed));
+
+    timedOut = send(1ms);
+    EXPECT_EQ(std::errc::timed_out, errorOf(timedOut));
+
+    auto pending = send();
+    EXPECT_EQ(4u, communicator.requestCount());
+}
+
+TEST_F(ResilientCommunicatorTest, circuitBreakerShouldLetSingleTrialRequest)
+{
+    create(0, 1, 0s);
+
+    auto timedOut = send(1ms);
+    EXPECT_EQ(std::errc::timed_out, errorOf(timedOut));
+
+    // The reset timeout has passed, so a single request is let through
+    auto trial = send();
+    EXPECT_EQ(2u, communicator.requestCount());
+    EXPECT_FALSE(trial.isReady());
+
+    auto rejected = send();
+    ASSERT_TRUE(rejected.isReady());
+    EXPECT_EQ(std::errc::timed_out, errorOf(rejected));
+    EXPECT_EQ(2u, communicator.requestCount());
+
+    communicator.respond(1, 1);
+    EXPECT_EQ(1, trial.get().id);
+
+    // The circuit breaker is closed, so requests are sent concurrently again
+    auto first = send();
+    auto pending = send();
+    EXPECT_EQ(4u, communicator.requestCount());
+}
+
+TEST_F(ResilientCommunicatorTest, circuitBreakerShouldReopenOnTrialTimeout)
+{
+    create(0, 2, 0s);
+
+    for (int i = 0; i < 2; ++i) {
+        auto future = send(1ms);
+        EXPECT_EQ(std::errc::timed_out, errorOf(future));
+    }
+
+    auto trial = send(1ms);
+    EXPECT_EQ(std::errc::timed_out, errorOf(trial));
+    EXPECT_EQ(3u, communicator.requestCount());
+
+    // A single timeout of the trial request opens the circuit breaker again
+    auto secondTrial = send();
+    auto rejected = send();
+    ASSERT_TRUE(rejected.isReady());
+    EXPECT_EQ(4u, communicator.requestCount());
+}
+
+TEST_F(ResilientCommunicatorTest, circuitBreakerShouldBeDisabledByZeroThreshold)
+{
+    create(0, 0, 60s);
+
+    for (int i = 0; i < 5; ++i) {
+        auto future = send(1ms);
+        EXPECT_EQ(std::errc::timed_out, errorOf(future));
+    }
+
+    EXPECT_EQ(5u, communicator.requestCount());
+}
+
+TEST_F(ResilientCommunicatorTest, hedgedRequestShouldNotHedgeWithoutSamples)
+{
+    create(50, 0, 60s);
+    recordResponseTimes(31, 0ms);
+
+    EXPECT_CALL(scheduler, schedule(_, _)).Times(0);
+
+    auto future = sendHedged();
+    communicator.respond(31, 1);
+    EXPECT_EQ(1, future.get().id);
+}
+
+TEST_F(ResilientCommunicatorTest, hedgedRequestShouldNotUseOtherRequestTypes)
+{
+    create(50, 0, 60s);
+    recordResponseTimes(32, 0ms);
+
+    EXPECT_CALL(scheduler, schedule(_, _)).Times(0);
+
+    auto future = resilientCommunicator
+                      ->communicateHedged<TestResponse, OtherTestRequest>(
+                          [] { return OtherTestRequest{}; }, 10s);
+}
+
+TEST_F(ResilientCommunicatorTest, hedgeDelayShouldBeResponseTimePercentile)
+{
+    create(50, 0, 60s);
+    recordResponseTimes(16, 0ms);
+    recordResponseTimes(16, 20ms);
+
+    EXPECT_CALL(scheduler, schedule(Ge(20ms), _)).Times(1);
+    auto future = sendHedged();
+}
+
+TEST_F(ResilientCommunicatorTest, hedgeDelayShouldFollowPercentile)
+{
+    create(25, 0, 60s);
+    recordResponseTimes(16, 0ms);
+    recordResponseTimes(16, 20ms);
+
+    EXPECT_CALL(scheduler, schedule(Lt(20ms), _)).Times(1);
+    auto future = sendHedged();
+}
+
+TEST_F(ResilientCommunicatorTest, hedgedRequestShouldUseFirstResponse)
+{
+    create(50, 0, 60s);
+    recordResponseTimes(32, 0ms);
+
+    EXPECT_CALL(scheduler, schedule(_, _)).Times(1);
+    auto future = sendHedged();
+    EXPECT_EQ(33u, communicator.requestCount());
+
+    hedge();
+    EXPECT_EQ(34u, communicator.requestCount());
+
+    communicator.respond(33, 2);
+    ASSERT_TRUE(future.isReady());
+    communicator.respond(32, 1);
+    EXPECT_EQ(2, future.get().id);
+}
+
+TEST_F(ResilientCommunicatorTest, hedgedRequestShouldCancelHedgeOnResponse)
+{
+    create(50, 0, 60s);
+    recordResponseTimes(32, 0ms);
+
+    auto future = sendHedged();
+    communicator.respond(32, 1);
+
+    EXPECT_EQ(1, future.get().id);
+    EXPECT_EQ(1, cancelledHedges);
+
+    hedge();
+    EXPECT_EQ(33u, communicator.requestCount());
+}
+
+TEST_F(ResilientCommunicatorTest, hedgedRequestShouldWaitForPendingCopy)
+{
+    create(50, 0, 60s);
+    recordResponseTimes(32, 0ms);
+
+    auto future = sendHedged();
+    hedge();
+
+    communicator.fail(32);
+    EXPECT_FALSE(future.isReady());
+
+    communicator.respond(33, 2);
+    EXPECT_EQ(2, future.get().id);
+}
+
+TEST_F(ResilientCommunicatorTest, hedgedRequestShouldFailWhenAllCopiesFail)
+{
+    create(50, 0, 60s);
+    recordResponseTimes(32, 0ms);
+
+    auto future = sendHedged();
+    hedge();
+
+    communicator.fail(33);
+    EXPECT_FALSE(future.isReady());
+
+    communicator.fail(32);
+    ASSERT_TRUE(future.isReady());
+    EXPECT_EQ(std::errc::operation_not_permitted, errorOf(future));
+}
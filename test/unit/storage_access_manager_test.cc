@@ -0,0 +1,228 @@
+/**
+ * @file storage_access_manager_test.cc
+ * @author Bartek Kryza
+ * @copyright (C) 2018 ACK CYFRONET AGH
+ * @copyright This software is released under the MIT license cited in
+ * 'LICENSE.txt'
+ */
+
+#include "cache/storageExecutor.h"
+#include "communication/communicator.h"
+#include "messages.pb.h"
+#include "messages/fuse/storageTestFile.h"
+#include "options/options.h"
+#include "posixHelper.h"
+#include "storageAccessManager.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+
+using namespace ::testing;
+using namespace one;
+using namespace one::client;
+using namespace std::literals;
+
+namespace {
+constexpr auto TEST_FILE_ID = "storageTestFile";
+constexpr auto TEST_FILE_CONTENT = "storageTestFileContent";
+}
+
+/**
+ * Mount points are temporary directories listed in a mount table given to
+ * the tested @c StorageAccessManager, and a mount point which doesn't
+ * respond is simulated by a FIFO in place of the storage test file, as
+ * opening it blocks until it's opened for writing.
+ */
+struct StorageAccessManagerTest : public ::testing::Test {
+    StorageAccessManagerTest()
+    {
+        options.parse(args.size(), args.data());
+
+        defaultExecutor = std::make_unique<cache::StorageExecutor>(
+            "default", 1, 0, communicator, options);
+        probeExecutor = std::make_unique<cache::StorageExecutor>(
+            "probe", 4, 0, communicator, options);
+
+        for (int i = 0; i < 3; ++i) {
+            mountPoints.emplace_back(boost::filesystem::temp_directory_path() /
+                boost::filesystem::unique_path());
+            boost::filesystem::create_directories(mountPoints.back());
+            mount(mountPoints.back());
+        }
+    }
+
+    ~StorageAccessManagerTest()
+    {
+        // Probe threads blocked on FIFOs must be released before the probe
+        // executor stops
+        for (const auto &mountPoint : mountPoints)
+            releaseHungTestFile(mountPoint);
+
+        for (const auto &mountPoint : mountPoints)
+            boost::filesystem::remove_all(mountPoint);
+    }
+
+    void mount(const boost::filesystem::path &mountPoint,
+        const std::string &type = "ext4")
+    {
+        filesystems.push_back(
+            MountedFilesystem{mountPoint, "/dev/" + mountPoint.stem().string(),
+                type});
+    }
+
+    void writeTestFile(const boost::filesystem::path &mountPoint,
+        const std::string &content = TEST_FILE_CONTENT)
+    {
+        boost::filesystem::remove(mountPoint / TEST_FILE_ID);
+        std::ofstream file{(mountPoint / TEST_FILE_ID).string()};
+        file << content;
+    }
+
+    void makeHungTestFile(const boost::filesystem::path &mountPoint)
+    {
+        ASSERT_EQ(0, ::mkfifo((mountPoint / TEST_FILE_ID).c_str(), 0600));
+    }
+
+    void releaseHungTestFile(const boost::filesystem::path &mountPoint)
+    {
+        const auto path = mountPoint / TEST_FILE_ID;
+        if (!boost::filesystem::is_other(path))
+            return;
+
+        const auto fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK);
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    void create(const std::chrono::seconds probeTimeout = 1s)
+    {
+        manager = std::make_unique<StorageAccessManager>(
+            defaultExecutor->helperFactory(), probeExecutor->helperFactory(),
+            options, [this] { return filesystems; }, probeTimeout);
+    }
+
+    folly::Optional<DetectedStorageAccess> verify()
+    {
+        auto serverMessage = std::make_unique<clproto::ServerMessage>();
+        auto response = serverMessage->mutable_fuse_response();
+        response->mutable_status()->set_code(clproto::Status::ok);
+
+        auto testFile = response->mutable_storage_test_file();
+        testFile->mutable_helper_params()->set_helper_name(
+            helpers::POSIX_HELPER_NAME);
+        testFile->set_space_id("spaceId");
+        testFile->set_file_id(TEST_FILE_ID);
+        testFile->set_file_content(TEST_FILE_CONTENT);
+
+        return manager
+            ->verifyStorageTestFile(
+                messages::fuse::StorageTestFile{std::move(serverMessage)})
+            .get();
+    }
+
+    static folly::fbstring mountPointOf(const DetectedStorageAccess &access)
+    {
+        return access.helperArgs.at(helpers::POSIX_HELPER_MOUNT_POINT_ARG);
+    }
+
+    std::vector<const char *> args{"oneclient", "mountpoint"};
+    options::Options options;
+    communication::Communicator communicator{1, 1, "localhost", 80, false,
+        communication::createConnection};
+    std::unique_ptr<cache::StorageExecutor> defaultExecutor;
+    std::unique_ptr<cache::StorageExecutor> probeExecutor;
+    std::vector<boost::filesystem::path> mountPoints;
+    std::vector<MountedFilesystem> filesystems;
+    std::unique_ptr<StorageAccessManager> manager;
+};
+
+TEST_F(StorageAccessManagerTest, probeTimeoutShouldDefaultTo5Seconds)
+{
+    EXPECT_EQ(5s, StorageAccessManager::MOUNT_POINT_PROBE_TIMEOUT);
+}
+
+TEST_F(StorageAccessManagerTest, verifyShouldFindMountPointWithTestFile)
+{
+    writeTestFile(mountPoints[0], "otherContent");
+    writeTestFile(mountPoints[1]);
+    create();
+
+    auto access = verify();
+
+    ASSERT_TRUE(access.hasValue());
+    EXPECT_EQ(helpers::POSIX_HELPER_NAME, access->helperName);
+    EXPECT_EQ(mountPoints[1].string(), mountPointOf(*access));
+    EXPECT_TRUE(access->helper != nullptr);
+}
+
+TEST_F(StorageAccessManagerTest, verifyShouldReturnNoneWithoutTestFile)
+{
+    writeTestFile(mountPoints[0], "otherContent");
+    create();
+
+    EXPECT_FALSE(verify().hasValue());
+}
+
+TEST_F(StorageAccessManagerTest, verifyShouldNotProbeFuseMountPoints)
+{
+    filesystems.clear();
+    mount(mountPoints[0], "fuse.oneclient");
+    writeTestFile(mountPoints[0]);
+    create();
+
+    EXPECT_FALSE(verify().hasValue());
+}
+
+TEST_F(StorageAccessManagerTest, verifyShouldProbeMountPointsConcurrently)
+{
+    makeHungTestFile(mountPoints[0]);
+    makeHungTestFile(mountPoints[1]);
+    makeHungTestFile(mountPoints[2]);
+
+    const auto validMountPoint = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path();
+    mountPoints.emplace_back(validMountPoint);
+    boost::filesystem::create_directories(validMountPoint);
+    mount(validMountPoint);
+    writeTestFile(validMountPoint);
+
+    create(1s);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto access = verify();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(access.hasValue());
+    EXPECT_EQ(validMountPoint.string(), mountPointOf(*access));
+
+    // Probed one after another, the hung mount points would take 3 s
+    EXPECT_LT(elapsed, 2s);
+}
+
+TEST_F(StorageAccessManagerTest, verifyShouldSkipHungMountPoint)
+{
+    makeHungTestFile(mountPoints[0]);
+    create(1s);
+
+    EXPECT_FALSE(verify().hasValue());
+
+    // The mount point responds again, but isn't probed until the mount
+    // table changes
+    releaseHungTestFile(mountPoints[0]);
+    writeTestFile(mountPoints[0]);
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(verify().hasValue());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+
+    filesystems.pop_back();
+    auto access = verify();
+
+    ASSERT_TRUE(access.hasValue());
+    EXPECT_EQ(mountPoints[0].string(), mountPointOf(*access));
+}